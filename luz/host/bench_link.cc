@@ -0,0 +1,151 @@
+// Compares the latency of climbs written with and without response over a simulated BLE link, e.g.
+//
+//   bench_link -n 1000 -m 23 -h 120 -i 15000 -p 4
+//
+// Random climbs (see workload.hh) are encoded as the Aurora app encodes them, split into writes
+// for the ATT MTU and sent over the link of link.hh to the firmware's receive queue, whose credit
+// paces the writes without response. Each climb is timed from its first connection event until
+// its last write has been decoded.
+//
+//   -n frames     Number of climbs to send (default 1000)
+//   -m mtu        ATT MTU of the link (default 23)
+//   -h holds      Most holds in a climb (default 60)
+//   -i interval   Connection interval in microseconds (default 15000)
+//   -p writes     Most writes the phone sends per connection event (default 4)
+//   -s seed       Seed of the generator (default 1)
+
+#include "encoder.hh"
+#include "link.hh"
+#include "protocol.hh"
+#include "receive.hh"
+#include "workload.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <unistd.h>
+
+namespace
+{
+/// The default depth of the firmware's receive queue
+constexpr size_t queue_depth = 8UL;
+
+struct Options
+{
+  size_t frames = 1'000UL;
+  size_t mtu = 23UL;
+  size_t max_holds = 60UL;
+  luz::host::LinkTiming timing{};
+  uint64_t seed = 1U;
+};
+
+bool parse(int argc, char** argv, Options& options)
+{
+  for (int option = 0; (option = getopt(argc, argv, "n:m:h:i:p:s:")) != -1;)
+  {
+    switch (option)
+    {
+    case 'n':
+      options.frames = std::strtoul(optarg, nullptr, 10);
+      break;
+    case 'm':
+      options.mtu = std::strtoul(optarg, nullptr, 10);
+      break;
+    case 'h':
+      options.max_holds = std::strtoul(optarg, nullptr, 10);
+      break;
+    case 'i':
+      options.timing.interval_us = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10));
+      break;
+    case 'p':
+      options.timing.writes_per_event = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10));
+      break;
+    case 's':
+      options.seed = std::strtoull(optarg, nullptr, 10);
+      break;
+    default:
+      return false;
+    }
+  }
+  // The simulation advances in steps of 50us, and connection intervals are multiples of 1.25ms
+  return optind == argc && options.mtu > luz::host::att_header_size && options.max_holds >= 4UL
+         && options.timing.interval_us >= 7'500U && options.timing.interval_us % 1'250U == 0U
+         && options.timing.writes_per_event > 0U;
+}
+
+struct Latency
+{
+  double mean_ms{};
+  double max_ms{};
+  size_t decoded{};
+  uint32_t overruns{};
+};
+
+Latency measure(const Options& options, luz::host::WriteMode mode)
+{
+  luz::host::ClimbGenerator generator{ options.seed, 4UL, options.max_holds };
+  luz::receive::ReceiveQueue<queue_depth> queue{};
+  luz::host::SimulatedLink link{ options.timing, queue };
+  luz::protocol::Protocol protocol{};
+  luz::Packet packet{};
+
+  Latency latency{};
+  std::vector<luz::Placement> placements{};
+  std::vector<std::byte> bytes{};
+  luz::host::Writes writes{};
+  for (size_t climb = 0UL; climb < options.frames; ++climb)
+  {
+    generator.next(placements);
+    bytes.clear();
+    luz::host::encode_climb(placements, bytes);
+    writes.clear();
+    luz::host::split(bytes, options.mtu, writes);
+
+    const auto elapsed_us = link.send(writes, mode, [&](std::span<const std::byte> write) {
+      latency.decoded += protocol.process(write, packet) ? 1UL : 0UL;
+    });
+    const auto elapsed_ms = static_cast<double>(elapsed_us) / 1e3;
+    latency.mean_ms += elapsed_ms / static_cast<double>(options.frames);
+    latency.max_ms = std::max(latency.max_ms, elapsed_ms);
+  }
+  latency.overruns = queue.overruns();
+  return latency;
+}
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+  Options options{};
+  if (!parse(argc, argv, options))
+  {
+    std::fprintf(stderr,
+                 "usage: %s [-n frames] [-m mtu] [-h holds] [-i interval (us)] "
+                 "[-p writes per event] [-s seed]\n",
+                 argv[0]);
+    return 1;
+  }
+
+  const auto with_response = measure(options, luz::host::WriteMode::with_response);
+  const auto without_response = measure(options, luz::host::WriteMode::without_response);
+  for (const auto& [name, latency] :
+       { std::pair{ "with response", with_response },
+         std::pair{ "without response", without_response } })
+  {
+    std::printf("Write %-16s: decoded %zu of %zu climbs, mean %.1f ms, max %.1f ms, "
+                "%u overruns\n",
+                name,
+                latency.decoded,
+                options.frames,
+                latency.mean_ms,
+                latency.max_ms,
+                latency.overruns);
+  }
+  std::printf("Latency ratio: %.2f\n",
+              without_response.mean_ms > 0.0 ? with_response.mean_ms / without_response.mean_ms
+                                             : 0.0);
+  return 0;
+}
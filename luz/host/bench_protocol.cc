@@ -0,0 +1,204 @@
+// Benchmarks the throughput and robustness of the protocol against synthetic climbs, e.g.
+//
+//   bench_protocol -n 1000000 -m 23 -d 0.01 -u 0.01 -c 0.01
+//
+// Random climbs are drawn from the positions of the board (see workload.hh), encoded as the
+// Aurora app encodes them, split into writes for the ATT MTU and passed over a link which drops,
+// duplicates and corrupts writes at the given rates. The writes are processed once to measure
+// throughput, then again to check that each decoded frame is one of the climbs sent; a mismatch
+// is a corrupted frame which the protocol failed to reject.
+//
+//   -n frames     Number of climbs to generate (default 100000)
+//   -m mtu        ATT MTU of the link (default 23)
+//   -h holds      Most holds in a climb (default 20)
+//   -d rate       Probability of each write being dropped (default 0)
+//   -u rate       Probability of each write being duplicated (default 0)
+//   -c rate       Probability of a bit of each write being flipped (default 0)
+//   -s seed       Seed of the generator and of the link (default 1)
+
+#include "encoder.hh"
+#include "protocol.hh"
+#include "validate.hh"
+#include "workload.hh"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <ranges>
+#include <vector>
+
+#include <unistd.h>
+
+namespace
+{
+constexpr size_t num_statuses
+    = static_cast<size_t>(luz::protocol::ProtocolStatus::bad_checksum) + 1UL;
+
+struct Options
+{
+  size_t frames = 100'000UL;
+  size_t mtu = 23UL;
+  size_t max_holds = 20UL;
+  luz::host::FaultRates rates{};
+  uint64_t seed = 1U;
+};
+
+bool parse(int argc, char** argv, Options& options)
+{
+  for (int option = 0; (option = getopt(argc, argv, "n:m:h:d:u:c:s:")) != -1;)
+  {
+    switch (option)
+    {
+    case 'n':
+      options.frames = std::strtoul(optarg, nullptr, 10);
+      break;
+    case 'm':
+      options.mtu = std::strtoul(optarg, nullptr, 10);
+      break;
+    case 'h':
+      options.max_holds = std::strtoul(optarg, nullptr, 10);
+      break;
+    case 'd':
+      options.rates.drop = std::strtod(optarg, nullptr);
+      break;
+    case 'u':
+      options.rates.duplicate = std::strtod(optarg, nullptr);
+      break;
+    case 'c':
+      options.rates.corrupt = std::strtod(optarg, nullptr);
+      break;
+    case 's':
+      options.seed = std::strtoull(optarg, nullptr, 10);
+      break;
+    default:
+      return false;
+    }
+  }
+  // Frames are checked against their climb packet by packet, so each climb is a single packet
+  return optind == argc && options.mtu > luz::host::att_header_size && options.max_holds >= 4UL
+         && options.max_holds <= luz::host::max_placements_per_packet;
+}
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+  Options options{};
+  if (!parse(argc, argv, options))
+  {
+    std::fprintf(stderr,
+                 "usage: %s [-n frames] [-m mtu] [-h holds (4-%zu)] [-d drop] [-u duplicate] "
+                 "[-c corrupt] [-s seed]\n",
+                 argv[0],
+                 luz::host::max_placements_per_packet);
+    return 1;
+  }
+
+  // Generate the whole workload up front so only processing is timed
+  luz::host::ClimbGenerator generator{ options.seed, 4UL, options.max_holds };
+  luz::host::FaultInjector link{ options.seed + 1U, options.rates };
+  luz::host::Writes climbs{};
+  luz::host::Writes sent{};
+  luz::host::Writes arrived{};
+  /// The climb each arrived write belongs to
+  std::vector<uint32_t> sources{};
+  std::vector<luz::Placement> placements{};
+  std::vector<std::byte> bytes{};
+  size_t num_placements = 0UL;
+  for (uint32_t climb = 0U; climb < options.frames; ++climb)
+  {
+    generator.next(placements);
+    num_placements += placements.size();
+    bytes.clear();
+    luz::host::encode_climb(placements, bytes);
+    climbs.push_back(bytes);
+
+    sent.clear();
+    luz::host::split(bytes, options.mtu, sent);
+    for (size_t index = 0UL; index < sent.size(); ++index)
+    {
+      link.transmit(sent[index], arrived);
+      sources.resize(arrived.size(), climb);
+    }
+  }
+
+  const auto& faults = link.counts();
+  std::printf("Generated %zu climbs (%zu placements, %zu bytes) as %zu writes for an MTU of %zu: "
+              "%zu dropped, %zu duplicated, %zu corrupted\n",
+              climbs.size(),
+              num_placements,
+              climbs.num_bytes(),
+              arrived.size(),
+              options.mtu,
+              faults.dropped,
+              faults.duplicated,
+              faults.corrupted);
+
+  std::array<luz::Placement, luz::host::max_placements_per_packet> storage{};
+  std::pmr::monotonic_buffer_resource resource{ storage.data(), sizeof(storage) };
+  luz::Packet packet{ .placements = std::pmr::vector<luz::Placement>{ &resource } };
+
+  size_t num_decoded = 0UL;
+  {
+    luz::protocol::Protocol protocol{};
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t index = 0UL; index < arrived.size(); ++index)
+    {
+      num_decoded += protocol.process(arrived[index], packet) ? 1UL : 0UL;
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const double seconds = elapsed.count();
+    std::printf("Processed %zu writes in %.3f ms: %.0f frames/s, %.1f MB/s\n",
+                arrived.size(),
+                seconds * 1e3,
+                seconds > 0.0 ? static_cast<double>(num_decoded) / seconds : 0.0,
+                seconds > 0.0 ? static_cast<double>(arrived.num_bytes()) / seconds / 1e6 : 0.0);
+  }
+
+  // Check every decoded frame against the climbs of the writes still buffered when it completed;
+  // a frame is held back while an older rejected write is in front of it, so it need not belong
+  // to the write completing it
+  std::array<size_t, num_statuses> statuses{};
+  size_t num_mismatched = 0UL;
+  {
+    luz::protocol::Protocol protocol{};
+    for (size_t index = 0UL; index < arrived.size(); ++index)
+    {
+      if (protocol.process(arrived[index], packet))
+      {
+        bytes.clear();
+        luz::host::encode(packet, bytes);
+        const auto in_flight = std::min(index + 1UL, luz::protocol::BufferList::max_buffers);
+        const bool matched = std::ranges::any_of(
+            std::views::iota(index + 1UL - in_flight, index + 1UL),
+            [&](size_t write) { return std::ranges::equal(bytes, climbs[sources[write]]); });
+        num_mismatched += matched ? 0UL : 1UL;
+      }
+      for (const auto status : protocol.statuses())
+      {
+        ++statuses[static_cast<size_t>(status)];
+      }
+    }
+  }
+
+  std::printf("Decoded %zu of %zu climbs, %zu mismatched:",
+              num_decoded,
+              climbs.size(),
+              num_mismatched);
+  for (size_t status = 0UL; status < statuses.size(); ++status)
+  {
+    if (statuses[status] > 0UL)
+    {
+      std::printf(" %s=%zu",
+                  luz::host::to_string(static_cast<luz::protocol::ProtocolStatus>(status)),
+                  statuses[status]);
+    }
+  }
+  std::printf("\n");
+  return 0;
+}
@@ -0,0 +1,63 @@
+// Builds a climb library blob to flash to the "library" partition, e.g.
+//
+//   build_library climbs.txt library.bin
+//   parttool.py write_partition --partition-name=library --input=library.bin
+//
+// Each line of the input holds the dwell time of a climb in seconds followed by the bytes of its
+// packet in hexadecimal, e.g. "30 01 04 A1 02 54 29 01 E0 03". Each climb is stored as a single
+// frame, so climbs of several packets are rejected. Blank lines and lines starting with '#' are
+// ignored.
+
+#include "library.hh"
+#include "listing.hh"
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+int main(int argc, char** argv)
+{
+  if (argc != 3)
+  {
+    std::fprintf(stderr, "usage: %s <climbs.txt> <library.bin>\n", argv[0]);
+    return 1;
+  }
+
+  std::ifstream input{ argv[1] };
+  if (!input)
+  {
+    std::fprintf(stderr, "Cannot read %s\n", argv[1]);
+    return 1;
+  }
+
+  luz::library::Builder builder{};
+  std::string line{};
+  luz::host::ListingLine climb{};
+  for (size_t line_number = 1UL; std::getline(input, line); ++line_number)
+  {
+    if (luz::host::is_comment(line))
+    {
+      continue;
+    }
+
+    if (!luz::host::parse_line(line, climb) || !builder.add(climb.bytes, climb.dwell_s))
+    {
+      std::fprintf(stderr, "%s:%zu: not a valid climb of a single packet\n", argv[1], line_number);
+      return 1;
+    }
+  }
+
+  const auto bytes = builder.build();
+  std::ofstream output{ argv[2], std::ios::binary };
+  output.write(reinterpret_cast<const char*>(bytes.data()),
+               static_cast<std::streamsize>(bytes.size()));
+  if (!output)
+  {
+    std::fprintf(stderr, "Cannot write %s\n", argv[2]);
+    return 1;
+  }
+
+  std::printf("Wrote %zu climbs (%zu bytes) to %s\n", builder.size(), bytes.size(), argv[2]);
+  return 0;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "decoder.hh"
+#include "packet.hh"
+#include "packet_layout.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace luz::host
+{
+/// Most placements the Aurora app sends in a single packet
+constexpr size_t max_placements_per_packet = protocol::detail::max_placements_per_packet;
+
+/// Append a single packet in the wire format: the header with its indicators, the payload size
+/// and checksum computed from the placements, then the placements and the footer
+/// @pre placements.size() <= max_placements_per_packet
+inline void encode(std::span<const Placement> placements,
+                   IndexMarker index_marker,
+                   std::vector<std::byte>& bytes)
+{
+  using protocol::Layouts;
+
+  const auto header_offset = bytes.size();
+  const auto payload_size = placements.size() * Layouts::Placement::size;
+  bytes.resize(header_offset + Layouts::Header::size + payload_size + Layouts::Footer::size);
+  const auto packet = std::span(bytes).subspan(header_offset);
+
+  const auto payload = packet.subspan(Layouts::Header::size, payload_size);
+  for (size_t index = 0UL; index < placements.size(); ++index)
+  {
+    Layouts::Placement::encode(
+        placements[index],
+        payload.subspan(index * Layouts::Placement::size, Layouts::Placement::size));
+  }
+
+  const auto header
+      = Packet::Header{ .payload_size = static_cast<uint8_t>(payload_size),
+                        .checksum = protocol::detail::checksum(payload, index_marker),
+                        .index_marker = index_marker };
+  Layouts::Header::encode(header, packet.first(Layouts::Header::size));
+  Layouts::Footer::encode(Packet::Footer{}, packet.last(Layouts::Footer::size));
+}
+
+/// Append a packet, ignoring the payload size and checksum held by its header
+inline void encode(const Packet& packet, std::vector<std::byte>& bytes)
+{
+  encode(packet.placements, packet.header.index_marker, bytes);
+}
+
+/// Append a climb as the Aurora app sends it: a single solo packet, or a first packet followed by
+/// middle packets and a last packet if it holds more placements than fit in one
+inline void encode_climb(std::span<const Placement> placements,
+                         std::vector<std::byte>& bytes,
+                         size_t placements_per_packet = max_placements_per_packet)
+{
+  if (placements.size() <= placements_per_packet)
+  {
+    encode(placements, IndexMarker::solo, bytes);
+    return;
+  }
+
+  for (size_t offset = 0UL; offset < placements.size(); offset += placements_per_packet)
+  {
+    const auto count = std::min(placements_per_packet, placements.size() - offset);
+    const auto marker = offset == 0UL                            ? IndexMarker::first
+                        : offset + count == placements.size() ? IndexMarker::last
+                                                                : IndexMarker::middle;
+    encode(placements.subspan(offset, count), marker, bytes);
+  }
+}
+} // namespace luz::host
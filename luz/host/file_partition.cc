@@ -0,0 +1,71 @@
+#include "file_partition.hh"
+
+#include "upload.hh"
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace luz::host
+{
+FilePartition::FilePartition(const char* path, size_t size) noexcept
+{
+  const int fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0)
+  {
+    return;
+  }
+
+  struct stat status{};
+  const bool existing = fstat(fd, &status) == 0 && static_cast<size_t>(status.st_size) == size;
+  if ((existing || ftruncate(fd, static_cast<off_t>(size)) == 0) && size > 0UL)
+  {
+    // Writes through the shared mapping reach the file, so they persist once it is reopened
+    if (void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        data != MAP_FAILED)
+    {
+      bytes_ = std::span{ static_cast<std::byte*>(data), size };
+      if (!existing)
+      {
+        std::ranges::fill(bytes_, std::byte{ 0xFF });
+      }
+    }
+  }
+  close(fd);
+}
+
+FilePartition::~FilePartition() noexcept
+{
+  if (!bytes_.empty())
+  {
+    munmap(bytes_.data(), bytes_.size());
+  }
+}
+
+bool FilePartition::erase(size_t offset, size_t size) noexcept
+{
+  if (offset % upload::sector_size != 0UL || size % upload::sector_size != 0UL
+      || offset > bytes_.size() || size > bytes_.size() - offset)
+  {
+    return false;
+  }
+  std::ranges::fill(bytes_.subspan(offset, size), std::byte{ 0xFF });
+  return true;
+}
+
+bool FilePartition::write(size_t offset, std::span<const std::byte> bytes) noexcept
+{
+  if (offset > bytes_.size() || bytes.size() > bytes_.size() - offset)
+  {
+    return false;
+  }
+  std::ranges::transform(bytes_.subspan(offset, bytes.size()),
+                         bytes,
+                         bytes_.subspan(offset).begin(),
+                         [](std::byte flash, std::byte byte) { return flash & byte; });
+  return true;
+}
+} // namespace luz::host
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace luz::host
+{
+/// A file standing in for a flash partition; the host counterpart of upload::FlashPartition.
+/// Like NOR flash, erase sets whole sectors to 0xFF and writes only clear bits, so a write to a
+/// region which was not erased first corrupts it just as it would on the device.
+class FilePartition
+{
+public:
+  /// Map the file at path, creating it erased if it does not hold size bytes; bytes() is empty if
+  /// it cannot be mapped
+  FilePartition(const char* path, size_t size) noexcept;
+  ~FilePartition() noexcept;
+
+  /// Copy/move constructor/assignment
+  FilePartition(const FilePartition&) = delete;
+  FilePartition& operator=(const FilePartition&) = delete;
+  FilePartition(FilePartition&&) = delete;
+  FilePartition& operator=(FilePartition&&) = delete;
+
+  std::span<const std::byte> bytes() const noexcept { return bytes_; }
+
+  /// @return false unless the range is within the file and a whole number of sectors
+  bool erase(size_t offset, size_t size) noexcept;
+  /// @return false unless the range is within the file
+  bool write(size_t offset, std::span<const std::byte> bytes) noexcept;
+
+private:
+  std::span<std::byte> bytes_{};
+};
+} // namespace luz::host
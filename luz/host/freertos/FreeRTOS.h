@@ -0,0 +1,28 @@
+#pragma once
+
+// Host stand-in for the FreeRTOS kernel as configured by ESP-IDF, implemented by the virtual time
+// scheduler of rtos.hh. Only the primitives used by the firmware are provided.
+
+#include <cstddef>
+#include <cstdint>
+
+using TickType_t = uint32_t;
+using BaseType_t = int;
+using UBaseType_t = unsigned int;
+/// As on ESP-IDF, stack depths are given in bytes
+using StackType_t = uint8_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+
+#define portMAX_DELAY static_cast<TickType_t>(0xFFFFFFFFUL)
+
+#ifndef configTICK_RATE_HZ
+#define configTICK_RATE_HZ 1000U
+#endif
+#define configMAX_PRIORITIES 25U
+#define portTICK_PERIOD_MS (1000U / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)                                                                         \
+  static_cast<TickType_t>((static_cast<uint64_t>(ms) * configTICK_RATE_HZ) / 1000U)
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+struct QueueDefinition;
+using QueueHandle_t = QueueDefinition*;
+
+/// Storage of a statically allocated queue; the host scheduler allocates its own
+struct StaticQueue_t
+{
+  void* reserved{};
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) noexcept;
+QueueHandle_t xQueueCreateStatic(UBaseType_t length,
+                                 UBaseType_t item_size,
+                                 uint8_t* storage,
+                                 StaticQueue_t* queue) noexcept;
+void vQueueDelete(QueueHandle_t queue) noexcept;
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks) noexcept;
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks) noexcept;
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks) noexcept;
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) noexcept;
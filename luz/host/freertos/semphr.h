@@ -0,0 +1,17 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+/// As in FreeRTOS, semaphores are queues of items without contents
+using SemaphoreHandle_t = QueueHandle_t;
+using StaticSemaphore_t = StaticQueue_t;
+
+/// Mutexes do not inherit priority on the host
+SemaphoreHandle_t xSemaphoreCreateMutex() noexcept;
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* mutex) noexcept;
+SemaphoreHandle_t xSemaphoreCreateBinary() noexcept;
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) noexcept;
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) noexcept;
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) noexcept;
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+struct tskTaskControlBlock;
+using TaskHandle_t = tskTaskControlBlock*;
+using TaskFunction_t = void (*)(void*);
+
+/// Storage of a statically allocated task; the host scheduler allocates its own
+struct StaticTask_t
+{
+  void* reserved{};
+};
+
+BaseType_t xTaskCreate(TaskFunction_t function,
+                       const char* name,
+                       uint32_t stack_depth,
+                       void* parameter,
+                       UBaseType_t priority,
+                       TaskHandle_t* created) noexcept;
+TaskHandle_t xTaskCreateStatic(TaskFunction_t function,
+                               const char* name,
+                               uint32_t stack_depth,
+                               void* parameter,
+                               UBaseType_t priority,
+                               StackType_t* stack,
+                               StaticTask_t* task) noexcept;
+void vTaskDelete(TaskHandle_t task) noexcept;
+
+void vTaskDelay(TickType_t ticks) noexcept;
+BaseType_t xTaskDelayUntil(TickType_t* previous_wake, TickType_t increment) noexcept;
+void taskYIELD() noexcept;
+
+TickType_t xTaskGetTickCount() noexcept;
+TaskHandle_t xTaskGetCurrentTaskHandle() noexcept;
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task) noexcept;
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) noexcept;
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) noexcept;
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) noexcept;
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "receive.hh"
+#include "workload.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <span>
+
+namespace luz::host
+{
+/// Timing of a BLE connection as negotiated by the phone, in microseconds
+struct LinkTiming
+{
+  /// Connection interval; phones typically settle between 15ms and 30ms
+  uint32_t interval_us = 15'000U;
+  /// Most writes the phone sends in a single connection event
+  uint32_t writes_per_event = 4U;
+  /// Air time of each write and its link layer acknowledgement, at which writes in the same
+  /// connection event follow each other
+  uint32_t write_us = 400U;
+  /// Time taken by the decode task to process a write
+  uint32_t decode_us = 200U;
+};
+
+/// How the client writes each fragment
+enum class WriteMode
+{
+  /// One write request at a time: the next is sent in the connection event after the response
+  /// to the previous has been received, so each write costs two connection events
+  with_response,
+  /// Several writes per connection event, paced by the credit granted by the queue
+  without_response,
+};
+
+/// A BLE link in virtual time, in which the client writes fragments to the characteristic and
+/// the decode task drains them from the queue. Only the connection events are simulated; the
+/// queue and its credit are the firmware's own.
+template <size_t Depth> class SimulatedLink
+{
+public:
+  using OnFragment = std::function<void(std::span<const std::byte>)>;
+
+  SimulatedLink(LinkTiming timing, receive::ReceiveQueue<Depth>& queue) noexcept
+      : timing_{ timing }, queue_{ queue }, client_limit_{ queue.credit().limit }
+  {
+  }
+
+  /// Send the fragments, passing each to on_fragment as the decode task drains it
+  /// @return The time from the first connection event until the last fragment has been decoded
+  uint32_t send(const Writes& fragments, WriteMode mode, const OnFragment& on_fragment);
+
+private:
+  static constexpr uint32_t tick_us = 50U;
+
+  LinkTiming timing_;
+  receive::ReceiveQueue<Depth>& queue_;
+  /// Time of the next connection event
+  uint32_t now_{};
+  /// Fragments sent by the client since the connection, and the limit of its credit
+  uint16_t client_sent_{};
+  uint16_t client_limit_{};
+  /// Credit notified by the decode task, delivered to the client at the next connection event
+  std::deque<receive::Credit> notified_{};
+};
+
+template <size_t Depth>
+uint32_t SimulatedLink<Depth>::send(const Writes& fragments,
+                                    WriteMode mode,
+                                    const OnFragment& on_fragment)
+{
+  const auto start = now_;
+  size_t next = 0UL;
+  /// Writes left to send in the current connection event, and when the next may be sent
+  uint32_t burst = 0U;
+  uint32_t next_write_at = start;
+  uint32_t next_request_at = start;
+  uint32_t decoded_at = 0U;
+  bool decoding = false;
+  for (uint32_t time = start;; time += tick_us)
+  {
+    if (decoding && time >= decoded_at)
+    {
+      on_fragment(*queue_.front());
+      queue_.pop();
+      decoding = false;
+      if (const auto credit = queue_.poll_credit())
+      {
+        notified_.push_back(*credit);
+      }
+    }
+
+    if ((time - start) % timing_.interval_us == 0U)
+    {
+      now_ = time;
+      for (; !notified_.empty(); notified_.pop_front())
+      {
+        client_limit_ = notified_.front().limit;
+      }
+
+      if (mode == WriteMode::with_response)
+      {
+        burst = time >= next_request_at ? 1U : 0U;
+      }
+      else
+      {
+        burst = timing_.writes_per_event;
+      }
+      next_write_at = time;
+    }
+
+    if (burst > 0U && next < fragments.size() && time >= next_write_at
+        && (mode == WriteMode::with_response
+            || static_cast<int16_t>(client_limit_ - client_sent_) > 0))
+    {
+      (void)queue_.try_push(fragments[next++]);
+      ++client_sent_;
+      --burst;
+      next_write_at = time + timing_.write_us;
+      // The response arrives in the next connection event, and the next request follows it
+      next_request_at = now_ + (2U * timing_.interval_us);
+    }
+
+    if (!decoding && !queue_.empty())
+    {
+      decoding = true;
+      decoded_at = time + timing_.decode_us;
+    }
+    if (next == fragments.size() && !decoding)
+    {
+      // Resume at the next connection event
+      now_ = time + timing_.interval_us - ((time - start) % timing_.interval_us);
+      return time - start;
+    }
+  }
+}
+} // namespace luz::host
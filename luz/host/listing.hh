@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+namespace luz::host
+{
+/// One line of a climb listing: the dwell time of the climb in seconds followed by the bytes of
+/// its packets in hexadecimal, e.g. "30 01 04 A1 02 54 29 01 E0 03"
+struct ListingLine
+{
+  uint16_t dwell_s{};
+  std::vector<std::byte> bytes{};
+};
+
+/// Whether a listing line holds no climb: blank lines and lines starting with '#'
+inline bool is_comment(std::string_view line) noexcept
+{
+  return line.empty() || line.front() == '#';
+}
+
+/// Parse a line of a climb listing
+/// @return false unless line holds a dwell time followed only by byte values
+inline bool parse_line(std::string_view line, ListingLine& parsed)
+{
+  std::istringstream fields{ std::string{ line } };
+  unsigned dwell_s = 0U;
+  if (!(fields >> dwell_s) || dwell_s > UINT16_MAX)
+  {
+    return false;
+  }
+
+  parsed.dwell_s = static_cast<uint16_t>(dwell_s);
+  parsed.bytes.clear();
+  unsigned value = 0U;
+  while (fields >> std::hex >> value)
+  {
+    if (value > UINT8_MAX)
+    {
+      return false;
+    }
+    parsed.bytes.push_back(static_cast<std::byte>(value));
+  }
+  return fields.eof();
+}
+} // namespace luz::host
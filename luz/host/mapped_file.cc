@@ -0,0 +1,38 @@
+#include "mapped_file.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace luz::host
+{
+MappedFile::MappedFile(const char* path) noexcept
+{
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0)
+  {
+    return;
+  }
+
+  struct stat status{};
+  if (fstat(fd, &status) == 0 && status.st_size > 0)
+  {
+    const auto size = static_cast<size_t>(status.st_size);
+    // The mapping remains valid once the descriptor is closed
+    if (void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0); data != MAP_FAILED)
+    {
+      bytes_ = std::span{ static_cast<const std::byte*>(data), size };
+    }
+  }
+  close(fd);
+}
+
+MappedFile::~MappedFile() noexcept
+{
+  if (!bytes_.empty())
+  {
+    munmap(const_cast<std::byte*>(bytes_.data()), bytes_.size());
+  }
+}
+} // namespace luz::host
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace luz::host
+{
+/// A file mapped read-only into memory; the host counterpart of library::MappedPartition
+class MappedFile
+{
+public:
+  /// Map the file at path; bytes() is empty if it cannot be mapped
+  explicit MappedFile(const char* path) noexcept;
+  ~MappedFile() noexcept;
+
+  /// Copy/move constructor/assignment
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&&) = delete;
+  MappedFile& operator=(MappedFile&&) = delete;
+
+  std::span<const std::byte> bytes() const noexcept { return bytes_; }
+
+private:
+  std::span<const std::byte> bytes_{};
+};
+} // namespace luz::host
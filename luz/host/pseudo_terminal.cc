@@ -0,0 +1,92 @@
+#include "pseudo_terminal.hh"
+
+#include <cerrno>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace luz::host
+{
+PseudoTerminal::PseudoTerminal() noexcept
+{
+  master_ = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master_ < 0 || grantpt(master_) != 0 || unlockpt(master_) != 0)
+  {
+    return;
+  }
+  const char* name = ptsname(master_);
+  if (name == nullptr)
+  {
+    return;
+  }
+  slave_ = open(name, O_RDWR | O_NOCTTY);
+
+  // No line discipline: bytes pass through unchanged, and as soon as they are written
+  termios attributes{};
+  if (slave_ < 0 || tcgetattr(slave_, &attributes) != 0)
+  {
+    return;
+  }
+  cfmakeraw(&attributes);
+  (void)tcsetattr(slave_, TCSANOW, &attributes);
+  (void)fcntl(master_, F_SETFL, fcntl(master_, F_GETFL) | O_NONBLOCK);
+  (void)fcntl(slave_, F_SETFL, fcntl(slave_, F_GETFL) | O_NONBLOCK);
+}
+
+PseudoTerminal::~PseudoTerminal() noexcept
+{
+  if (slave_ >= 0)
+  {
+    close(slave_);
+  }
+  if (master_ >= 0)
+  {
+    close(master_);
+  }
+}
+
+SerialPort::SerialPort(int read_fd, int write_fd) noexcept
+    : read_fd_{ read_fd }, write_fd_{ write_fd }
+{
+}
+
+bool SerialPort::write(std::span<const std::byte> bytes) noexcept
+{
+  if (write_fd_ < 0)
+  {
+    return false;
+  }
+  while (!bytes.empty())
+  {
+    const auto written = ::write(write_fd_, bytes.data(), bytes.size());
+    if (written < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (written <= 0)
+    {
+      return false;
+    }
+    bytes = bytes.subspan(static_cast<size_t>(written));
+  }
+  return true;
+}
+
+size_t SerialPort::read(std::span<std::byte> bytes, uint32_t timeout_ms) noexcept
+{
+  if (read_fd_ < 0)
+  {
+    return 0UL;
+  }
+  pollfd readable{ .fd = read_fd_, .events = POLLIN, .revents = 0 };
+  if (poll(&readable, 1, static_cast<int>(timeout_ms)) <= 0)
+  {
+    return 0UL;
+  }
+  const auto size = ::read(read_fd_, bytes.data(), bytes.size());
+  return size > 0 ? static_cast<size_t>(size) : 0UL;
+}
+} // namespace luz::host
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace luz::host
+{
+/// A pseudo-terminal in raw mode standing in for a serial line between two boards: bytes written
+/// to the master are read from the slave, and the reverse
+class PseudoTerminal
+{
+public:
+  /// Open a pseudo-terminal; valid() is false if none could be opened
+  PseudoTerminal() noexcept;
+  ~PseudoTerminal() noexcept;
+
+  /// Copy/move constructor/assignment
+  PseudoTerminal(const PseudoTerminal&) = delete;
+  PseudoTerminal& operator=(const PseudoTerminal&) = delete;
+  PseudoTerminal(PseudoTerminal&&) = delete;
+  PseudoTerminal& operator=(PseudoTerminal&&) = delete;
+
+  bool valid() const noexcept { return master_ >= 0 && slave_ >= 0; }
+  int master() const noexcept { return master_; }
+  int slave() const noexcept { return slave_; }
+
+private:
+  int master_ = -1;
+  int slave_ = -1;
+};
+
+/// The UART of a board in the chain on the host, a fanout::Port: reads from the line of the board
+/// before it and writes to the line of the board after it. Either may be -1 for no line.
+class SerialPort
+{
+public:
+  SerialPort(int read_fd, int write_fd) noexcept;
+  ~SerialPort() noexcept = default;
+
+  /// Copy/move constructor/assignment
+  SerialPort(const SerialPort&) = delete;
+  SerialPort& operator=(const SerialPort&) = delete;
+  SerialPort(SerialPort&&) = delete;
+  SerialPort& operator=(SerialPort&&) = delete;
+
+  /// Write as much of bytes as the line takes without blocking, as a UART transmits whether or
+  /// not anything listens
+  /// @return false if any bytes were dropped
+  bool write(std::span<const std::byte> bytes) noexcept;
+
+  /// Wait up to timeout_ms for bytes, and read as many as have arrived
+  size_t read(std::span<std::byte> bytes, uint32_t timeout_ms) noexcept;
+
+private:
+  int read_fd_;
+  int write_fd_;
+};
+} // namespace luz::host
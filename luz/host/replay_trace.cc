@@ -0,0 +1,128 @@
+// Replays a corpus of climbs through the firmware pipeline and writes a trace of it, e.g.
+//
+//   replay_trace climbs.txt trace.json [write_size]
+//
+// The corpus is a climb listing as read by build_library (see listing.hh). Each climb is split
+// into writes of at most write_size bytes, as the Aurora app does for a small MTU, and every write
+// is processed, mapped to a frame and composed as on the device. The trace is written as Chrome
+// trace event JSON, which loads in Perfetto (ui.perfetto.dev) and chrome://tracing.
+
+#include "database.hh"
+#include "listing.hh"
+#include "palette.hh"
+#include "protocol.hh"
+#include "render.hh"
+#include "trace.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <span>
+#include <string>
+
+static_assert(LUZ_TRACE_ENABLED, "replay_trace must be built with LUZ_TRACE defined");
+
+namespace
+{
+/// Payload of a single write with the default ATT MTU of 23 bytes
+constexpr size_t default_write_size = 20UL;
+/// Time between consecutive writes, i.e. a typical connection interval
+constexpr uint32_t write_interval_ms = 30U;
+
+void to_frame(std::span<const luz::Placement> placements, luz::render::IndexedFrame& frame)
+{
+  LUZ_TRACE_SCOPE(scope, "to_frame");
+  LUZ_TRACE_ARG(scope, "placements", placements.size());
+  frame.fill(luz::render::palette_index(luz::Color{}));
+  for (const auto& placement : placements)
+  {
+    if (uint16_t pixel = 0U; luz::database::placement_to_pixel(placement.position, pixel))
+    {
+      frame[pixel] = luz::render::palette_index(placement.color);
+    }
+  }
+}
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+  if (argc != 3 && argc != 4)
+  {
+    std::fprintf(stderr, "usage: %s <climbs.txt> <trace.json> [write_size]\n", argv[0]);
+    return 1;
+  }
+
+  std::ifstream input{ argv[1] };
+  if (!input)
+  {
+    std::fprintf(stderr, "Cannot read %s\n", argv[1]);
+    return 1;
+  }
+
+  const size_t write_size
+      = argc == 4 ? std::strtoul(argv[3], nullptr, 10) : default_write_size;
+  if (write_size == 0UL)
+  {
+    std::fprintf(stderr, "The write size must be at least one byte\n");
+    return 1;
+  }
+
+  luz::protocol::Protocol protocol{};
+  luz::render::DefaultPipeline pipeline{};
+  luz::render::IndexedFrame frame{};
+  luz::render::Frame composed{};
+  luz::Packet packet{};
+
+  size_t num_climbs = 0UL;
+  size_t num_shown = 0UL;
+  uint32_t now = 0U;
+  std::string line{};
+  luz::host::ListingLine parsed{};
+  for (size_t line_number = 1UL; std::getline(input, line); ++line_number)
+  {
+    if (luz::host::is_comment(line))
+    {
+      continue;
+    }
+    if (!luz::host::parse_line(line, parsed))
+    {
+      std::fprintf(stderr, "%s:%zu: not a climb listing line\n", argv[1], line_number);
+      continue;
+    }
+
+    ++num_climbs;
+    for (std::span<const std::byte> bytes{ parsed.bytes }; !bytes.empty();
+         now += write_interval_ms)
+    {
+      const auto write = bytes.first(std::min(bytes.size(), write_size));
+      bytes = bytes.subspan(write.size());
+
+      if (protocol.process(write, packet))
+      {
+        to_frame(packet.placements, frame);
+        pipeline.layer<luz::render::ClimbLayer>().show(frame, now);
+        ++num_shown;
+      }
+      pipeline.compose(composed, now);
+    }
+  }
+
+  std::FILE* output = std::fopen(argv[2], "w");
+  if (output == nullptr)
+  {
+    std::fprintf(stderr, "Cannot write %s\n", argv[2]);
+    return 1;
+  }
+  luz::trace::write_chrome_json(output);
+  std::fclose(output);
+
+  std::printf("Replayed %zu climbs (%zu shown) in writes of %zu bytes: %zu events, %zu dropped\n",
+              num_climbs,
+              num_shown,
+              write_size,
+              luz::trace::size(),
+              luz::trace::dropped());
+  return 0;
+}
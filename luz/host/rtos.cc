@@ -0,0 +1,539 @@
+#include "rtos.hh"
+
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct QueueDefinition
+{
+  size_t length{};
+  size_t item_size{};
+  std::deque<std::vector<uint8_t>> items{};
+};
+
+struct tskTaskControlBlock
+{
+  enum class State
+  {
+    ready,
+    blocked,
+    deleted,
+  };
+
+  std::string name{};
+  UBaseType_t priority{};
+  TaskFunction_t function{};
+  void* parameter{};
+
+  State state = State::ready;
+  /// When the task last became ready, so that the longest ready runs first among equals
+  uint64_t ready_order{};
+  /// Tick at which a blocked task times out; portMAX_DELAY to block indefinitely
+  TickType_t wake_at = portMAX_DELAY;
+  bool timed_out = false;
+  /// What a blocked task is waiting for
+  QueueDefinition* waiting_to_receive{};
+  QueueDefinition* waiting_to_send{};
+  bool waiting_for_notification = false;
+
+  uint32_t notification{};
+};
+
+namespace luz::host::rtos
+{
+using Task = tskTaskControlBlock;
+
+struct Kernel
+{
+  std::mutex mutex{};
+  std::condition_variable handed_over{};
+  TickType_t now{};
+  /// End of the current run
+  TickType_t until{};
+  std::vector<std::unique_ptr<Task>> tasks{};
+  std::vector<std::unique_ptr<QueueDefinition>> queues{};
+  /// The task holding the processor, or nullptr while the driving thread holds it
+  Task* running{};
+  uint64_t order{};
+};
+
+namespace
+{
+using Lock = std::unique_lock<std::mutex>;
+
+std::shared_ptr<Kernel> installed{};
+/// The task run by this thread; nullptr on the driving thread
+thread_local Task* self = nullptr;
+
+Kernel& kernel() noexcept
+{
+  assert(installed != nullptr && "No rtos::Scheduler has been created");
+  return *installed;
+}
+
+TickType_t deadline(const Kernel& kernel, TickType_t ticks) noexcept
+{
+  if (ticks >= portMAX_DELAY - kernel.now)
+  {
+    return portMAX_DELAY;
+  }
+  return kernel.now + ticks;
+}
+
+void make_ready(Kernel& kernel, Task& task) noexcept
+{
+  task.state = Task::State::ready;
+  task.wake_at = portMAX_DELAY;
+  task.waiting_to_receive = nullptr;
+  task.waiting_to_send = nullptr;
+  task.waiting_for_notification = false;
+  task.ready_order = ++kernel.order;
+}
+
+/// The ready task of the highest priority, the longest ready among equals
+template <typename Predicate>
+Task* highest(const Kernel& kernel, Task::State state, Predicate predicate) noexcept
+{
+  Task* best = nullptr;
+  for (const auto& task : kernel.tasks)
+  {
+    if (task->state != state || !predicate(*task))
+    {
+      continue;
+    }
+    if (best == nullptr || task->priority > best->priority
+        || (task->priority == best->priority && task->ready_order < best->ready_order))
+    {
+      best = task.get();
+    }
+  }
+  return best;
+}
+
+Task* highest_ready(const Kernel& kernel) noexcept
+{
+  return highest(kernel, Task::State::ready, [](const Task&) { return true; });
+}
+
+/// Hand the processor to the next task to run, advancing the clock while every task is blocked,
+/// or back to the driving thread once the clock reaches the end of the run
+void dispatch(Kernel& kernel) noexcept
+{
+  while (true)
+  {
+    if (auto* next = highest_ready(kernel); next != nullptr)
+    {
+      kernel.running = next;
+      break;
+    }
+
+    TickType_t wake_at = portMAX_DELAY;
+    for (const auto& task : kernel.tasks)
+    {
+      if (task->state == Task::State::blocked)
+      {
+        wake_at = std::min(wake_at, task->wake_at);
+      }
+    }
+    if (wake_at == portMAX_DELAY || wake_at > kernel.until)
+    {
+      kernel.now = kernel.until;
+      kernel.running = nullptr;
+      break;
+    }
+
+    kernel.now = wake_at;
+    for (const auto& task : kernel.tasks)
+    {
+      if (task->state == Task::State::blocked && task->wake_at <= kernel.now)
+      {
+        make_ready(kernel, *task);
+        task->timed_out = true;
+      }
+    }
+  }
+  kernel.handed_over.notify_all();
+}
+
+/// Give up the processor until it is handed back to task
+void switch_from(Kernel& kernel, Lock& lock, Task& task) noexcept
+{
+  dispatch(kernel);
+  kernel.handed_over.wait(lock, [&kernel, &task] { return kernel.running == &task; });
+}
+
+/// Block the calling task until it is readied or the clock reaches wake_at
+/// @return false if it timed out
+bool block(Kernel& kernel, Lock& lock, TickType_t wake_at) noexcept
+{
+  self->state = Task::State::blocked;
+  self->wake_at = wake_at;
+  self->timed_out = false;
+  switch_from(kernel, lock, *self);
+  return !self->timed_out;
+}
+
+/// Let a task of a higher priority than the calling task, readied by it, run at once
+void preempt(Kernel& kernel, Lock& lock) noexcept
+{
+  if (self == nullptr)
+  {
+    return;
+  }
+  if (const auto* next = highest_ready(kernel); next != self && next->priority > self->priority)
+  {
+    switch_from(kernel, lock, *self);
+  }
+}
+
+/// Ready the task of the highest priority blocked on predicate, if any
+template <typename Predicate> void wake_one(Kernel& kernel, Predicate predicate) noexcept
+{
+  if (auto* task = highest(kernel, Task::State::blocked, predicate); task != nullptr)
+  {
+    make_ready(kernel, *task);
+  }
+}
+
+void run(std::shared_ptr<Kernel> kernel, Task* task) noexcept
+{
+  self = task;
+  {
+    Lock lock{ kernel->mutex };
+    kernel->handed_over.wait(lock, [&kernel, task] { return kernel->running == task; });
+  }
+
+  task->function(task->parameter);
+
+  Lock lock{ kernel->mutex };
+  task->state = Task::State::deleted;
+  dispatch(*kernel);
+}
+
+TaskHandle_t create(TaskFunction_t function,
+                    const char* name,
+                    void* parameter,
+                    UBaseType_t priority) noexcept
+{
+  auto& kernel = rtos::kernel();
+  Lock lock{ kernel.mutex };
+  auto task = std::make_unique<Task>();
+  task->name = name;
+  task->priority = priority;
+  task->function = function;
+  task->parameter = parameter;
+  make_ready(kernel, *task);
+
+  auto* handle = task.get();
+  kernel.tasks.push_back(std::move(task));
+  std::thread{ run, installed, handle }.detach();
+  preempt(kernel, lock);
+  return handle;
+}
+
+QueueHandle_t create_queue(size_t length, size_t item_size, size_t initial_items) noexcept
+{
+  auto& kernel = rtos::kernel();
+  const Lock lock{ kernel.mutex };
+  auto queue = std::make_unique<QueueDefinition>();
+  queue->length = length;
+  queue->item_size = item_size;
+  queue->items.resize(initial_items, std::vector<uint8_t>(item_size));
+  kernel.queues.push_back(std::move(queue));
+  return kernel.queues.back().get();
+}
+
+BaseType_t send(QueueHandle_t queue, const void* item, TickType_t ticks) noexcept
+{
+  auto& kernel = rtos::kernel();
+  Lock lock{ kernel.mutex };
+  const auto wake_at = deadline(kernel, ticks);
+  while (queue->items.size() >= queue->length)
+  {
+    if (self == nullptr || ticks == 0U)
+    {
+      return pdFAIL;
+    }
+    self->waiting_to_send = queue;
+    if (!block(kernel, lock, wake_at))
+    {
+      return pdFAIL;
+    }
+  }
+
+  const auto* bytes = static_cast<const uint8_t*>(item);
+  queue->items.emplace_back(bytes, bytes + queue->item_size);
+  wake_one(kernel, [queue](const Task& task) { return task.waiting_to_receive == queue; });
+  preempt(kernel, lock);
+  return pdPASS;
+}
+
+BaseType_t receive(QueueHandle_t queue, void* item, TickType_t ticks) noexcept
+{
+  auto& kernel = rtos::kernel();
+  Lock lock{ kernel.mutex };
+  const auto wake_at = deadline(kernel, ticks);
+  while (queue->items.empty())
+  {
+    if (self == nullptr || ticks == 0U)
+    {
+      return pdFAIL;
+    }
+    self->waiting_to_receive = queue;
+    if (!block(kernel, lock, wake_at))
+    {
+      return pdFAIL;
+    }
+  }
+
+  if (item != nullptr)
+  {
+    std::memcpy(item, queue->items.front().data(), queue->item_size);
+  }
+  queue->items.pop_front();
+  wake_one(kernel, [queue](const Task& task) { return task.waiting_to_send == queue; });
+  preempt(kernel, lock);
+  return pdPASS;
+}
+} // anonymous namespace
+
+Scheduler::Scheduler() noexcept : kernel_{ std::make_shared<Kernel>() }
+{
+  assert(installed == nullptr && "Only one rtos::Scheduler may exist at a time");
+  installed = kernel_;
+}
+
+Scheduler::~Scheduler() noexcept
+{
+  // Threads of the remaining tasks keep the kernel alive, blocked until a hand over which never
+  // comes
+  const Lock lock{ kernel_->mutex };
+  installed.reset();
+}
+
+void Scheduler::run_for(TickType_t ticks) noexcept
+{
+  Lock lock{ kernel_->mutex };
+  kernel_->until = deadline(*kernel_, ticks);
+  dispatch(*kernel_);
+  kernel_->handed_over.wait(lock, [this] { return kernel_->running == nullptr; });
+}
+
+TickType_t Scheduler::now() const noexcept
+{
+  const Lock lock{ kernel_->mutex };
+  return kernel_->now;
+}
+} // namespace luz::host::rtos
+
+using luz::host::rtos::Lock;
+using luz::host::rtos::Task;
+
+BaseType_t xTaskCreate(TaskFunction_t function,
+                       const char* name,
+                       [[maybe_unused]] uint32_t stack_depth,
+                       void* parameter,
+                       UBaseType_t priority,
+                       TaskHandle_t* created) noexcept
+{
+  auto* task = luz::host::rtos::create(function, name, parameter, priority);
+  if (created != nullptr)
+  {
+    *created = task;
+  }
+  return pdPASS;
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t function,
+                               const char* name,
+                               [[maybe_unused]] uint32_t stack_depth,
+                               void* parameter,
+                               UBaseType_t priority,
+                               [[maybe_unused]] StackType_t* stack,
+                               [[maybe_unused]] StaticTask_t* task) noexcept
+{
+  return luz::host::rtos::create(function, name, parameter, priority);
+}
+
+void vTaskDelete(TaskHandle_t task) noexcept
+{
+  using luz::host::rtos::self;
+  auto& kernel = luz::host::rtos::kernel();
+  Lock lock{ kernel.mutex };
+  task = task == nullptr ? self : task;
+  task->state = Task::State::deleted;
+  if (task == self)
+  {
+    // The thread of a deleted task never runs again
+    luz::host::rtos::dispatch(kernel);
+    kernel.handed_over.wait(lock, [] { return false; });
+  }
+}
+
+void vTaskDelay(TickType_t ticks) noexcept
+{
+  using luz::host::rtos::self;
+  if (self == nullptr)
+  {
+    return;
+  }
+  auto& kernel = luz::host::rtos::kernel();
+  Lock lock{ kernel.mutex };
+  if (ticks == 0U)
+  {
+    // Yield to the other ready tasks of the same priority
+    self->ready_order = ++kernel.order;
+    luz::host::rtos::switch_from(kernel, lock, *self);
+    return;
+  }
+  (void)luz::host::rtos::block(kernel, lock, luz::host::rtos::deadline(kernel, ticks));
+}
+
+BaseType_t xTaskDelayUntil(TickType_t* previous_wake, TickType_t increment) noexcept
+{
+  using luz::host::rtos::self;
+  auto& kernel = luz::host::rtos::kernel();
+  Lock lock{ kernel.mutex };
+  const auto wake_at = *previous_wake + increment;
+  *previous_wake = wake_at;
+  if (self == nullptr || wake_at <= kernel.now)
+  {
+    return pdFALSE;
+  }
+  (void)luz::host::rtos::block(kernel, lock, wake_at);
+  return pdTRUE;
+}
+
+void taskYIELD() noexcept { vTaskDelay(0U); }
+
+TickType_t xTaskGetTickCount() noexcept
+{
+  auto& kernel = luz::host::rtos::kernel();
+  const Lock lock{ kernel.mutex };
+  return kernel.now;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() noexcept { return luz::host::rtos::self; }
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task) noexcept
+{
+  task = task == nullptr ? luz::host::rtos::self : task;
+  return task == nullptr ? 0U : task->priority;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark([[maybe_unused]] TaskHandle_t task) noexcept { return 0U; }
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) noexcept
+{
+  auto& kernel = luz::host::rtos::kernel();
+  Lock lock{ kernel.mutex };
+  ++task->notification;
+  if (task->state == Task::State::blocked && task->waiting_for_notification)
+  {
+    luz::host::rtos::make_ready(kernel, *task);
+    luz::host::rtos::preempt(kernel, lock);
+  }
+  return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) noexcept
+{
+  using luz::host::rtos::self;
+  auto& kernel = luz::host::rtos::kernel();
+  Lock lock{ kernel.mutex };
+  if (self == nullptr)
+  {
+    return 0U;
+  }
+  if (self->notification == 0U && ticks > 0U)
+  {
+    self->waiting_for_notification = true;
+    (void)luz::host::rtos::block(kernel, lock, luz::host::rtos::deadline(kernel, ticks));
+  }
+
+  const auto value = self->notification;
+  if (value > 0U)
+  {
+    self->notification = clear_on_exit != pdFALSE ? 0U : value - 1U;
+  }
+  return value;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) noexcept
+{
+  return luz::host::rtos::create_queue(length, item_size, 0UL);
+}
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length,
+                                 UBaseType_t item_size,
+                                 [[maybe_unused]] uint8_t* storage,
+                                 [[maybe_unused]] StaticQueue_t* queue) noexcept
+{
+  return luz::host::rtos::create_queue(length, item_size, 0UL);
+}
+
+void vQueueDelete(QueueHandle_t queue) noexcept
+{
+  auto& kernel = luz::host::rtos::kernel();
+  const Lock lock{ kernel.mutex };
+  std::erase_if(kernel.queues, [queue](const auto& other) { return other.get() == queue; });
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks) noexcept
+{
+  return luz::host::rtos::send(queue, item, ticks);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks) noexcept
+{
+  return luz::host::rtos::send(queue, item, ticks);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks) noexcept
+{
+  return luz::host::rtos::receive(queue, item, ticks);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) noexcept
+{
+  auto& kernel = luz::host::rtos::kernel();
+  const Lock lock{ kernel.mutex };
+  return static_cast<UBaseType_t>(queue->items.size());
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() noexcept
+{
+  return luz::host::rtos::create_queue(1UL, 0UL, 1UL);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic([[maybe_unused]] StaticSemaphore_t* mutex) noexcept
+{
+  return luz::host::rtos::create_queue(1UL, 0UL, 1UL);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() noexcept
+{
+  return luz::host::rtos::create_queue(1UL, 0UL, 0UL);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) noexcept { vQueueDelete(semaphore); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) noexcept
+{
+  return luz::host::rtos::receive(semaphore, nullptr, ticks);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) noexcept
+{
+  return luz::host::rtos::send(semaphore, nullptr, 0U);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+#include <memory>
+
+namespace luz::host::rtos
+{
+struct Kernel;
+
+/// Runs the tasks created through the FreeRTOS shim in virtual time, so that multi-task code is
+/// exercised deterministically on the host.
+///
+/// Each task runs on a thread of its own, but only one runs at a time: the ready task of the
+/// highest priority, the longest ready among equals. A task runs until it blocks in a delay, on a
+/// queue, semaphore or notification, or until it readies a task of a higher priority, which
+/// preempts it. Computation takes no virtual time; the clock only advances once every task is
+/// blocked, straight to the earliest timeout. Time slicing between tasks of equal priority is not
+/// simulated, so a task which never blocks starves the others as it would without preemption.
+///
+/// The FreeRTOS primitives may be called from the thread driving the scheduler, as from an
+/// interrupt: they never block there, and any task they ready runs once the scheduler does.
+class Scheduler
+{
+public:
+  /// Install the scheduler; only one may exist at a time. The clock starts at tick 0.
+  Scheduler() noexcept;
+  /// Tasks which have not returned or been deleted are left parked for good on their threads
+  ~Scheduler() noexcept;
+
+  /// Copy/move constructor/assignment
+  Scheduler(const Scheduler&) = delete;
+  Scheduler& operator=(const Scheduler&) = delete;
+  Scheduler(Scheduler&&) = delete;
+  Scheduler& operator=(Scheduler&&) = delete;
+
+  /// Run the tasks until the clock has advanced by ticks and no task is ready
+  void run_for(TickType_t ticks) noexcept;
+
+  TickType_t now() const noexcept;
+
+private:
+  std::shared_ptr<Kernel> kernel_;
+};
+} // namespace luz::host::rtos
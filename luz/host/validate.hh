@@ -0,0 +1,88 @@
+#pragma once
+
+#include "database.hh"
+#include "decoder.hh"
+#include "packet.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace luz::host
+{
+/// Readable name of a decode status for reports
+inline const char* to_string(protocol::ProtocolStatus status) noexcept
+{
+  using protocol::ProtocolStatus;
+  switch (status)
+  {
+  case ProtocolStatus::success:
+    return "success";
+  case ProtocolStatus::incomplete:
+    return "incomplete";
+  case ProtocolStatus::insufficient_header_bytes:
+    return "insufficient header bytes";
+  case ProtocolStatus::bad_header:
+    return "bad header";
+  case ProtocolStatus::bad_payload:
+    return "bad payload";
+  case ProtocolStatus::bad_footer:
+    return "bad footer";
+  case ProtocolStatus::bad_checksum:
+    return "bad checksum";
+  }
+  return "unknown";
+}
+
+/// Outcome of validating a single climb against the board
+struct ClimbReport
+{
+  /// success, or the reason the first malformed packet failed to decode
+  protocol::ProtocolStatus status{ protocol::ProtocolStatus::success };
+  size_t num_packets{};
+  size_t num_placements{};
+  /// Positions of the placements which have no pixel on the board, in order of appearance
+  std::vector<uint16_t> unknown_positions{};
+
+  bool valid() const noexcept
+  {
+    return status == protocol::ProtocolStatus::success && unknown_positions.empty();
+  }
+};
+
+/// Decode every packet of a climb and check that each placement maps onto a pixel of the board
+/// @param bytes The packets of the climb, back to back
+/// @param scratch Reused for the placements of each packet, avoiding an allocation per climb
+inline ClimbReport validate(std::span<const std::byte> bytes, std::vector<Placement>& scratch)
+{
+  ClimbReport report{};
+  if (bytes.empty())
+  {
+    report.status = protocol::ProtocolStatus::insufficient_header_bytes;
+    return report;
+  }
+
+  while (!bytes.empty())
+  {
+    Packet::Header header{};
+    report.status = protocol::decode(bytes, header, scratch);
+    if (report.status != protocol::ProtocolStatus::success)
+    {
+      return report;
+    }
+
+    ++report.num_packets;
+    report.num_placements += scratch.size();
+    for (const auto& placement : scratch)
+    {
+      if (uint16_t pixel = 0U; !database::placement_to_pixel(placement.position, pixel))
+      {
+        report.unknown_positions.push_back(placement.position);
+      }
+    }
+    bytes = bytes.subspan(protocol::packet_size(header));
+  }
+  return report;
+}
+} // namespace luz::host
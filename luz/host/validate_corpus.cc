@@ -0,0 +1,128 @@
+// Validates a corpus of climbs against the board before rollout, e.g.
+//
+//   validate_corpus climbs.txt [threads]
+//
+// The corpus is a climb listing as read by build_library (see listing.hh); the packets of a climb
+// spanning several packets are listed back to back on its line. Every climb which fails to decode
+// or places holds at positions unknown to the board is reported, followed by the aggregate
+// throughput. The exit status is non-zero if any climb is invalid.
+
+#include "listing.hh"
+#include "validate.hh"
+#include "work_stealing_pool.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+/// Number of climbs in each chunk of work
+constexpr size_t grain = 64UL;
+
+struct Climb
+{
+  size_t line_number{};
+  std::vector<std::byte> bytes{};
+};
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+  if (argc != 2 && argc != 3)
+  {
+    std::fprintf(stderr, "usage: %s <climbs.txt> [threads]\n", argv[0]);
+    return 1;
+  }
+
+  std::ifstream input{ argv[1] };
+  if (!input)
+  {
+    std::fprintf(stderr, "Cannot read %s\n", argv[1]);
+    return 1;
+  }
+
+  // Read the whole corpus up front so only decoding is timed
+  std::vector<Climb> climbs{};
+  size_t num_bytes = 0UL;
+  size_t num_unparsable = 0UL;
+  std::string line{};
+  luz::host::ListingLine parsed{};
+  for (size_t line_number = 1UL; std::getline(input, line); ++line_number)
+  {
+    if (luz::host::is_comment(line))
+    {
+      continue;
+    }
+    if (!luz::host::parse_line(line, parsed))
+    {
+      std::printf("%s:%zu: not a climb listing line\n", argv[1], line_number);
+      ++num_unparsable;
+      continue;
+    }
+    num_bytes += parsed.bytes.size();
+    climbs.push_back(Climb{ .line_number = line_number, .bytes = parsed.bytes });
+  }
+
+  const size_t num_threads = argc == 3 ? std::strtoul(argv[2], nullptr, 10)
+                                       : std::thread::hardware_concurrency();
+  luz::host::WorkStealingPool pool{ num_threads };
+  std::vector<luz::host::ClimbReport> reports(climbs.size());
+  std::vector<std::vector<luz::Placement>> scratch(pool.num_workers());
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto steals = pool.for_each_index(climbs.size(), grain, [&](size_t worker, size_t index) {
+    reports[index] = luz::host::validate(climbs[index].bytes, scratch[worker]);
+  });
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  size_t num_malformed = 0UL;
+  size_t num_unknown = 0UL;
+  size_t num_placements = 0UL;
+  for (size_t index = 0UL; index < climbs.size(); ++index)
+  {
+    const auto& report = reports[index];
+    num_placements += report.num_placements;
+    if (report.status != luz::protocol::ProtocolStatus::success)
+    {
+      ++num_malformed;
+      std::printf("%s:%zu: packet %zu: %s\n",
+                  argv[1],
+                  climbs[index].line_number,
+                  report.num_packets + 1UL,
+                  luz::host::to_string(report.status));
+    }
+    if (!report.unknown_positions.empty())
+    {
+      ++num_unknown;
+      std::printf("%s:%zu: unknown positions:", argv[1], climbs[index].line_number);
+      for (const auto position : report.unknown_positions)
+      {
+        std::printf(" %u", static_cast<unsigned>(position));
+      }
+      std::printf("\n");
+    }
+  }
+
+  const double seconds = elapsed.count();
+  std::printf("Validated %zu climbs (%zu placements, %zu bytes) on %zu threads in %.3f ms: "
+              "%.0f climbs/s, %.1f MB/s, %zu chunks stolen\n",
+              climbs.size(),
+              num_placements,
+              num_bytes,
+              pool.num_workers(),
+              seconds * 1e3,
+              seconds > 0.0 ? static_cast<double>(climbs.size()) / seconds : 0.0,
+              seconds > 0.0 ? static_cast<double>(num_bytes) / seconds / 1e6 : 0.0,
+              steals);
+  std::printf("%zu unparsable, %zu malformed, %zu with unknown positions\n",
+              num_unparsable,
+              num_malformed,
+              num_unknown);
+  return (num_unparsable + num_malformed + num_unknown) == 0UL ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace luz::host
+{
+/// Runs a function over a range of indices on a set of worker threads. The indices are split
+/// into chunks dealt round-robin to a deque per worker; each worker takes chunks from the back of
+/// its own deque and, once that runs dry, steals from the front of the others', so uneven work
+/// is balanced without a shared queue.
+class WorkStealingPool
+{
+public:
+  explicit WorkStealingPool(size_t num_workers = std::thread::hardware_concurrency()) noexcept
+      : num_workers_{ std::max(num_workers, size_t{ 1UL }) }
+  {
+  }
+  ~WorkStealingPool() noexcept = default;
+
+  /// Copy/move constructor/assignment
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+  WorkStealingPool(WorkStealingPool&&) = delete;
+  WorkStealingPool& operator=(WorkStealingPool&&) = delete;
+
+  size_t num_workers() const noexcept { return num_workers_; }
+
+  /// Invoke f(worker, index) once for each index in [0, count), returning when all have completed
+  /// @param grain Number of consecutive indices in each chunk
+  /// @return Number of chunks stolen from another worker
+  template <std::invocable<size_t, size_t> F>
+  size_t for_each_index(size_t count, size_t grain, F&& f);
+
+private:
+  struct Chunk
+  {
+    size_t begin{};
+    size_t end{};
+  };
+
+  struct Queue
+  {
+    std::mutex mutex{};
+    std::deque<Chunk> chunks{};
+  };
+
+  static bool pop_back(Queue& queue, Chunk& chunk);
+  static bool pop_front(Queue& queue, Chunk& chunk);
+
+  size_t num_workers_;
+};
+
+template <std::invocable<size_t, size_t> F>
+size_t WorkStealingPool::for_each_index(size_t count, size_t grain, F&& f)
+{
+  grain = std::max(grain, size_t{ 1UL });
+  const auto queues = std::make_unique<Queue[]>(num_workers_);
+  for (size_t begin = 0UL, chunk = 0UL; begin < count; begin += grain, ++chunk)
+  {
+    queues[chunk % num_workers_].chunks.push_back(
+        Chunk{ .begin = begin, .end = std::min(begin + grain, count) });
+  }
+
+  std::atomic<size_t> steals{};
+  {
+    std::vector<std::jthread> workers{};
+    workers.reserve(num_workers_);
+    for (size_t worker = 0UL; worker < num_workers_; ++worker)
+    {
+      workers.emplace_back([this, worker, &queues, &steals, &f] {
+        Chunk chunk{};
+        while (true)
+        {
+          if (!pop_back(queues[worker], chunk))
+          {
+            // No work is added once started, so finding every other deque empty means done
+            bool stolen = false;
+            for (size_t victim = 1UL; victim < num_workers_ && !stolen; ++victim)
+            {
+              stolen = pop_front(queues[(worker + victim) % num_workers_], chunk);
+            }
+            if (!stolen)
+            {
+              return;
+            }
+            ++steals;
+          }
+
+          for (size_t index = chunk.begin; index < chunk.end; ++index)
+          {
+            f(worker, index);
+          }
+        }
+      });
+    }
+  }
+  return steals;
+}
+
+inline bool WorkStealingPool::pop_back(Queue& queue, Chunk& chunk)
+{
+  const std::lock_guard lock{ queue.mutex };
+  if (queue.chunks.empty())
+  {
+    return false;
+  }
+  chunk = queue.chunks.back();
+  queue.chunks.pop_back();
+  return true;
+}
+
+inline bool WorkStealingPool::pop_front(Queue& queue, Chunk& chunk)
+{
+  const std::lock_guard lock{ queue.mutex };
+  if (queue.chunks.empty())
+  {
+    return false;
+  }
+  chunk = queue.chunks.front();
+  queue.chunks.pop_front();
+  return true;
+}
+} // namespace luz::host
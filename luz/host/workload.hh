@@ -0,0 +1,210 @@
+#pragma once
+
+#include "database.hh"
+#include "encoder.hh"
+#include "packet.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace luz::host
+{
+/// Hold colors as sent by the Aurora app for each role of a hold in a climb
+constexpr auto start_color = Color{ 0U, 224U, 0U };
+constexpr auto hand_color = Color{ 0U, 0U, 192U };
+constexpr auto finish_color = Color{ 224U, 0U, 192U };
+constexpr auto foot_color = Color{ 224U, 0U, 0U };
+
+/// Every position of the board with a pixel, i.e. which a climb can place a hold on
+inline std::vector<uint16_t> valid_positions()
+{
+  std::vector<uint16_t> positions{};
+  for (uint16_t position = 0U; position < database::num_positions; ++position)
+  {
+    if (uint16_t pixel = 0U; database::placement_to_pixel(position, pixel))
+    {
+      positions.push_back(position);
+    }
+  }
+  return positions;
+}
+
+/// Draws random climbs shaped like those set on the board: one or two start holds, hand holds,
+/// feet and one or two finish holds, each on a distinct valid position
+class ClimbGenerator
+{
+public:
+  /// @param min_holds, max_holds Bounds of the number of holds in each climb
+  /// @pre 2 <= min_holds <= max_holds <= number of valid positions
+  explicit ClimbGenerator(uint64_t seed, size_t min_holds = 4UL, size_t max_holds = 20UL)
+      : random_{ seed }, positions_{ valid_positions() }, min_holds_{ min_holds },
+        max_holds_{ max_holds }
+  {
+  }
+
+  /// Draw the placements of the next climb
+  void next(std::vector<Placement>& placements)
+  {
+    const auto num_holds
+        = std::uniform_int_distribution<size_t>{ min_holds_, max_holds_ }(random_);
+    // A partial shuffle draws the positions without repetition
+    for (size_t index = 0UL; index < num_holds; ++index)
+    {
+      const auto other
+          = std::uniform_int_distribution<size_t>{ index, positions_.size() - 1UL }(random_);
+      std::swap(positions_[index], positions_[other]);
+    }
+
+    const size_t num_start = std::min<size_t>(num_holds / 2UL, 1UL + random_() % 2UL);
+    const size_t num_finish = std::min<size_t>(num_holds - num_start, 1UL + random_() % 2UL);
+    const size_t num_feet = (num_holds - num_start - num_finish) / 4UL;
+
+    placements.clear();
+    for (size_t index = 0UL; index < num_holds; ++index)
+    {
+      const auto color = index < num_start                           ? start_color
+                         : index < num_start + num_finish            ? finish_color
+                         : index < num_start + num_finish + num_feet ? foot_color
+                                                                     : hand_color;
+      placements.push_back(Placement{ .position = positions_[index], .color = color });
+    }
+  }
+
+private:
+  std::mt19937_64 random_;
+  std::vector<uint16_t> positions_;
+  size_t min_holds_;
+  size_t max_holds_;
+};
+
+/// Bytes of the ATT header preceding the value of each write
+constexpr size_t att_header_size = 3UL;
+
+/// A sequence of characteristic writes stored back to back, avoiding an allocation per write
+class Writes
+{
+public:
+  size_t size() const noexcept { return ends_.size(); }
+  bool empty() const noexcept { return ends_.empty(); }
+  size_t num_bytes() const noexcept { return bytes_.size(); }
+
+  std::span<const std::byte> operator[](size_t index) const noexcept
+  {
+    const auto begin = index == 0UL ? 0UL : ends_[index - 1UL];
+    return std::span(bytes_).subspan(begin, ends_[index] - begin);
+  }
+
+  void push_back(std::span<const std::byte> write)
+  {
+    bytes_.insert(bytes_.end(), write.begin(), write.end());
+    ends_.push_back(bytes_.size());
+  }
+
+  /// The most recently appended write, e.g. to corrupt it
+  /// @pre !empty()
+  std::span<std::byte> back() noexcept
+  {
+    const auto begin = ends_.size() == 1UL ? 0UL : ends_[ends_.size() - 2UL];
+    return std::span(bytes_).subspan(begin);
+  }
+
+  /// Append a copy of the most recently appended write
+  /// @pre !empty()
+  void repeat_back()
+  {
+    const auto size = back().size();
+    bytes_.resize(bytes_.size() + size);
+    std::copy_n(bytes_.end() - 2L * static_cast<ptrdiff_t>(size), size, bytes_.end() - size);
+    ends_.push_back(bytes_.size());
+  }
+
+  void clear() noexcept
+  {
+    bytes_.clear();
+    ends_.clear();
+  }
+
+private:
+  std::vector<std::byte> bytes_{};
+  std::vector<size_t> ends_{};
+};
+
+/// Split the bytes of a climb into the writes a client with the given ATT MTU sends
+/// @pre mtu > att_header_size
+inline void split(std::span<const std::byte> bytes, size_t mtu, Writes& writes)
+{
+  const auto write_size = mtu - att_header_size;
+  for (; !bytes.empty(); bytes = bytes.subspan(std::min(bytes.size(), write_size)))
+  {
+    writes.push_back(bytes.first(std::min(bytes.size(), write_size)));
+  }
+}
+
+/// Probability of each fault being injected into a single write
+struct FaultRates
+{
+  /// The write never arrives
+  double drop{};
+  /// The write arrives twice
+  double duplicate{};
+  /// A single bit of the write is flipped
+  double corrupt{};
+};
+
+/// Number of each fault injected
+struct FaultCounts
+{
+  size_t dropped{};
+  size_t duplicated{};
+  size_t corrupted{};
+};
+
+/// Degrades a stream of writes as an unreliable link would
+class FaultInjector
+{
+public:
+  FaultInjector(uint64_t seed, FaultRates rates) : random_{ seed }, rates_{ rates } {}
+
+  /// Append the write as it arrives after passing over the link, if at all
+  void transmit(std::span<const std::byte> write, Writes& writes)
+  {
+    if (chance(rates_.drop))
+    {
+      ++counts_.dropped;
+      return;
+    }
+
+    writes.push_back(write);
+    if (chance(rates_.corrupt) && !write.empty())
+    {
+      ++counts_.corrupted;
+      const auto bit
+          = std::uniform_int_distribution<size_t>{ 0UL, write.size() * 8UL - 1UL }(random_);
+      writes.back()[bit / 8UL] ^= static_cast<std::byte>(1U << (bit % 8UL));
+    }
+
+    if (chance(rates_.duplicate))
+    {
+      ++counts_.duplicated;
+      writes.repeat_back();
+    }
+  }
+
+  const FaultCounts& counts() const noexcept { return counts_; }
+
+private:
+  bool chance(double probability) noexcept
+  {
+    return probability > 0.0 && std::uniform_real_distribution<double>{}(random_) < probability;
+  }
+
+  std::mt19937_64 random_;
+  FaultRates rates_;
+  FaultCounts counts_{};
+};
+} // namespace luz::host
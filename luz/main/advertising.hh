@@ -0,0 +1,75 @@
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+
+namespace luz::ble
+{
+enum class ConnectionState : uint8_t
+{
+  /// Advertising at the fast interval for a burst after boot or a disconnection
+  advertising_fast = 0,
+  /// Advertising at the slow interval once the burst has passed without a connection
+  advertising_slow,
+  /// A client is connected; advertising continues at the slow interval for further clients
+  connected,
+};
+
+/// Advertising intervals are in units of 0.625ms
+template <typename T>
+concept Advertiser = requires(T& advertiser, uint16_t interval) {
+  advertiser.start(interval);
+  advertiser.stop();
+};
+
+/// Policy deciding how often the peripheral advertises. A client which has just dropped the link
+/// usually tries to reconnect straight away, so the fast interval is used for a burst after boot
+/// and after each disconnection, backing off to the slow interval to save power.
+/// Every transition of the connection state is reported to the listener.
+template <Advertiser A, std::invocable<ConnectionState> Listener> class AdvertisingScheduler
+{
+public:
+  /// 30ms, the fastest interval recommended for reconnection by the Bluetooth design guidelines
+  static constexpr uint16_t fast_interval = 0x30U;
+  /// ~1.2s
+  static constexpr uint16_t slow_interval = 0x780U;
+  /// Time spent advertising at the fast interval before backing off
+  static constexpr uint32_t burst_ms = 30'000U;
+
+  AdvertisingScheduler(A& advertiser, Listener listener) noexcept;
+  ~AdvertisingScheduler() noexcept = default;
+
+  /// Copy/move constructor/assignment
+  AdvertisingScheduler(const AdvertisingScheduler&) = delete;
+  AdvertisingScheduler& operator=(const AdvertisingScheduler&) = delete;
+  AdvertisingScheduler(AdvertisingScheduler&&) = delete;
+  AdvertisingScheduler& operator=(AdvertisingScheduler&&) = delete;
+
+  /// Begin advertising after boot
+  void start(uint32_t now_ms) noexcept;
+  void connected(uint32_t now_ms) noexcept;
+  void disconnected(uint32_t now_ms) noexcept;
+
+  /// Follow the connections and disconnections counted so far. Comparing the disconnections with
+  /// those last seen catches a client which connected and disconnected since, which the current
+  /// connection state alone would miss.
+  /// @pre disconnects was read before connects, so it never counts a connection connects does not
+  void follow(uint32_t connects, uint32_t disconnects, uint32_t now_ms) noexcept;
+
+  /// Back off to the slow interval once the burst has passed
+  void update(uint32_t now_ms) noexcept;
+
+  ConnectionState state() const noexcept { return state_; }
+
+private:
+  void transition(ConnectionState state, uint16_t interval, uint32_t now_ms) noexcept;
+
+  A& advertiser_;
+  Listener listener_;
+  ConnectionState state_{ ConnectionState::advertising_slow };
+  uint32_t burst_started_ms_{};
+  uint32_t disconnects_seen_{};
+};
+} // namespace luz::ble
+
+#include "advertising.inl"
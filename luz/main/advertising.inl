@@ -0,0 +1,80 @@
+#pragma once
+
+#include "advertising.hh"
+
+#include <functional>
+#include <utility>
+
+namespace luz::ble
+{
+template <Advertiser A, std::invocable<ConnectionState> Listener>
+AdvertisingScheduler<A, Listener>::AdvertisingScheduler(A& advertiser, Listener listener) noexcept
+    : advertiser_{ advertiser }, listener_{ std::move(listener) }
+{
+}
+
+template <Advertiser A, std::invocable<ConnectionState> Listener>
+void AdvertisingScheduler<A, Listener>::start(uint32_t now_ms) noexcept
+{
+  transition(ConnectionState::advertising_fast, fast_interval, now_ms);
+}
+
+template <Advertiser A, std::invocable<ConnectionState> Listener>
+void AdvertisingScheduler<A, Listener>::connected(uint32_t now_ms) noexcept
+{
+  if (state_ != ConnectionState::connected)
+  {
+    transition(ConnectionState::connected, slow_interval, now_ms);
+  }
+}
+
+template <Advertiser A, std::invocable<ConnectionState> Listener>
+void AdvertisingScheduler<A, Listener>::disconnected(uint32_t now_ms) noexcept
+{
+  transition(ConnectionState::advertising_fast, fast_interval, now_ms);
+}
+
+template <Advertiser A, std::invocable<ConnectionState> Listener>
+void AdvertisingScheduler<A, Listener>::follow(uint32_t connects,
+                                               uint32_t disconnects,
+                                               uint32_t now_ms) noexcept
+{
+  // Further clients may remain connected after one disconnects, in which case nothing changes
+  const bool disconnected_since = std::exchange(disconnects_seen_, disconnects) != disconnects;
+  if (connects != disconnects)
+  {
+    connected(now_ms);
+  }
+  else if (disconnected_since)
+  {
+    disconnected(now_ms);
+  }
+}
+
+template <Advertiser A, std::invocable<ConnectionState> Listener>
+void AdvertisingScheduler<A, Listener>::update(uint32_t now_ms) noexcept
+{
+  // Unsigned subtraction keeps the comparison correct across wrap-around of the clock
+  if (state_ == ConnectionState::advertising_fast && (now_ms - burst_started_ms_) >= burst_ms)
+  {
+    transition(ConnectionState::advertising_slow, slow_interval, now_ms);
+  }
+}
+
+template <Advertiser A, std::invocable<ConnectionState> Listener>
+void AdvertisingScheduler<A, Listener>::transition(ConnectionState state,
+                                                   uint16_t interval,
+                                                   uint32_t now_ms) noexcept
+{
+  burst_started_ms_ = now_ms;
+  if (std::exchange(state_, state) == state)
+  {
+    // Each state has its own interval, so the advertisement already running is kept
+    return;
+  }
+  // The interval of a running advertisement cannot be changed, so it is restarted
+  advertiser_.stop();
+  advertiser_.start(interval);
+  std::invoke(listener_, state);
+}
+} // namespace luz::ble
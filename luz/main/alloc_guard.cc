@@ -0,0 +1,126 @@
+#include "alloc_guard.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(ESP_PLATFORM)
+#include "esp_rom_sys.h"
+#else
+#include <unistd.h>
+#endif
+
+#if LUZ_HEAP_GUARD_ENABLED && defined(ESP_PLATFORM)
+#include "esp_heap_caps.h"
+#endif
+
+namespace luz::heap
+{
+namespace
+{
+std::atomic<bool> boot_complete_{ false };
+std::atomic<Policy> policy_{ default_policy };
+std::atomic<uint32_t> allocations_{};
+std::atomic<size_t> bytes_{};
+
+/// Report an allocation after boot without going through stdio, which may lock or allocate
+void report(size_t size) noexcept
+{
+#if defined(ESP_PLATFORM)
+  esp_rom_printf("luz::heap: %u byte allocation after boot completed\n",
+                 static_cast<unsigned>(size));
+#else
+  char message[64];
+  const int length = snprintf(
+      message, sizeof(message), "luz::heap: %zu byte allocation after boot completed\n", size);
+  if (length > 0)
+  {
+    const auto count = std::min(static_cast<size_t>(length), sizeof(message) - 1UL);
+    (void)write(STDERR_FILENO, message, count);
+  }
+#endif
+}
+
+[[maybe_unused]] void on_allocation(size_t size) noexcept
+{
+  if (!boot_complete_.load(std::memory_order_relaxed))
+  {
+    return;
+  }
+
+  allocations_.fetch_add(1U, std::memory_order_relaxed);
+  bytes_.fetch_add(size, std::memory_order_relaxed);
+
+  if (policy_.load(std::memory_order_relaxed) == Policy::abort)
+  {
+    report(size);
+    std::abort();
+  }
+}
+} // anonymous namespace
+
+void mark_boot_complete(Policy policy) noexcept
+{
+  policy_ = policy;
+  boot_complete_ = true;
+}
+
+void reset() noexcept
+{
+  boot_complete_ = false;
+  policy_ = default_policy;
+  allocations_ = 0U;
+  bytes_ = 0UL;
+}
+
+bool boot_complete() noexcept { return boot_complete_; }
+
+uint32_t allocations_after_boot() noexcept { return allocations_; }
+
+size_t bytes_after_boot() noexcept { return bytes_; }
+} // namespace luz::heap
+
+#if LUZ_HEAP_GUARD_ENABLED
+
+#if defined(ESP_PLATFORM) && defined(CONFIG_HEAP_USE_HOOKS)
+/// Called by the ESP-IDF heap for every allocation, including malloc() from C components
+extern "C" void esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps)
+{
+  luz::heap::on_allocation(size);
+}
+
+extern "C" void esp_heap_trace_free_hook(void* ptr) {}
+#else
+/// Without heap hooks only C++ allocations are observed
+void* operator new(size_t size)
+{
+  luz::heap::on_allocation(size);
+  if (void* ptr = std::malloc(size == 0UL ? 1UL : size))
+  {
+    return ptr;
+  }
+  std::abort();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+  luz::heap::on_allocation(size);
+  return std::malloc(size == 0UL ? 1UL : size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{
+  return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+#endif
+
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(ESP_PLATFORM)
+#include "sdkconfig.h"
+#endif
+
+/// The guard is enabled by CONFIG_LUZ_HEAP_GUARD on the device and by defining LUZ_HEAP_GUARD in
+/// host builds. When disabled the functions below are no-ops and no allocator hooks are installed.
+#if defined(CONFIG_LUZ_HEAP_GUARD) || defined(LUZ_HEAP_GUARD)
+#define LUZ_HEAP_GUARD_ENABLED 1
+#else
+#define LUZ_HEAP_GUARD_ENABLED 0
+#endif
+
+namespace luz::heap
+{
+/// Action taken when the heap is used after boot has completed
+enum class Policy : uint8_t
+{
+  /// Count the allocation and continue
+  count,
+  /// Abort, reporting the size of the offending allocation
+  abort,
+};
+
+#if defined(CONFIG_LUZ_HEAP_GUARD_ABORT)
+constexpr auto default_policy = Policy::abort;
+#else
+constexpr auto default_policy = Policy::count;
+#endif
+
+/// Mark initialisation as complete; every heap allocation from now on is a violation
+void mark_boot_complete(Policy policy = default_policy) noexcept;
+
+/// Revert to the boot state, e.g. between host tests
+void reset() noexcept;
+
+/// Whether mark_boot_complete() has been called
+bool boot_complete() noexcept;
+
+/// Number of heap allocations made since boot completed
+uint32_t allocations_after_boot() noexcept;
+
+/// Total number of bytes requested by heap allocations since boot completed
+size_t bytes_after_boot() noexcept;
+} // namespace luz::heap
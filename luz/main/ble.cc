@@ -5,15 +5,14 @@ namespace luz::ble::detail
 void ServerCallbacks::onConnect(NimBLEServer* server_, NimBLEConnInfo& conn_info)
 {
   ESP_LOGI(detail::tag, "Client address: %s\n", conn_info.getAddress().toString().c_str());
-  // restart_advertising=true;
-  NimBLEDevice::startAdvertising();
+  // Advertising is restarted by the AdvertisingScheduler polling the events
+  ++events_.connects;
 }
 
 void ServerCallbacks::onDisconnect(NimBLEServer* server_, NimBLEConnInfo& conn_info, int reason)
 {
-  ESP_LOGI(detail::tag, "Client disconnected - start advertising");
-  // restart_advertising=true;
-  NimBLEDevice::startAdvertising();
+  ESP_LOGI(detail::tag, "Client disconnected, reason %d", reason);
+  ++events_.disconnects;
 }
 
 void DescriptorCallbacks::onRead(NimBLEDescriptor* descriptor, NimBLEConnInfo& conn_info)
@@ -21,3 +20,34 @@ void DescriptorCallbacks::onRead(NimBLEDescriptor* descriptor, NimBLEConnInfo& c
   ESP_LOGI(detail::tag, "%s Descriptor read\n", descriptor->getUUID().toString().c_str());
 }
 } // namespace luz::ble::detail
+
+namespace luz::ble
+{
+void NimBLEAdvertiser::start(uint16_t interval) noexcept
+{
+  advertising_->setMinInterval(interval);
+  advertising_->setMaxInterval(interval);
+  advertising_->start();
+}
+
+void NimBLEAdvertiser::stop() noexcept { advertising_->stop(); }
+
+void Notifier::notify(std::span<const std::byte> bytes) noexcept
+{
+  if (characteristic_ == nullptr)
+  {
+    return;
+  }
+  characteristic_->notify(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+}
+
+void Notifier::update(std::span<const std::byte> bytes) noexcept
+{
+  if (characteristic_ == nullptr)
+  {
+    return;
+  }
+  characteristic_->setValue(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+  characteristic_->notify();
+}
+} // namespace luz::ble
@@ -5,24 +5,41 @@
 #include "NimBLEHIDDevice.h"
 #include "NimBLELocalValueAttribute.h"
 
+#include <atomic>
 #include <concepts>
+#include <cstdint>
 #include <memory>
 #include <span>
 #include <string_view>
 
 namespace luz::ble
 {
-template <std::regular_invocable<std::span<const std::byte>> OnWriteCallback>
+template <std::regular_invocable<std::span<const std::byte>> OnWriteCallback,
+          std::regular_invocable<std::span<const std::byte>> OnStreamWriteCallback,
+          std::regular_invocable<std::span<const std::byte>> OnLayoutWriteCallback>
 class DecoyPeripheral;
 
+/// Number of connections and disconnections, counted by the NimBLE host task
+struct ConnectionEvents
+{
+  std::atomic<uint32_t> connects{};
+  std::atomic<uint32_t> disconnects{};
+};
+
 namespace detail
 {
 constexpr auto tag = "BLE";
 
 class ServerCallbacks : public NimBLEServerCallbacks
 {
+public:
+  const ConnectionEvents& events() const noexcept { return events_; }
+
+private:
   void onConnect(NimBLEServer* pServer, NimBLEConnInfo& connInfo) override;
   void onDisconnect(NimBLEServer* pServer, NimBLEConnInfo& connInfo, int reason) override;
+
+  ConnectionEvents events_{};
 };
 
 template <std::regular_invocable<std::span<const std::byte>> OnWriteCallback>
@@ -51,11 +68,71 @@ class DescriptorCallbacks : public NimBLEDescriptorCallbacks
 };
 } // namespace detail
 
-template <std::regular_invocable<std::span<const std::byte>> OnWriteCallback> class DecoyPeripheral
+/// Advertiser driving the NimBLE advertisement, as scheduled by an AdvertisingScheduler
+class NimBLEAdvertiser
 {
 public:
-  template <std::regular_invocable<std::span<const std::byte>> _OnWriteCallback>
-  DecoyPeripheral(std::string_view name, _OnWriteCallback& on_write_callback) noexcept;
+  NimBLEAdvertiser() noexcept = default;
+  ~NimBLEAdvertiser() noexcept = default;
+
+  /// Copy/move constructor/assignment
+  NimBLEAdvertiser(const NimBLEAdvertiser&) = delete;
+  NimBLEAdvertiser& operator=(const NimBLEAdvertiser&) = delete;
+  NimBLEAdvertiser(NimBLEAdvertiser&&) = delete;
+  NimBLEAdvertiser& operator=(NimBLEAdvertiser&&) = delete;
+
+  void start(uint16_t interval) noexcept;
+  void stop() noexcept;
+
+private:
+  template <std::regular_invocable<std::span<const std::byte>> OnWriteCallback,
+            std::regular_invocable<std::span<const std::byte>> OnStreamWriteCallback,
+            std::regular_invocable<std::span<const std::byte>> OnLayoutWriteCallback>
+  friend class DecoyPeripheral;
+
+  NimBLEAdvertising* advertising_{};
+};
+
+/// Pushes records to subscribed clients through a NOTIFY characteristic. Notifications are
+/// silently dropped while the characteristic is disabled or no client has subscribed.
+class Notifier
+{
+public:
+  Notifier() noexcept = default;
+  ~Notifier() noexcept = default;
+
+  /// Copy/move constructor/assignment
+  Notifier(const Notifier&) = delete;
+  Notifier& operator=(const Notifier&) = delete;
+  Notifier(Notifier&&) = delete;
+  Notifier& operator=(Notifier&&) = delete;
+
+  void notify(std::span<const std::byte> bytes) noexcept;
+  /// Set the value read by clients, and notify subscribed clients of it
+  void update(std::span<const std::byte> bytes) noexcept;
+
+private:
+  template <std::regular_invocable<std::span<const std::byte>> OnWriteCallback,
+            std::regular_invocable<std::span<const std::byte>> OnStreamWriteCallback,
+            std::regular_invocable<std::span<const std::byte>> OnLayoutWriteCallback>
+  friend class DecoyPeripheral;
+
+  NimBLECharacteristic* characteristic_{};
+};
+
+template <std::regular_invocable<std::span<const std::byte>> OnWriteCallback,
+          std::regular_invocable<std::span<const std::byte>> OnStreamWriteCallback,
+          std::regular_invocable<std::span<const std::byte>> OnLayoutWriteCallback>
+class DecoyPeripheral
+{
+public:
+  template <std::regular_invocable<std::span<const std::byte>> _OnWriteCallback,
+            std::regular_invocable<std::span<const std::byte>> _OnStreamWriteCallback,
+            std::regular_invocable<std::span<const std::byte>> _OnLayoutWriteCallback>
+  DecoyPeripheral(std::string_view name,
+                  _OnWriteCallback& on_write_callback,
+                  _OnStreamWriteCallback& on_stream_write_callback,
+                  _OnLayoutWriteCallback& on_layout_write_callback) noexcept;
 
   ~DecoyPeripheral() noexcept = default;
 
@@ -65,24 +142,42 @@ public:
   DecoyPeripheral(DecoyPeripheral&&) = delete;
   DecoyPeripheral& operator=(DecoyPeripheral&&) = delete;
 
+  /// Notifier for the decode status characteristic, enabled with CONFIG_LUZ_STATUS_NOTIFY
+  Notifier& status_notifier() noexcept { return status_notifier_; }
+  /// Notifier for the replies to layout uploads, enabled with CONFIG_LUZ_LAYOUT_UPLOAD
+  Notifier& layout_notifier() noexcept { return layout_notifier_; }
+  /// Notifier for the credit granted to clients writing without response to the stream
+  /// characteristic
+  Notifier& credit_notifier() noexcept { return credit_notifier_; }
+
+  /// The advertisement is configured but not started; it is left to an AdvertisingScheduler
+  NimBLEAdvertiser& advertiser() noexcept { return advertiser_; }
+  const ConnectionEvents& connection_events() const noexcept { return server_callbacks_.events(); }
+
 private:
   NimBLEServer* server_{};
   NimBLEService* service_{};
   NimBLECharacteristic* characteristic_{};
+  NimBLECharacteristic* stream_characteristic_{};
   NimBLEDescriptor* descriptor_{};
-  NimBLEAdvertising* advertising_{};
+  NimBLEAdvertiser advertiser_{};
+  Notifier status_notifier_{};
+  Notifier layout_notifier_{};
+  Notifier credit_notifier_{};
 
   detail::ServerCallbacks server_callbacks_{};
   detail::CharacteristicCallbacks<OnWriteCallback> characteristic_callbacks_;
+  detail::CharacteristicCallbacks<OnStreamWriteCallback> stream_callbacks_;
+  detail::CharacteristicCallbacks<OnLayoutWriteCallback> layout_callbacks_;
   detail::DescriptorCallbacks descriptor_callbacks_{};
-
-  // TODO unused at the moment
-  bool restart_advertising_ = false;
 };
 
 /// Deduation guide
-template <std::regular_invocable<std::span<const std::byte>> OnWriteCallback>
-DecoyPeripheral(std::string_view, OnWriteCallback) -> DecoyPeripheral<OnWriteCallback>;
+template <std::regular_invocable<std::span<const std::byte>> OnWriteCallback,
+          std::regular_invocable<std::span<const std::byte>> OnStreamWriteCallback,
+          std::regular_invocable<std::span<const std::byte>> OnLayoutWriteCallback>
+DecoyPeripheral(std::string_view, OnWriteCallback, OnStreamWriteCallback, OnLayoutWriteCallback)
+    -> DecoyPeripheral<OnWriteCallback, OnStreamWriteCallback, OnLayoutWriteCallback>;
 } // namespace luz::ble
 
 #include "ble.inl"
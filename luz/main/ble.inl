@@ -1,9 +1,10 @@
 #pragma once
 
 #include "ble.hh"
+#include "packet_layout.hh"
 
 #include <array>
-#include <format>
+#include <cstdio>
 #include <span>
 #include <string_view>
 
@@ -11,14 +12,16 @@
 #define ADVERTISING_SERVICE_UUID "4488B571-7806-4DF6-BCFF-A2897E4953FF"
 #define DATA_TRANSFER_SERVICE_UUID "6E400001-B5A3-F393-E0A9-E50E24DCCA9E"
 #define DATA_TRANSFER_CHARACTERISTIC "6E400002-B5A3-F393-E0A9-E50E24DCCA9E"
+#define STATUS_CHARACTERISTIC "6E400010-B5A3-F393-E0A9-E50E24DCCA9E"
+#define LAYOUT_CHARACTERISTIC "6E400011-B5A3-F393-E0A9-E50E24DCCA9E"
+#define CREDIT_CHARACTERISTIC "6E400012-B5A3-F393-E0A9-E50E24DCCA9E"
+#define STREAM_CHARACTERISTIC "6E400013-B5A3-F393-E0A9-E50E24DCCA9E"
 #define DESCRIPTOR_UUID "00002902-0000-1000-8000-00805f9b34fb"
 
 namespace luz::ble
 {
 namespace detail
 {
-constexpr uint8_t api_level = 3U;
-
 template <std::regular_invocable<std::span<const std::byte>> OnWriteCallback>
 template <std::regular_invocable<std::span<const std::byte>> _OnWriteCallback>
 CharacteristicCallbacks<OnWriteCallback>::CharacteristicCallbacks(
@@ -32,33 +35,54 @@ template <std::regular_invocable<std::span<const std::byte>> OnWriteCallback>
 void CharacteristicCallbacks<OnWriteCallback>::onWrite(NimBLECharacteristic* characteristic,
                                                        NimBLEConnInfo& conn_info)
 {
+  // Take the value by reference; copying it would allocate for every write
+  const auto& value = characteristic->getValue();
+
+#if LOG_LOCAL_LEVEL >= ESP_LOG_DEBUG
   std::array<char, 256> print_buf{ '\0' };
-  ESP_LOGI(detail::tag, "%s : onWrite(), value:", characteristic->getUUID().toString().c_str());
+  ESP_LOGD(detail::tag, "%s : onWrite(), value:", characteristic->getUUID().toString().c_str());
 
-  // TODO get value has a templated overload that casts to target type -- maybe use to create
-  // std::byte span?
-  auto value = characteristic->getValue();
   constexpr std::string_view fmt_string = "0x%.2X, ";
   std::span<char> print_buf_view(print_buf);
   for (const uint8_t datum : value)
   {
+    if (print_buf_view.size() <= 6U)
+    {
+      break;
+    }
     snprintf(print_buf_view.data(), print_buf_view.size(), fmt_string.data(), datum);
     print_buf_view = print_buf_view.subspan(6U);
   }
-  ESP_LOGI(detail::tag, "\t%s", print_buf.data());
+  ESP_LOGD(detail::tag, "\t%s", print_buf.data());
+#endif
 
   std::invoke(*on_write_callback_, std::as_bytes(std::span{ value.data(), value.size() }));
 }
 } // namespace detail
 
-template <std::regular_invocable<std::span<const std::byte>> OnWriteCallback>
-template <std::regular_invocable<std::span<const std::byte>> _OnWriteCallback>
-DecoyPeripheral<OnWriteCallback>::DecoyPeripheral(std::string_view name,
-                                                  _OnWriteCallback& on_write_callback) noexcept
-    : characteristic_callbacks_{ on_write_callback }
+template <std::regular_invocable<std::span<const std::byte>> OnWriteCallback,
+          std::regular_invocable<std::span<const std::byte>> OnStreamWriteCallback,
+          std::regular_invocable<std::span<const std::byte>> OnLayoutWriteCallback>
+template <std::regular_invocable<std::span<const std::byte>> _OnWriteCallback,
+          std::regular_invocable<std::span<const std::byte>> _OnStreamWriteCallback,
+          std::regular_invocable<std::span<const std::byte>> _OnLayoutWriteCallback>
+DecoyPeripheral<OnWriteCallback, OnStreamWriteCallback, OnLayoutWriteCallback>::DecoyPeripheral(
+    std::string_view name,
+    _OnWriteCallback& on_write_callback,
+    _OnStreamWriteCallback& on_stream_write_callback,
+    _OnLayoutWriteCallback& on_layout_write_callback) noexcept
+    : characteristic_callbacks_{ on_write_callback },
+      stream_callbacks_{ on_stream_write_callback },
+      layout_callbacks_{ on_layout_write_callback }
 {
-  const auto board_name = std::format("{}@{}", name, detail::api_level);
-  NimBLEDevice::init(board_name);
+  std::array<char, 32> board_name{ '\0' };
+  snprintf(board_name.data(),
+           board_name.size(),
+           "%.*s@%u",
+           static_cast<int>(name.size()),
+           name.data(),
+           protocol::api_level);
+  NimBLEDevice::init(board_name.data());
 
   server_ = NimBLEDevice::createServer();
   server_->setCallbacks(&server_callbacks_);
@@ -68,21 +92,39 @@ DecoyPeripheral<OnWriteCallback>::DecoyPeripheral(std::string_view name,
   characteristic_
       = service_->createCharacteristic(DATA_TRANSFER_CHARACTERISTIC, NIMBLE_PROPERTY::WRITE);
   characteristic_->setCallbacks(&characteristic_callbacks_);
+  // Writes without response let the client send several fragments per connection event. They
+  // take a characteristic of their own since NimBLE does not tell the two kinds of write apart.
+  stream_characteristic_
+      = service_->createCharacteristic(STREAM_CHARACTERISTIC, NIMBLE_PROPERTY::WRITE_NR);
+  stream_characteristic_->setCallbacks(&stream_callbacks_);
+  credit_notifier_.characteristic_ = service_->createCharacteristic(
+      CREDIT_CHARACTERISTIC, NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY);
 
   descriptor_ = characteristic_->createDescriptor(DESCRIPTOR_UUID, NIMBLE_PROPERTY::READ);
   descriptor_->setCallbacks(&descriptor_callbacks_);
   descriptor_->setValue("Hold placements");
 
+#if CONFIG_LUZ_STATUS_NOTIFY
+  status_notifier_.characteristic_
+      = service_->createCharacteristic(STATUS_CHARACTERISTIC, NIMBLE_PROPERTY::NOTIFY);
+#endif
+
+#if CONFIG_LUZ_LAYOUT_UPLOAD
+  // Every chunk of a layout is acknowledged by a notification on the same characteristic
+  layout_notifier_.characteristic_ = service_->createCharacteristic(
+      LAYOUT_CHARACTERISTIC, NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::NOTIFY);
+  layout_notifier_.characteristic_->setCallbacks(&layout_callbacks_);
+#endif
+
   service_->start();
 
-  advertising_ = NimBLEDevice::getAdvertising();
-  advertising_->addServiceUUID(ADVERTISING_SERVICE_UUID);
-  advertising_->enableScanResponse(true);
-  advertising_->setName(board_name);
-  advertising_->setConnectableMode(2);
-  advertising_->setAdvertisingInterval(0x780);
-  NimBLEDevice::startAdvertising();
+  auto* advertising = NimBLEDevice::getAdvertising();
+  advertising->addServiceUUID(ADVERTISING_SERVICE_UUID);
+  advertising->enableScanResponse(true);
+  advertising->setName(board_name.data());
+  advertising->setConnectableMode(2);
+  advertiser_.advertising_ = advertising;
 
-  ESP_LOGI(detail::tag, "Advertising Decoy board with name: %s", board_name.c_str());
+  ESP_LOGI(detail::tag, "Created Decoy board with name: %s", board_name.data());
 }
 } // namespace luz::ble
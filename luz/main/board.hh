@@ -0,0 +1,109 @@
+#pragma once
+
+#include "database.hh"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+/// Spatial index of the Decoy board: maps between pixels, hold positions and grid coordinates.
+/// All tables are generated at compile time from the database, so every query is O(1).
+namespace luz::board
+{
+/// Location of a hold on the board grid, in units of half the hold spacing so that the holds of
+/// offset columns lie on the grid. The origin is the bottom left hold.
+struct GridPoint
+{
+  uint8_t x{};
+  uint8_t y{};
+
+  friend constexpr bool operator==(const GridPoint& lhs, const GridPoint& rhs) = default;
+};
+
+namespace detail
+{
+constexpr uint16_t holds_per_column_pair
+    = database::decoy::full_column_holds + database::decoy::offset_column_holds;
+constexpr uint16_t num_column_pairs
+    = (database::decoy::num_positions + holds_per_column_pair - 1U) / holds_per_column_pair;
+constexpr uint16_t no_position = UINT16_MAX;
+} // namespace detail
+
+/// Number of grid columns and rows spanned by the hold positions
+constexpr uint8_t num_columns = 2U * detail::num_column_pairs - 1U;
+constexpr uint8_t num_rows = 2U * database::decoy::full_column_holds - 1U;
+
+/// Grid location of a hold position
+/// @pre position < database::decoy::num_positions
+constexpr GridPoint position_to_grid(uint16_t position) noexcept
+{
+  const auto column_pair = static_cast<uint8_t>(position / detail::holds_per_column_pair);
+  const auto hold = static_cast<uint8_t>(position % detail::holds_per_column_pair);
+  if (hold < database::decoy::full_column_holds)
+  {
+    // Full columns run upwards...
+    return GridPoint{ static_cast<uint8_t>(2U * column_pair), static_cast<uint8_t>(2U * hold) };
+  }
+  // ... and offset columns back down
+  const auto from_top = static_cast<uint8_t>(hold - database::decoy::full_column_holds);
+  return GridPoint{ static_cast<uint8_t>(2U * column_pair + 1U),
+                    static_cast<uint8_t>(num_rows - 2U - 2U * from_top) };
+}
+
+/// Hold position at a grid location, if there is one
+constexpr std::optional<uint16_t> grid_to_position(GridPoint point) noexcept
+{
+  if (point.x >= num_columns || point.y >= num_rows || (point.x % 2U) != (point.y % 2U))
+  {
+    return std::nullopt;
+  }
+
+  const uint16_t column_pair = point.x / 2U;
+  const uint16_t hold = (point.x % 2U) == 0U
+                            ? point.y / 2U
+                            : database::decoy::full_column_holds + (num_rows - 2U - point.y) / 2U;
+  const uint16_t position = column_pair * detail::holds_per_column_pair + hold;
+  if (position >= database::decoy::num_positions)
+  {
+    return std::nullopt;
+  }
+  return position;
+}
+
+/// Tables generated from the position to pixel lookup of the database
+class Index
+{
+public:
+  static constexpr Index make() noexcept;
+
+  /// The hold position lit by pixel, if any
+  constexpr std::optional<uint16_t> pixel_to_position(uint16_t pixel) const noexcept;
+
+  /// Grid location of the hold lit by pixel, if any
+  constexpr std::optional<GridPoint> pixel_to_grid(uint16_t pixel) const noexcept;
+
+  /// The pixels in grid row y, ordered left to right
+  constexpr std::span<const uint16_t> row(uint8_t y) const noexcept;
+
+  /// The pixels in grid column x, ordered bottom to top
+  constexpr std::span<const uint16_t> column(uint8_t x) const noexcept;
+
+  /// Number of pixels which light a hold
+  constexpr uint16_t num_mapped_pixels() const noexcept { return row_offsets_.back(); }
+
+private:
+  constexpr Index() noexcept = default;
+
+  std::array<uint16_t, database::num_leds> positions_{};
+  std::array<GridPoint, database::num_leds> grid_{};
+  /// Pixels grouped by row; the pixels of row y are [row_offsets_[y], row_offsets_[y + 1])
+  std::array<uint16_t, num_rows + 1UL> row_offsets_{};
+  std::array<uint16_t, database::num_leds> row_pixels_{};
+  /// Pixels grouped by column, as for rows
+  std::array<uint16_t, num_columns + 1UL> column_offsets_{};
+  std::array<uint16_t, database::num_leds> column_pixels_{};
+};
+} // namespace luz::board
+
+#include "board.inl"
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "board.hh"
+
+namespace luz::board
+{
+constexpr Index Index::make() noexcept
+{
+  Index index{};
+  index.positions_.fill(detail::no_position);
+
+  // The Decoy board is the first chained to the controller, so its pixels start at pixel 0
+  for (uint16_t position = 0U; position < database::decoy::num_positions; ++position)
+  {
+    uint16_t pixel{};
+    if (!database::placement_to_pixel(position, pixel)
+        || index.positions_[pixel] != detail::no_position)
+    {
+      // Unmapped positions light nothing; where positions share a pixel the first is kept
+      continue;
+    }
+    index.positions_[pixel] = position;
+    index.grid_[pixel] = position_to_grid(position);
+  }
+
+  // The pixel lighting the hold at a grid location, if any
+  const auto pixel_at = [&index](uint8_t x, uint8_t y) -> std::optional<uint16_t> {
+    const auto position = grid_to_position(GridPoint{ x, y });
+    uint16_t pixel{};
+    if (!position || !database::placement_to_pixel(*position, pixel)
+        || index.positions_[pixel] != *position)
+    {
+      return std::nullopt;
+    }
+    return pixel;
+  };
+
+  // Walking the grid in order fills each row and column bucket already sorted
+  uint16_t num_pixels = 0U;
+  for (uint8_t y = 0U; y < num_rows; ++y)
+  {
+    for (uint8_t x = 0U; x < num_columns; ++x)
+    {
+      if (const auto pixel = pixel_at(x, y))
+      {
+        index.row_pixels_[num_pixels++] = *pixel;
+      }
+    }
+    index.row_offsets_[y + 1U] = num_pixels;
+  }
+
+  num_pixels = 0U;
+  for (uint8_t x = 0U; x < num_columns; ++x)
+  {
+    for (uint8_t y = 0U; y < num_rows; ++y)
+    {
+      if (const auto pixel = pixel_at(x, y))
+      {
+        index.column_pixels_[num_pixels++] = *pixel;
+      }
+    }
+    index.column_offsets_[x + 1U] = num_pixels;
+  }
+  return index;
+}
+
+constexpr std::optional<uint16_t> Index::pixel_to_position(uint16_t pixel) const noexcept
+{
+  if (pixel >= positions_.size() || positions_[pixel] == detail::no_position)
+  {
+    return std::nullopt;
+  }
+  return positions_[pixel];
+}
+
+constexpr std::optional<GridPoint> Index::pixel_to_grid(uint16_t pixel) const noexcept
+{
+  if (!pixel_to_position(pixel))
+  {
+    return std::nullopt;
+  }
+  return grid_[pixel];
+}
+
+constexpr std::span<const uint16_t> Index::row(uint8_t y) const noexcept
+{
+  if (y >= num_rows)
+  {
+    return {};
+  }
+  return std::span(row_pixels_).subspan(row_offsets_[y], row_offsets_[y + 1U] - row_offsets_[y]);
+}
+
+constexpr std::span<const uint16_t> Index::column(uint8_t x) const noexcept
+{
+  if (x >= num_columns)
+  {
+    return {};
+  }
+  return std::span(column_pixels_)
+      .subspan(column_offsets_[x], column_offsets_[x + 1U] - column_offsets_[x]);
+}
+
+/// The index of this board
+constexpr Index index = Index::make();
+} // namespace luz::board
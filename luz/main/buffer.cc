@@ -1,73 +1,61 @@
 #include "buffer.hh"
+#include "trace.hh"
 
+#include <algorithm>
 #include <cassert>
-#include <numeric>
-#include <utility>
 
 namespace luz::protocol
 {
 
-bool BufferList::empty() const noexcept { return buffers_.empty(); }
+bool BufferList::empty() const noexcept { return num_buffers_ == 0UL; }
 
-void BufferList::pop_front() noexcept { buffers_.pop_front(); }
-
-size_t BufferList::size() const noexcept
+void BufferList::pop_front() noexcept
 {
-  size_t size = 0;
-  for (const auto& buffer : buffers_)
-  {
-    size += buffer.size();
-  }
-  return size;
+  assert(!empty());
+  LUZ_TRACE_SCOPE(scope, "BufferList::pop_front");
+  LUZ_TRACE_ARG(scope, "bytes", sizes_[0]);
+
+  // Keep the remaining bytes contiguous at the start of the storage
+  const auto front_size = sizes_[0];
+  std::ranges::copy(std::span(bytes_).subspan(front_size, num_bytes_ - front_size),
+                    bytes_.begin());
+  std::ranges::copy(std::span(sizes_).subspan(1UL, num_buffers_ - 1UL), sizes_.begin());
+  num_bytes_ -= front_size;
+  --num_buffers_;
 }
 
+size_t BufferList::size() const noexcept { return num_bytes_; }
+
 std::span<const std::byte> BufferList::span_of(size_t start, size_t num) const noexcept
 {
   assert((start + num) <= size());
+  return std::span(bytes_).subspan(start, num);
+}
 
-  for (const auto& buffer : buffers_)
-  {
-    if (start < buffer.size())
-    {
-      assert((start + num) <= buffer.size());
-      return std::span(buffer.begin() + start, num);
-    }
-
-    start -= buffer.size();
-  }
-
-  printf("span of unreachable");
-  return {};
-  std::unreachable();
+void BufferList::clear() noexcept
+{
+  num_buffers_ = 0UL;
+  num_bytes_ = 0UL;
 }
 
-std::vector<std::span<const std::byte>> BufferList::spans_of(size_t start,
-                                                             size_t num) const noexcept
+bool BufferList::push_back(std::span<const std::byte> bytes) noexcept
 {
-  assert((start + num) <= size());
-  auto spans = std::vector<std::span<const std::byte>>{};
-  for (const auto& buffer : buffers_)
+  LUZ_TRACE_SCOPE(scope, "BufferList::push_back");
+  LUZ_TRACE_ARG(scope, "bytes", bytes.size());
+  if (bytes.size() > capacity_bytes)
   {
-    if (start >= buffer.size())
-    {
-      start -= buffer.size();
-      continue;
-    }
+    clear();
+    return false;
+  }
 
-    auto consume = std::min(buffer.size() - start, num);
-    spans.push_back(std::span(buffer.cbegin() + start, consume));
-    num -= consume;
-    start = 0;
-    if (num == 0)
-    {
-      return spans;
-    }
+  while (num_buffers_ == max_buffers || (num_bytes_ + bytes.size()) > capacity_bytes)
+  {
+    pop_front();
   }
 
-  printf("spans of unreachable");
-  return {};
-  // std::unreachable();
+  std::ranges::copy(bytes, bytes_.begin() + num_bytes_);
+  sizes_[num_buffers_++] = bytes.size();
+  num_bytes_ += bytes.size();
+  return true;
 }
-
-void BufferList::clear() noexcept { buffers_.clear(); }
 } // namespace luz::protocol
@@ -1,17 +1,21 @@
 #pragma once
 
 #include <array>
-#include <iterator>
-#include <list>
-#include <memory_resource>
+#include <cstddef>
 #include <span>
-#include <vector>
 
 namespace luz::protocol
 {
+/// An ordered list of received buffers, stored contiguously in fixed capacity storage so that no
+/// allocations are made once constructed
 class BufferList
 {
 public:
+  /// Total number of bytes which may be held across all buffers
+  static constexpr size_t capacity_bytes = 1024UL;
+  /// Maximum number of buffers which may be held
+  static constexpr size_t max_buffers = 32UL;
+
   BufferList() noexcept = default;
   ~BufferList() noexcept = default;
 
@@ -23,27 +27,23 @@ public:
 
   /// Get a span from [start, start + num)
   /// @pre start + num does not exceed the size
-  /// @pre the requested number of elements does not cross an internal buffer boundary
-  /// This is guaranteed by the protocol as BLE packets are only split at Placement boundaries
-  // TODO add templated version
-  // template <size_t N>
-  // std::span<const std::byte, N> span_of(size_t start) const noexcept;
   std::span<const std::byte> span_of(size_t start, size_t num) const noexcept;
 
-  /// Get a span of spans with sum total 'num' bytes where the returned number of spans is dictated
-  /// by the number of internal buffer boundaries crossed
-  std::vector<std::span<const std::byte>> spans_of(size_t start, size_t num) const noexcept;
-
   bool empty() const noexcept;
   void pop_front() noexcept;
   size_t size() const noexcept;
   void clear() noexcept;
 
-  template <class... Args> std::vector<std::byte>& emplace_back(Args&&... args);
+  /// Append a copy of the bytes as a new buffer, evicting the oldest buffers if there is
+  /// insufficient capacity
+  /// @return False if the bytes can never fit, in which case the list is left empty
+  bool push_back(std::span<const std::byte> bytes) noexcept;
 
 private:
-  std::list<std::vector<std::byte>> buffers_{};
+  std::array<std::byte, capacity_bytes> bytes_{};
+  /// Size of each buffer, in order of arrival
+  std::array<size_t, max_buffers> sizes_{};
+  size_t num_buffers_{};
+  size_t num_bytes_{};
 };
 } // namespace luz::protocol
-
-#include "buffer.inl"
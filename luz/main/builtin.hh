@@ -0,0 +1,74 @@
+#pragma once
+
+#include "database.hh"
+#include "decoder.hh"
+#include "render.hh"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+/// Climbs built into the firmware, decoded from raw Aurora byte streams into ready-to-show frames
+/// entirely at compile time
+namespace luz::builtin
+{
+namespace detail
+{
+/// Deliberately not constexpr: reaching a call during constant evaluation fails the build
+void malformed_climb() noexcept;
+} // namespace detail
+
+/// Concatenate the fragments of a climb, e.g. as written by the app, into a single byte stream
+template <size_t... Ns>
+consteval std::array<std::byte, (Ns + ...)> concat(const std::array<std::byte, Ns>&... fragments)
+{
+  std::array<std::byte, (Ns + ...)> bytes{};
+  auto out = bytes.begin();
+  ((out = std::ranges::copy(fragments, out).out), ...);
+  return bytes;
+}
+
+/// Decode a complete Aurora packet and map its placements to a frame.
+/// A malformed packet or a placement without a pixel on this board is a compile-time error.
+template <size_t N>
+consteval render::IndexedFrame make_frame(const std::array<std::byte, N>& bytes)
+{
+  Packet::Header header{};
+  std::vector<Placement> placements{};
+  if (protocol::decode(bytes, header, placements) != protocol::ProtocolStatus::success
+      || protocol::packet_size(header) != N)
+  {
+    detail::malformed_climb();
+  }
+
+  render::IndexedFrame frame{};
+  for (const auto& placement : placements)
+  {
+    uint16_t pixel{};
+    if (!database::placement_to_pixel(placement.position, pixel))
+    {
+      detail::malformed_climb();
+    }
+    frame[pixel] = render::palette_index(placement.color);
+  }
+  return frame;
+}
+
+/// Every hold along the top row, lit at boot as a self-test of the LED strip and wiring
+constexpr auto self_test = make_frame(concat(
+    std::array{ std::byte{ 1 },   std::byte{ 52 },  std::byte{ 32 },  std::byte{ 2 },
+                std::byte{ 84 },  std::byte{ 17 },  std::byte{ 0 },   std::byte{ 224 },
+                std::byte{ 52 },  std::byte{ 0 },   std::byte{ 224 }, std::byte{ 87 },
+                std::byte{ 0 },   std::byte{ 227 }, std::byte{ 122 }, std::byte{ 0 },
+                std::byte{ 227 }, std::byte{ 157 }, std::byte{ 0 },   std::byte{ 227 } },
+    std::array{ std::byte{ 192 }, std::byte{ 0 },   std::byte{ 227 }, std::byte{ 227 },
+                std::byte{ 0 },   std::byte{ 227 }, std::byte{ 6 },   std::byte{ 1 },
+                std::byte{ 227 }, std::byte{ 41 },  std::byte{ 1 },   std::byte{ 227 },
+                std::byte{ 76 },  std::byte{ 1 },   std::byte{ 28 },  std::byte{ 111 },
+                std::byte{ 1 },   std::byte{ 3 },   std::byte{ 146 }, std::byte{ 1 } },
+    std::array{ std::byte{ 3 },   std::byte{ 181 }, std::byte{ 1 },  std::byte{ 3 },
+                std::byte{ 216 }, std::byte{ 1 },   std::byte{ 3 },  std::byte{ 251 },
+                std::byte{ 1 },   std::byte{ 227 }, std::byte{ 30 }, std::byte{ 2 },
+                std::byte{ 227 }, std::byte{ 65 },  std::byte{ 2 },  std::byte{ 227 },
+                std::byte{ 3 } }));
+} // namespace luz::builtin
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace luz::database
+{
+/// A single board, e.g. a main board or a kickboard, whose LED strip is chained to the controller
+struct SubBoard
+{
+  /// Pixel of the board lighting each of its positions, counted from the first position and first
+  /// pixel of the board; -1 where no pixel lights the position
+  std::span<const int16_t> lookup{};
+  /// Number of LEDs on the board's strip
+  uint16_t num_leds{};
+  /// The first position of the board in the position space of the Aurora app
+  uint16_t first_position{};
+};
+
+/// Number of LEDs on the strips of every board, chained in the order the boards are listed
+template <size_t NumBoards>
+constexpr uint16_t total_leds(const std::array<SubBoard, NumBoards>& boards) noexcept;
+
+/// Number of positions spanned by the boards, from position 0 to the last position of any board
+template <size_t NumBoards>
+constexpr uint16_t position_space(const std::array<SubBoard, NumBoards>& boards) noexcept;
+
+/// Whether no position belongs to more than one board
+template <size_t NumBoards>
+constexpr bool disjoint(const std::array<SubBoard, NumBoards>& boards) noexcept;
+
+/// Whether every pixel of each board lies on its strip, i.e. below its number of LEDs
+template <size_t NumBoards>
+constexpr bool within_strips(const std::array<SubBoard, NumBoards>& boards) noexcept;
+
+/// Several boards driven as one: their strips form one contiguous pixel space, in which each board
+/// starts after the pixels of the boards before it. The tables of the boards are flattened at
+/// compile time into a single lookup, so mapping a placement never depends on its board.
+template <uint16_t NumPositions, uint16_t NumLeds> class CompositeLayout
+{
+public:
+  /// @pre The boards are disjoint, lie within their strips and span NumPositions positions and
+  /// NumLeds LEDs
+  template <size_t NumBoards>
+  static constexpr CompositeLayout make(const std::array<SubBoard, NumBoards>& boards) noexcept;
+
+  /// Translate a placement position into the index of its pixel across every board
+  constexpr bool placement_to_pixel(uint16_t position, uint16_t& pixel) const noexcept;
+
+private:
+  constexpr CompositeLayout() noexcept = default;
+
+  std::array<int16_t, NumPositions> lookup_{};
+};
+} // namespace luz::database
+
+#include "composite.inl"
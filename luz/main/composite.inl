@@ -0,0 +1,109 @@
+#pragma once
+
+#include "composite.hh"
+
+namespace luz::database
+{
+template <size_t NumBoards>
+constexpr uint16_t total_leds(const std::array<SubBoard, NumBoards>& boards) noexcept
+{
+  uint16_t num_leds = 0U;
+  for (const auto& board : boards)
+  {
+    num_leds += board.num_leds;
+  }
+  return num_leds;
+}
+
+template <size_t NumBoards>
+constexpr uint16_t position_space(const std::array<SubBoard, NumBoards>& boards) noexcept
+{
+  uint16_t num_positions = 0U;
+  for (const auto& board : boards)
+  {
+    const auto end = static_cast<uint16_t>(board.first_position + board.lookup.size());
+    num_positions = end > num_positions ? end : num_positions;
+  }
+  return num_positions;
+}
+
+template <size_t NumBoards>
+constexpr bool disjoint(const std::array<SubBoard, NumBoards>& boards) noexcept
+{
+  for (size_t i = 0UL; i < NumBoards; ++i)
+  {
+    for (size_t j = i + 1UL; j < NumBoards; ++j)
+    {
+      const auto& a = boards[i];
+      const auto& b = boards[j];
+      if (a.first_position < b.first_position + b.lookup.size()
+          && b.first_position < a.first_position + a.lookup.size())
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <size_t NumBoards>
+constexpr bool within_strips(const std::array<SubBoard, NumBoards>& boards) noexcept
+{
+  for (const auto& board : boards)
+  {
+    for (const auto pixel : board.lookup)
+    {
+      if (pixel >= board.num_leds)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <uint16_t NumPositions, uint16_t NumLeds>
+template <size_t NumBoards>
+constexpr CompositeLayout<NumPositions, NumLeds>
+CompositeLayout<NumPositions, NumLeds>::make(
+    const std::array<SubBoard, NumBoards>& boards) noexcept
+{
+  CompositeLayout layout{};
+  layout.lookup_.fill(-1);
+
+  int16_t first_pixel = 0;
+  for (const auto& board : boards)
+  {
+    for (size_t position = 0UL; position < board.lookup.size(); ++position)
+    {
+      if (const auto pixel = board.lookup[position]; pixel >= 0)
+      {
+        layout.lookup_[board.first_position + position]
+            = static_cast<int16_t>(first_pixel + pixel);
+      }
+    }
+    first_pixel = static_cast<int16_t>(first_pixel + board.num_leds);
+  }
+  return layout;
+}
+
+template <uint16_t NumPositions, uint16_t NumLeds>
+constexpr bool
+CompositeLayout<NumPositions, NumLeds>::placement_to_pixel(uint16_t position,
+                                                           uint16_t& pixel) const noexcept
+{
+  if (position >= lookup_.size())
+  {
+    return false;
+  }
+
+  const int16_t pxl = lookup_[position];
+  if (pxl < 0)
+  {
+    return false;
+  }
+
+  pixel = static_cast<uint16_t>(pxl);
+  return true;
+}
+} // namespace luz::database
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace luz
+{
+namespace detail
+{
+constexpr std::array<uint32_t, 256> make_crc_table() noexcept
+{
+  std::array<uint32_t, 256> table{};
+  for (uint32_t index = 0U; index < table.size(); ++index)
+  {
+    uint32_t crc = index;
+    for (int bit = 0; bit < 8; ++bit)
+    {
+      crc = (crc & 1U) != 0U ? (crc >> 1U) ^ 0xEDB88320U : crc >> 1U;
+    }
+    table[index] = crc;
+  }
+  return table;
+}
+
+constexpr auto crc_table = make_crc_table();
+} // namespace detail
+
+/// CRC-32 as used by zlib and Ethernet; continue a CRC across chunks by passing the previous
+constexpr uint32_t crc32(std::span<const std::byte> bytes, uint32_t crc = 0U) noexcept
+{
+  crc = ~crc;
+  for (const auto byte : bytes)
+  {
+    crc = detail::crc_table[(crc ^ static_cast<uint32_t>(byte)) & 0xFFU] ^ (crc >> 8U);
+  }
+  return ~crc;
+}
+} // namespace luz
@@ -1,14 +1,28 @@
 #pragma once
 
+#include "composite.hh"
+#include "decoy.hh"
+
+#include <array>
 #include <cstdint>
 
 namespace luz::database
 {
-/// Number of LEDs
-constexpr uint16_t num_leds = 461U;
-/// Number of hold positions on the 12x12 decoy board
-constexpr uint16_t num_positions = 578U;
+/// The boards driven by this controller, in the order in which their LED strips are chained.
+/// Further boards, e.g. a kickboard, are appended along with the first position of their holds.
+constexpr auto boards = std::array{
+  SubBoard{ .lookup = decoy::lookup, .num_leds = decoy::num_leds, .first_position = 0U },
+};
+static_assert(disjoint(boards), "Every position must belong to a single board");
+static_assert(within_strips(boards), "Every pixel must lie on the strip of its board");
+
+/// Number of LEDs across every board
+constexpr uint16_t num_leds = total_leds(boards);
+/// Number of hold positions across every board
+constexpr uint16_t num_positions = position_space(boards);
 
 /// Translate the placement position into the idx of the pixel array
-bool placement_to_pixel(uint16_t position, uint16_t& pixel) noexcept;
+constexpr bool placement_to_pixel(uint16_t position, uint16_t& pixel) noexcept;
 } // namespace luz::database
+
+#include "database.inl"
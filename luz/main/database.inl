@@ -0,0 +1,17 @@
+#pragma once
+
+#include "database.hh"
+
+namespace luz::database
+{
+namespace detail
+{
+/// The lookup tables of every board flattened into one
+constexpr auto layout = CompositeLayout<num_positions, num_leds>::make(boards);
+} // namespace detail
+
+constexpr bool placement_to_pixel(uint16_t position, uint16_t& pixel) noexcept
+{
+  return detail::layout.placement_to_pixel(position, pixel);
+}
+} // namespace luz::database
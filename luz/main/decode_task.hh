@@ -0,0 +1,149 @@
+#pragma once
+
+#include "receive.hh"
+#include "stats.hh"
+#include "trace.hh"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace luz::receive
+{
+/// Transport over which encoded credit records are published to the client
+template <typename T>
+concept CreditSink = requires(T& sink, std::span<const std::byte> bytes) { sink.update(bytes); };
+
+/// Function object invoked by the NimBLE host task for each write with response to the
+/// DecoyPeripheral characteristic. Writes are queued for a task of their own which passes them on
+/// to on_write, so the BLE stack accepts the next write without waiting for the last to be decoded.
+/// Writes without response, paced by the credit reported, are passed through without_response().
+template <size_t Depth,
+          std::invocable<std::span<const std::byte>> OnWrite,
+          CreditSink Sink,
+          uint32_t StackSize = 4096U>
+class DecodeTask
+{
+public:
+  DecodeTask(Stats& stats, OnWrite& on_write, UBaseType_t priority) noexcept
+      : stats_{ stats },
+        on_write_{ on_write },
+        handle_{ xTaskCreateStatic(
+            &DecodeTask::run, "decode", StackSize, this, priority, stack_.data(), &task_) }
+  {
+  }
+  ~DecodeTask() noexcept { vTaskDelete(handle_); }
+
+  /// Copy/move constructor/assignment
+  DecodeTask(const DecodeTask&) = delete;
+  DecodeTask& operator=(const DecodeTask&) = delete;
+  DecodeTask(DecodeTask&&) = delete;
+  DecodeTask& operator=(DecodeTask&&) = delete;
+
+  /// Report the credit granted to the client through sink, starting with the whole queue
+  void report_credit_to(Sink& sink) noexcept
+  {
+    report(sink, queue_.credit());
+    credit_sink_ = &sink;
+  }
+
+  /// Call operator invoked each time the DecoyPeripheral characteristic is written to with
+  /// response. The write is never dropped: while the queue is full, the NimBLE host task waits
+  /// for the decode task to free a slot, which holds back the response to the client.
+  /// @param bytes The payload written by the client; dropped and counted in the stats only if
+  /// larger than a slot
+  void operator()(std::span<const std::byte> bytes) noexcept
+  {
+    LUZ_TRACE_SCOPE(scope, "DecodeTask::push");
+    while (queue_.full())
+    {
+      producer_.store(xTaskGetCurrentTaskHandle());
+      xTaskNotifyGive(handle_);
+      // Bounded, should the slot be freed before the decode task sees the producer waiting
+      (void)ulTaskNotifyTake(pdTRUE, 1U);
+      producer_.store(nullptr);
+    }
+    push(bytes);
+  }
+
+  /// Function object invoked by the NimBLE host task for each write without response
+  class WithoutResponse
+  {
+  public:
+    explicit WithoutResponse(DecodeTask& task) noexcept : task_{ task } {}
+
+    /// @param bytes The payload written by the client; dropped and counted in the stats if the
+    /// queue is full, the client having exceeded its credit
+    void operator()(std::span<const std::byte> bytes) noexcept
+    {
+      LUZ_TRACE_SCOPE(scope, "DecodeTask::push");
+      task_.push(bytes);
+    }
+
+  private:
+    DecodeTask& task_;
+  };
+
+  WithoutResponse& without_response() noexcept { return without_response_; }
+
+private:
+  void push(std::span<const std::byte> bytes) noexcept
+  {
+    if (!queue_.try_push(bytes))
+    {
+      stats_.receive_overruns = queue_.overruns();
+    }
+    xTaskNotifyGive(handle_);
+  }
+
+  static void run(void* self) noexcept { static_cast<DecodeTask*>(self)->drain(); }
+
+  [[noreturn]] void drain() noexcept
+  {
+    while (true)
+    {
+      (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      for (auto bytes = queue_.front(); bytes; bytes = queue_.front())
+      {
+        on_write_(*bytes);
+        queue_.pop();
+        if (auto* producer = producer_.exchange(nullptr); producer != nullptr)
+        {
+          xTaskNotifyGive(producer);
+        }
+        if (auto* sink = credit_sink_.load(); sink != nullptr)
+        {
+          if (const auto credit = queue_.poll_credit())
+          {
+            report(*sink, *credit);
+          }
+        }
+      }
+    }
+  }
+
+  static void report(Sink& sink, const Credit& credit) noexcept
+  {
+    std::array<std::byte, CreditLayout::size> bytes{};
+    CreditLayout::encode(credit, bytes);
+    sink.update(bytes);
+  }
+
+  Stats& stats_;
+  OnWrite& on_write_;
+  ReceiveQueue<Depth> queue_{};
+  std::atomic<Sink*> credit_sink_{};
+  /// The NimBLE host task, while it waits for a slot to queue a write with response
+  std::atomic<TaskHandle_t> producer_{};
+  WithoutResponse without_response_{ *this };
+  StaticTask_t task_{};
+  std::array<StackType_t, StackSize> stack_{};
+  TaskHandle_t handle_;
+};
+} // namespace luz::receive
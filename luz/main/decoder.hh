@@ -0,0 +1,110 @@
+#pragma once
+
+#include "packet.hh"
+#include "packet_layout.hh"
+#include "trace.hh"
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace luz::protocol
+{
+enum class ProtocolStatus
+{
+  success = 0,
+  incomplete,
+  insufficient_header_bytes,
+  bad_header,
+  bad_payload,
+  bad_footer,
+  bad_checksum,
+};
+
+/// A container to which decoded placements are appended, e.g. std::vector or std::pmr::vector
+template <typename T>
+concept PlacementContainer = requires(T& placements, size_t capacity) {
+  { placements.emplace_back() } -> std::same_as<Placement&>;
+  placements.reserve(capacity);
+  placements.clear();
+};
+
+namespace detail
+{
+/// The payload size is a single byte which includes the index marker, so a packet can never hold
+/// more placements than this
+static constexpr size_t max_placements_per_packet = (UINT8_MAX - 1UL) / Layouts::Placement::size;
+
+constexpr uint8_t checksum(std::span<const std::byte> bytes, IndexMarker index_marker) noexcept;
+
+struct HeaderDecoder
+{
+  static constexpr auto size_bytes = Layouts::Header::size;
+
+  static constexpr bool make(std::span<const std::byte> bytes, Packet::Header& header) noexcept;
+};
+
+struct FooterDecoder
+{
+  static constexpr auto size_bytes = Layouts::Footer::size;
+
+  static constexpr bool make(std::span<const std::byte> bytes, Packet::Footer& footer) noexcept;
+};
+
+struct PlacementDecoder
+{
+  static constexpr auto size_bytes = Layouts::Placement::size;
+
+  template <PlacementContainer Placements>
+  static constexpr bool try_iter_make(std::span<const std::byte> bytes,
+                                      Placements& placements) noexcept;
+  static constexpr void make(std::span<const std::byte, size_bytes> bytes,
+                             Placement& placement) noexcept;
+};
+
+struct PacketDecoder
+{
+  static constexpr size_t fixed_elem_size = HeaderDecoder::size_bytes + FooterDecoder::size_bytes;
+
+  template <PlacementContainer Placements>
+  static constexpr ProtocolStatus try_make(std::span<const std::byte> bytes,
+                                           Packet::Header& header,
+                                           Packet::Footer& footer,
+                                           Placements& placements) noexcept;
+};
+} // namespace detail
+
+/// Number of bytes occupied on the wire by the packet with the given header
+constexpr size_t packet_size(const Packet::Header& header) noexcept
+{
+  return detail::PacketDecoder::fixed_elem_size + header.payload_size;
+}
+
+/// Decode a single packet from the front of a buffer.
+/// The decoder holds no state so is reentrant, and is usable in constant evaluation when given a
+/// constexpr container such as std::vector.
+/// @param bytes The buffer, which may extend beyond the end of the packet
+/// @param[out] header The decoded header
+/// @param[out] placements Replaced by the decoded placements
+/// @return success, or the reason decoding failed; incomplete and insufficient_header_bytes
+/// indicate that the buffer ends before the packet does
+template <PlacementContainer Placements>
+constexpr ProtocolStatus decode(std::span<const std::byte> bytes,
+                                Packet::Header& header,
+                                Placements& placements) noexcept;
+
+/// Decode the placements received so far of a packet whose remaining bytes have yet to arrive.
+/// Only the header is validated, so the placements are provisional until decode() succeeds.
+/// @param[out] placements Replaced by the complete placements received so far
+/// @return incomplete if the packet is still arriving, otherwise as decode()
+template <PlacementContainer Placements>
+constexpr ProtocolStatus decode_provisional(std::span<const std::byte> bytes,
+                                            Packet::Header& header,
+                                            Placements& placements) noexcept;
+
+/// Decode a single packet from the front of a buffer into packet
+ProtocolStatus decode(std::span<const std::byte> bytes, Packet& packet) noexcept;
+} // namespace luz::protocol
+
+#include "decoder.inl"
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "decoder.hh"
+
+#include <algorithm>
+#include <numeric>
+
+namespace luz::protocol
+{
+namespace detail
+{
+constexpr uint8_t checksum(std::span<const std::byte> bytes, IndexMarker index_marker) noexcept
+{
+  uint8_t accumulated = static_cast<std::underlying_type_t<IndexMarker>>(index_marker);
+  accumulated = std::accumulate(
+      bytes.begin(), bytes.end(), accumulated, [](uint8_t chksm, const std::byte val) {
+        return (chksm + std::to_integer<uint8_t>(val)) & 0xFF;
+      });
+  return 0xFF & ~accumulated;
+}
+
+constexpr bool HeaderDecoder::make(std::span<const std::byte> bytes,
+                                   Packet::Header& header) noexcept
+{
+  return Layouts::Header::decode(bytes, header);
+}
+
+constexpr bool FooterDecoder::make(std::span<const std::byte> bytes,
+                                   Packet::Footer& footer) noexcept
+{
+  return Layouts::Footer::decode(bytes, footer);
+}
+
+constexpr void PlacementDecoder::make(std::span<const std::byte, size_bytes> bytes,
+                                      Placement& placement) noexcept
+{
+  // Placements have no constant fields, so decoding cannot fail
+  (void)Layouts::Placement::decode(bytes, placement);
+}
+
+template <PlacementContainer Placements>
+constexpr bool PlacementDecoder::try_iter_make(std::span<const std::byte> bytes,
+                                               Placements& placements) noexcept
+{
+  LUZ_TRACE_SCOPE(scope, "PlacementDecoder::try_iter_make");
+  LUZ_TRACE_ARG(scope, "placements", bytes.size() / size_bytes);
+  for (; bytes.size() >= size_bytes; bytes = bytes.subspan(size_bytes))
+  {
+    PlacementDecoder::make(bytes.first<size_bytes>(), placements.emplace_back());
+  }
+  return bytes.empty();
+}
+
+template <PlacementContainer Placements>
+constexpr ProtocolStatus PacketDecoder::try_make(std::span<const std::byte> bytes,
+                                                 Packet::Header& header,
+                                                 Packet::Footer& footer,
+                                                 Placements& placements) noexcept
+{
+  if (bytes.size() < HeaderDecoder::size_bytes)
+  {
+    return ProtocolStatus::insufficient_header_bytes;
+  }
+
+  auto offset = size_t{ 0UL };
+  if (!HeaderDecoder::make(bytes.subspan(offset, HeaderDecoder::size_bytes), header))
+  {
+    return ProtocolStatus::bad_header;
+  }
+
+  if (bytes.size() < (fixed_elem_size + header.payload_size))
+  {
+    return ProtocolStatus::incomplete;
+  }
+
+  offset += HeaderDecoder::size_bytes;
+  auto payload_span = bytes.subspan(offset, header.payload_size);
+  if (auto chksm = checksum(payload_span, header.index_marker); chksm != header.checksum)
+  {
+    return ProtocolStatus::bad_checksum;
+  }
+
+  offset += header.payload_size;
+  if (!FooterDecoder::make(bytes.subspan(offset, FooterDecoder::size_bytes), footer))
+  {
+    return ProtocolStatus::bad_footer;
+  }
+
+  placements.clear();
+  placements.reserve(max_placements_per_packet);
+  if (!PlacementDecoder::try_iter_make(payload_span, placements))
+  {
+    return ProtocolStatus::bad_payload;
+  }
+
+  return ProtocolStatus::success;
+}
+} // namespace detail
+
+template <PlacementContainer Placements>
+constexpr ProtocolStatus decode(std::span<const std::byte> bytes,
+                                Packet::Header& header,
+                                Placements& placements) noexcept
+{
+  LUZ_TRACE_SCOPE(scope, "protocol::decode");
+  Packet::Footer footer{};
+  const auto status = detail::PacketDecoder::try_make(bytes, header, footer, placements);
+  LUZ_TRACE_ARG(scope, "status", status);
+  return status;
+}
+
+template <PlacementContainer Placements>
+constexpr ProtocolStatus decode_provisional(std::span<const std::byte> bytes,
+                                            Packet::Header& header,
+                                            Placements& placements) noexcept
+{
+  if (const auto status = decode(bytes, header, placements); status != ProtocolStatus::incomplete)
+  {
+    return status;
+  }
+
+  // A placement split across writes is left for the next fragment
+  const auto payload = bytes.subspan(detail::HeaderDecoder::size_bytes);
+  placements.clear();
+  placements.reserve(detail::max_placements_per_packet);
+  (void)detail::PlacementDecoder::try_iter_make(
+      payload.first(std::min<size_t>(payload.size(), header.payload_size)), placements);
+  return ProtocolStatus::incomplete;
+}
+} // namespace luz::protocol
@@ -1,15 +1,28 @@
-#include "database.hh"
+#pragma once
+
 #include <array>
+#include <cstdint>
 
-namespace luz::database
-{
-namespace
+/// The 12x12 Decoy board
+namespace luz::database::decoy
 {
-/// A lookup table mapping the hold position on the 12x12 decoy board to the pixel index.
+/// Number of LEDs
+constexpr uint16_t num_leds = 461U;
+/// Number of hold positions
+constexpr uint16_t num_positions = 578U;
+
+/// Hold positions snake up and down the columns of the board starting from the bottom left (see
+/// the lookup table). Full columns alternate with offset columns, which are set halfway between
+/// the full columns and between their rows.
+constexpr uint16_t full_column_holds = 18U;
+constexpr uint16_t offset_column_holds = 17U;
+
+/// A lookup table mapping the hold position to the pixel index.
 /// Decoy holds are indexed in a snaking pattern starting from the bottom left, e.g.:
 /// [ 2 3 8 ]
 /// [ 1 4 7 ]
 /// [ 0 5 6 ]
+/// Positions without a pixel map to -1.
 constexpr std::array<int16_t, num_positions> lookup{
   0,   3,   -1,  7,   10,  11,  14,  15,  18,  21,  -1,  -1,  27,  30,  33,  34,  37,  38,  -1,
   -1,  -1,  -1,  29,  26,  -1,  23,  20,  17,  -1,  -1,  -1,  8,   -1,  4,   -1,  1,   2,   5,
@@ -43,22 +56,4 @@ constexpr std::array<int16_t, num_positions> lookup{
   449, 447, -1,  -1,  -1,  442, -1,  439, -1,  437, 438, -1,  441, 443, 444, 445, 446, 448, 450,
   -1,  -1,  454, 456, 456, 458, 459, 460
 };
-} // anonymous namespace
-
-bool placement_to_pixel(uint16_t position, uint16_t& pixel) noexcept
-{
-  if (position >= lookup.size())
-  {
-    return false;
-  }
-
-  int16_t pxl = lookup.at(position);
-  if (pxl < 0)
-  {
-    return false;
-  }
-
-  pixel = pxl;
-  return true;
-}
-} // namespace luz::database
+} // namespace luz::database::decoy
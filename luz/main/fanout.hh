@@ -0,0 +1,291 @@
+#pragma once
+
+#include "database.hh"
+#include "layout.hh"
+#include "palette.hh"
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+/// Several identical boards are driven by one client through a chain of UARTs: the primary, the
+/// board the client is connected to, sends each climb it shows down the chain, and every
+/// secondary latches it and passes the bytes it receives on to the next board as they arrive.
+///
+/// Each frame travels as a packet
+///
+///   Header  sequence number, kind (commit, provisional or rollback), encoding, count
+///   Body    dense:  count palette indices, one per pixel
+///           sparse: count pixel updates (pixel, palette index) to a blank frame
+///           delta:  count pixel updates to the frame of the previous sequence number
+///   CRC     CRC-32 of the header and body
+///
+/// whichever encoding is the smallest. The packet is COBS encoded and ended by a zero byte, so a
+/// secondary which joins mid-packet or drops a byte resynchronises at the next packet. A delta is
+/// only applied on top of the previous sequence number; a secondary which missed a packet waits
+/// for the next keyframe (dense or sparse), which the primary sends at least once per keyframe
+/// interval by repeating the current frame under the same sequence number.
+namespace luz::fanout
+{
+/// Ends every packet on the line; COBS removes it from the packet itself
+constexpr std::byte delimiter{ 0 };
+
+/// What a secondary does with a frame, as the primary did
+enum class FrameKind : uint8_t
+{
+  /// Show the frame, crossfading from the current climb
+  commit = 0,
+  /// Show a partially received climb at once
+  provisional,
+  /// Return to the climb committed before the provisional frame; the frame is that climb
+  rollback,
+};
+
+enum class Encoding : uint8_t
+{
+  dense = 0,
+  sparse,
+  delta,
+};
+
+struct FrameHeader
+{
+  uint16_t sequence{};
+  FrameKind kind{};
+  Encoding encoding{};
+  /// Number of palette indices or pixel updates in the body
+  uint16_t count{};
+
+  friend constexpr bool operator==(const FrameHeader& lhs, const FrameHeader& rhs) = default;
+};
+
+/// A pixel set to a palette index, in the body of sparse and delta frames
+struct PixelUpdate
+{
+  uint16_t pixel{};
+  render::PaletteIndex index{};
+};
+
+namespace codec
+{
+struct FrameKind
+{
+  static constexpr fanout::FrameKind decode(uint8_t raw) noexcept
+  {
+    return static_cast<fanout::FrameKind>(raw);
+  }
+  static constexpr uint8_t encode(fanout::FrameKind value) noexcept
+  {
+    return static_cast<uint8_t>(value);
+  }
+  static constexpr bool valid(uint8_t raw) noexcept
+  {
+    return raw <= static_cast<uint8_t>(fanout::FrameKind::rollback);
+  }
+};
+
+struct Encoding
+{
+  static constexpr fanout::Encoding decode(uint8_t raw) noexcept
+  {
+    return static_cast<fanout::Encoding>(raw);
+  }
+  static constexpr uint8_t encode(fanout::Encoding value) noexcept
+  {
+    return static_cast<uint8_t>(value);
+  }
+  static constexpr bool valid(uint8_t raw) noexcept
+  {
+    return raw <= static_cast<uint8_t>(fanout::Encoding::delta);
+  }
+};
+} // namespace codec
+
+using FrameHeaderLayout
+    = layout::Layout<FrameHeader,
+                     layout::Bind<&FrameHeader::sequence>,
+                     layout::Bind<&FrameHeader::kind, uint8_t, codec::FrameKind>,
+                     layout::Bind<&FrameHeader::encoding, uint8_t, codec::Encoding>,
+                     layout::Bind<&FrameHeader::count>>;
+
+using PixelUpdateLayout = layout::Layout<PixelUpdate,
+                                         layout::Bind<&PixelUpdate::pixel>,
+                                         layout::Bind<&PixelUpdate::index>>;
+
+constexpr size_t crc_size = sizeof(uint32_t);
+
+/// Size of a packet holding a dense body, the largest needed for any frame
+constexpr size_t max_packet_size = FrameHeaderLayout::size + database::num_leds + crc_size;
+
+/// Size on the line of a packet of size bytes once COBS encoded, with its delimiter
+constexpr size_t line_size(size_t size) noexcept { return size + (size / 254UL) + 2UL; }
+
+/// Time taken to send size bytes at baud, with a start and a stop bit per byte
+constexpr uint32_t airtime_us(size_t size, uint32_t baud) noexcept
+{
+  return static_cast<uint32_t>((static_cast<uint64_t>(size) * 10U * 1'000'000U) / baud);
+}
+
+/// COBS encode bytes and append the delimiter
+/// @pre line holds at least line_size(bytes.size()) bytes
+/// @return The size of the encoded packet in line
+constexpr size_t cobs_encode(std::span<const std::byte> bytes, std::span<std::byte> line) noexcept;
+
+/// Decode a COBS encoded packet, without its delimiter, in place
+/// @return The size of the packet at the start of bytes, or nothing if bytes is not valid COBS
+constexpr std::optional<size_t> cobs_decode(std::span<std::byte> bytes) noexcept;
+
+/// Encode frame as a packet, as a delta from previous if given and smaller than a keyframe
+/// @return The size of the packet in packet
+constexpr size_t encode_frame(uint16_t sequence,
+                              FrameKind kind,
+                              const render::IndexedFrame& frame,
+                              const render::IndexedFrame* previous,
+                              std::span<std::byte, max_packet_size> packet) noexcept;
+
+/// One end of the serial line: a secondary reads from the board before it and writes to the one
+/// after it, while the primary only writes
+template <typename T>
+concept Port = requires(T& port,
+                        std::span<const std::byte> out,
+                        std::span<std::byte> in,
+                        uint32_t timeout_ms) {
+  /// Queue bytes for transmission without waiting for them to be sent; false if they were not
+  { port.write(out) } -> std::same_as<bool>;
+  /// Wait up to timeout_ms for bytes to arrive, and return as many as have
+  { port.read(in, timeout_ms) } -> std::same_as<size_t>;
+};
+
+/// Sends every frame shown by the primary down the chain
+template <Port P> class Primary
+{
+public:
+  /// @param keyframe_interval_ms Most time between keyframes
+  Primary(P& port, uint32_t keyframe_interval_ms) noexcept
+      : port_{ port }, keyframe_interval_ms_{ keyframe_interval_ms }
+  {
+  }
+  ~Primary() noexcept = default;
+
+  /// Copy/move constructor/assignment
+  Primary(const Primary&) = delete;
+  Primary& operator=(const Primary&) = delete;
+  Primary(Primary&&) = delete;
+  Primary& operator=(Primary&&) = delete;
+
+  /// Send frame under the next sequence number
+  /// @return false if the port dropped it
+  bool send(FrameKind kind, const render::IndexedFrame& frame, uint32_t now_ms) noexcept;
+
+  /// Repeat the current frame as a keyframe if none has been sent for the keyframe interval, so
+  /// a secondary which missed a packet or joined the chain late catches up
+  /// @return false if the port dropped it
+  bool update(uint32_t now_ms) noexcept;
+
+  uint16_t sequence() const noexcept { return sequence_; }
+  /// Number of packets the port dropped
+  uint32_t dropped() const noexcept { return dropped_; }
+
+private:
+  /// COBS encode and write the first size bytes of packet_
+  bool transmit(size_t size, uint32_t now_ms) noexcept;
+
+  P& port_;
+  uint32_t keyframe_interval_ms_;
+  /// The frame last sent, and whether the secondaries have it to apply a delta to
+  render::IndexedFrame frame_{};
+  bool delta_base_ = false;
+  /// The kind under which frame_ is repeated, once any frame has been sent
+  FrameKind kind_ = FrameKind::commit;
+  bool sent_ = false;
+  uint16_t sequence_{};
+  uint32_t last_keyframe_ms_{};
+  uint32_t dropped_{};
+  std::array<std::byte, max_packet_size> packet_{};
+  std::array<std::byte, line_size(max_packet_size)> line_{};
+};
+
+/// Collects the bytes read from the line into packets
+class PacketReader
+{
+public:
+  constexpr PacketReader() noexcept = default;
+
+  /// Add a byte read from the line
+  /// @return The decoded packet once its delimiter is read, valid until the next byte is pushed;
+  /// nothing while it is incomplete, or if it is too long or not valid COBS
+  constexpr std::optional<std::span<const std::byte>> push(std::byte byte) noexcept;
+
+  /// Number of packets discarded as too long or not valid COBS
+  constexpr uint32_t discarded() const noexcept { return discarded_; }
+
+private:
+  std::array<std::byte, line_size(max_packet_size)> bytes_{};
+  size_t size_{};
+  /// Whether the packet being read has overflowed, and is skipped until the next delimiter
+  bool overflow_ = false;
+  uint32_t discarded_{};
+};
+
+/// The frame of a secondary, updated by the packets of the primary
+class Latch
+{
+public:
+  constexpr Latch() noexcept = default;
+
+  /// Apply a packet to the frame
+  /// @return The kind of the frame if it has changed; nothing if the packet is corrupt, repeats
+  /// the current frame, or is a delta which does not follow it
+  constexpr std::optional<FrameKind> apply(std::span<const std::byte> packet) noexcept;
+
+  constexpr const render::IndexedFrame& frame() const noexcept { return frame_; }
+  constexpr uint16_t sequence() const noexcept { return sequence_; }
+  /// Whether a keyframe has been applied, and every delta since
+  constexpr bool synced() const noexcept { return synced_; }
+
+  /// Number of packets with a bad CRC or header
+  constexpr uint32_t corrupt() const noexcept { return corrupt_; }
+  /// Number of deltas skipped because a packet was missed; each is made up by the next keyframe
+  constexpr uint32_t skipped() const noexcept { return skipped_; }
+
+private:
+  render::IndexedFrame frame_{};
+  uint16_t sequence_{};
+  bool synced_ = false;
+  uint32_t corrupt_{};
+  uint32_t skipped_{};
+};
+
+/// Latches the frames sent down the chain, passing them on to the next board
+template <Port P> class Secondary
+{
+public:
+  explicit Secondary(P& port) noexcept : port_{ port } {}
+  ~Secondary() noexcept = default;
+
+  /// Copy/move constructor/assignment
+  Secondary(const Secondary&) = delete;
+  Secondary& operator=(const Secondary&) = delete;
+  Secondary(Secondary&&) = delete;
+  Secondary& operator=(Secondary&&) = delete;
+
+  /// Wait up to timeout_ms for bytes from the line and forward them at once, then call on_frame
+  /// with each frame they complete
+  template <std::invocable<FrameKind, const render::IndexedFrame&> OnFrame>
+  void poll(uint32_t timeout_ms, OnFrame&& on_frame) noexcept;
+
+  const Latch& latch() const noexcept { return latch_; }
+  const PacketReader& reader() const noexcept { return reader_; }
+
+private:
+  P& port_;
+  PacketReader reader_{};
+  Latch latch_{};
+  std::array<std::byte, 256> buffer_{};
+};
+} // namespace luz::fanout
+
+#include "fanout.inl"
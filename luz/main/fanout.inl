@@ -0,0 +1,328 @@
+#pragma once
+
+#include "crc.hh"
+#include "fanout.hh"
+
+#include <algorithm>
+
+namespace luz::fanout
+{
+namespace detail
+{
+/// The palette index of an unlit pixel, of which a sparse body lists none
+constexpr render::PaletteIndex blank = render::palette_index(Color{});
+
+constexpr size_t packet_size(size_t body_size) noexcept
+{
+  return FrameHeaderLayout::size + body_size + crc_size;
+}
+
+constexpr uint16_t count_updates(const render::IndexedFrame& frame,
+                                 const render::IndexedFrame& base) noexcept
+{
+  uint16_t count = 0U;
+  for (size_t pxl = 0UL; pxl < frame.size(); ++pxl)
+  {
+    count += frame[pxl] != base[pxl] ? 1U : 0U;
+  }
+  return count;
+}
+
+/// Blank frame to which a sparse body is applied
+constexpr auto blank_frame = [] {
+  render::IndexedFrame frame{};
+  frame.fill(blank);
+  return frame;
+}();
+
+constexpr void append_crc(std::span<std::byte> packet, size_t size) noexcept
+{
+  const auto crc = crc32(packet.first(size));
+  for (size_t byte = 0UL; byte < crc_size; ++byte)
+  {
+    packet[size + byte] = static_cast<std::byte>(crc >> (8UL * byte));
+  }
+}
+
+constexpr uint32_t read_crc(std::span<const std::byte> bytes) noexcept
+{
+  uint32_t crc = 0U;
+  for (size_t byte = 0UL; byte < crc_size; ++byte)
+  {
+    crc |= std::to_integer<uint32_t>(bytes[byte]) << (8UL * byte);
+  }
+  return crc;
+}
+} // namespace detail
+
+constexpr size_t cobs_encode(std::span<const std::byte> bytes, std::span<std::byte> line) noexcept
+{
+  // Each block starts with the offset of the next zero, or 0xFF for 254 bytes without one
+  size_t code_at = 0UL;
+  size_t size = 1UL;
+  uint8_t code = 1U;
+  for (const auto byte : bytes)
+  {
+    if (byte != delimiter)
+    {
+      line[size++] = byte;
+      ++code;
+    }
+    if (byte == delimiter || code == 0xFFU)
+    {
+      line[code_at] = static_cast<std::byte>(code);
+      code_at = size++;
+      code = 1U;
+    }
+  }
+  line[code_at] = static_cast<std::byte>(code);
+  line[size++] = delimiter;
+  return size;
+}
+
+constexpr std::optional<size_t> cobs_decode(std::span<std::byte> bytes) noexcept
+{
+  size_t size = 0UL;
+  for (size_t read = 0UL; read < bytes.size();)
+  {
+    const auto code = std::to_integer<size_t>(bytes[read++]);
+    if (code == 0UL || read + code - 1UL > bytes.size())
+    {
+      return std::nullopt;
+    }
+    for (size_t index = 1UL; index < code; ++index)
+    {
+      bytes[size++] = bytes[read++];
+    }
+    // A block shorter than the longest stands for a zero, unless it ends the packet
+    if (code < 0xFFUL && read < bytes.size())
+    {
+      bytes[size++] = delimiter;
+    }
+  }
+  return size;
+}
+
+constexpr size_t encode_frame(uint16_t sequence,
+                              FrameKind kind,
+                              const render::IndexedFrame& frame,
+                              const render::IndexedFrame* previous,
+                              std::span<std::byte, max_packet_size> packet) noexcept
+{
+  auto header = FrameHeader{ .sequence = sequence,
+                             .kind = kind,
+                             .encoding = Encoding::dense,
+                             .count = static_cast<uint16_t>(frame.size()) };
+  const auto* base = &detail::blank_frame;
+  if (const auto count = detail::count_updates(frame, detail::blank_frame);
+      count * PixelUpdateLayout::size < frame.size())
+  {
+    header.encoding = Encoding::sparse;
+    header.count = count;
+  }
+  if (previous != nullptr)
+  {
+    const auto count = detail::count_updates(frame, *previous);
+    if (count * PixelUpdateLayout::size
+        < (header.encoding == Encoding::dense ? frame.size()
+                                              : header.count * PixelUpdateLayout::size))
+    {
+      header.encoding = Encoding::delta;
+      header.count = count;
+      base = previous;
+    }
+  }
+
+  FrameHeaderLayout::encode(header, packet);
+  size_t size = FrameHeaderLayout::size;
+  if (header.encoding == Encoding::dense)
+  {
+    for (const auto index : frame)
+    {
+      packet[size++] = static_cast<std::byte>(index);
+    }
+  }
+  else
+  {
+    for (size_t pxl = 0UL; pxl < frame.size(); ++pxl)
+    {
+      if (frame[pxl] != (*base)[pxl])
+      {
+        const auto update
+            = PixelUpdate{ .pixel = static_cast<uint16_t>(pxl), .index = frame[pxl] };
+        PixelUpdateLayout::encode(update, packet.subspan(size, PixelUpdateLayout::size));
+        size += PixelUpdateLayout::size;
+      }
+    }
+  }
+  detail::append_crc(packet, size);
+  return size + crc_size;
+}
+
+template <Port P>
+bool Primary<P>::send(FrameKind kind, const render::IndexedFrame& frame, uint32_t now_ms) noexcept
+{
+  const auto size
+      = encode_frame(++sequence_, kind, frame, delta_base_ ? &frame_ : nullptr, packet_);
+  frame_ = frame;
+  // Once repeated, a rollback is the commit of the frame rolled back to
+  kind_ = kind == FrameKind::rollback ? FrameKind::commit : kind;
+  sent_ = true;
+  return transmit(size, now_ms);
+}
+
+template <Port P> bool Primary<P>::update(uint32_t now_ms) noexcept
+{
+  if (!sent_ || now_ms - last_keyframe_ms_ < keyframe_interval_ms_)
+  {
+    return true;
+  }
+  return transmit(encode_frame(sequence_, kind_, frame_, nullptr, packet_), now_ms);
+}
+
+template <Port P> bool Primary<P>::transmit(size_t size, uint32_t now_ms) noexcept
+{
+  const auto line = std::span{ line_ }.first(cobs_encode(std::span{ packet_ }.first(size), line_));
+  FrameHeader header{};
+  (void)FrameHeaderLayout::decode(packet_, header);
+  if (!port_.write(line))
+  {
+    // The secondaries may have missed the frame, so the next cannot be a delta from it
+    ++dropped_;
+    delta_base_ = false;
+    return false;
+  }
+  delta_base_ = true;
+  if (header.encoding != Encoding::delta)
+  {
+    last_keyframe_ms_ = now_ms;
+  }
+  return true;
+}
+
+constexpr std::optional<std::span<const std::byte>> PacketReader::push(std::byte byte) noexcept
+{
+  if (byte != delimiter)
+  {
+    if (size_ == bytes_.size())
+    {
+      overflow_ = true;
+    }
+    else
+    {
+      bytes_[size_++] = byte;
+    }
+    return std::nullopt;
+  }
+
+  const auto line = std::span{ bytes_ }.first(size_);
+  const bool overflow = overflow_;
+  size_ = 0UL;
+  overflow_ = false;
+  if (line.empty())
+  {
+    return std::nullopt;
+  }
+  const auto size = overflow ? std::nullopt : cobs_decode(line);
+  if (!size)
+  {
+    ++discarded_;
+    return std::nullopt;
+  }
+  return std::span<const std::byte>{ line.first(*size) };
+}
+
+constexpr std::optional<FrameKind> Latch::apply(std::span<const std::byte> packet) noexcept
+{
+  FrameHeader header{};
+  if (packet.size() < detail::packet_size(0UL)
+      || detail::read_crc(packet.last(crc_size))
+             != crc32(packet.first(packet.size() - crc_size))
+      || !FrameHeaderLayout::decode(packet, header))
+  {
+    ++corrupt_;
+    return std::nullopt;
+  }
+
+  const auto body = packet.subspan(FrameHeaderLayout::size,
+                                   packet.size() - FrameHeaderLayout::size - crc_size);
+  const bool dense = header.encoding == Encoding::dense;
+  if (body.size() != (dense ? frame_.size() : header.count * PixelUpdateLayout::size)
+      || (dense && header.count != frame_.size()))
+  {
+    ++corrupt_;
+    return std::nullopt;
+  }
+  for (size_t offset = 0UL; !dense && offset < body.size(); offset += PixelUpdateLayout::size)
+  {
+    PixelUpdate update{};
+    if (!PixelUpdateLayout::decode(body.subspan(offset), update) || update.pixel >= frame_.size())
+    {
+      ++corrupt_;
+      return std::nullopt;
+    }
+  }
+
+  if (header.encoding == Encoding::delta)
+  {
+    if (!synced_ || header.sequence != static_cast<uint16_t>(sequence_ + 1U))
+    {
+      ++skipped_;
+      synced_ = false;
+      return std::nullopt;
+    }
+  }
+  else if (synced_ && header.sequence == sequence_)
+  {
+    // A repeat of the frame already shown
+    return std::nullopt;
+  }
+
+  if (dense)
+  {
+    std::ranges::transform(body, frame_.begin(), [](std::byte byte) {
+      return std::to_integer<render::PaletteIndex>(byte);
+    });
+  }
+  else
+  {
+    if (header.encoding == Encoding::sparse)
+    {
+      frame_ = detail::blank_frame;
+    }
+    for (size_t offset = 0UL; offset < body.size(); offset += PixelUpdateLayout::size)
+    {
+      PixelUpdate update{};
+      (void)PixelUpdateLayout::decode(body.subspan(offset), update);
+      frame_[update.pixel] = update.index;
+    }
+  }
+  sequence_ = header.sequence;
+  synced_ = true;
+  return header.kind;
+}
+
+template <Port P>
+template <std::invocable<FrameKind, const render::IndexedFrame&> OnFrame>
+void Secondary<P>::poll(uint32_t timeout_ms, OnFrame&& on_frame) noexcept
+{
+  const auto size = port_.read(buffer_, timeout_ms);
+  if (size == 0UL)
+  {
+    return;
+  }
+  // Forwarding before decoding holds the next board back by no more than the bytes in hand
+  const auto bytes = std::span{ buffer_ }.first(size);
+  (void)port_.write(bytes);
+  for (const auto byte : bytes)
+  {
+    if (const auto packet = reader_.push(byte))
+    {
+      if (const auto kind = latch_.apply(*packet))
+      {
+        on_frame(*kind, latch_.frame());
+      }
+    }
+  }
+}
+} // namespace luz::fanout
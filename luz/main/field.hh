@@ -12,7 +12,10 @@ template <typename T> struct Field
   static constexpr size_t size = sizeof(T);
 
   template <size_t size_bytes>
-  T value(std::span<const std::byte, size_bytes> bytes) const noexcept;
+  constexpr T value(std::span<const std::byte, size_bytes> bytes) const noexcept;
+
+  template <size_t size_bytes>
+  constexpr void write(std::span<std::byte, size_bytes> bytes, T val) const noexcept;
 };
 
 template <typename T, typename U> constexpr Field<T> offset_from(Field<U> field);
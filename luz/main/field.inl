@@ -1,17 +1,30 @@
 #pragma once
 #include "field.hh"
-#include <cstring>
+
+#include <algorithm>
+#include <array>
+#include <bit>
 
 namespace luz
 {
+// BLE and ESP32 are both little endian, so fields are copied as-is
+static_assert(std::endian::native == std::endian::little);
+
+template <typename T>
+template <size_t size_bytes>
+constexpr T Field<T>::value(std::span<const std::byte, size_bytes> bytes) const noexcept
+{
+  std::array<std::byte, size> raw{};
+  std::ranges::copy(bytes.subspan(offset, size), raw.begin());
+  return std::bit_cast<T>(raw);
+}
+
 template <typename T>
 template <size_t size_bytes>
-T Field<T>::value(std::span<const std::byte, size_bytes> bytes) const noexcept
+constexpr void Field<T>::write(std::span<std::byte, size_bytes> bytes, T val) const noexcept
 {
-  T val;
-  // BLE and ESP32 are both little endian
-  std::memcpy(&val, bytes.subspan(offset, size).data(), size);
-  return val;
+  std::ranges::copy(std::bit_cast<std::array<std::byte, size>>(val),
+                    bytes.subspan(offset, size).begin());
 }
 
 template <typename T, typename U> constexpr Field<T> offset_from(Field<U> field)
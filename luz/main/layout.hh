@@ -0,0 +1,138 @@
+#pragma once
+
+#include "field.hh"
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <span>
+
+/// Declarative, compile-time descriptions of fixed-size wire records.
+/// A Layout lists the elements of a record in wire order; decoders and encoders for the record
+/// are generated from the one description, so the two can never disagree. Offsets are derived
+/// from the element sizes and all accessors are constexpr.
+namespace luz::layout
+{
+namespace detail
+{
+template <auto Member> struct member_traits;
+
+template <typename R, typename M, M R::*Member> struct member_traits<Member>
+{
+  using record_type = R;
+  using member_type = M;
+};
+
+template <auto Member> using member_type_t = typename member_traits<Member>::member_type;
+} // namespace detail
+
+/// Conversion between the raw value of a field and the record member it is bound to
+template <typename C, typename Raw, typename Value>
+concept Codec = requires(Raw raw, Value value) {
+  { C::decode(raw) } -> std::convertible_to<Value>;
+  { C::encode(value) } -> std::convertible_to<Raw>;
+  { C::valid(raw) } -> std::same_as<bool>;
+};
+
+/// The member holds the raw value unchanged
+struct Identity
+{
+  template <typename T> static constexpr T decode(T raw) noexcept { return raw; }
+  template <typename T> static constexpr T encode(T value) noexcept { return value; }
+  template <typename T> static constexpr bool valid(T) noexcept { return true; }
+};
+
+/// The member holds the raw value multiplied by Factor
+template <unsigned Factor> struct Scale
+{
+  template <typename T> static constexpr T decode(T raw) noexcept { return raw * Factor; }
+  template <typename T> static constexpr T encode(T value) noexcept { return value / Factor; }
+  template <typename T> static constexpr bool valid(T) noexcept { return true; }
+};
+
+/// A field holding a value fixed by the protocol; decoding fails if the value differs
+template <typename T, T Expected> struct Constant
+{
+  static constexpr size_t size = sizeof(T);
+
+  template <typename Record>
+  static constexpr bool
+  decode(std::span<const std::byte> bytes, size_t offset, Record& record) noexcept;
+  template <typename Record>
+  static constexpr void
+  encode(const Record& record, std::span<std::byte> bytes, size_t offset) noexcept;
+};
+
+/// A field of type Raw bound to the record member Member through the codec C
+template <auto Member, typename Raw = detail::member_type_t<Member>, typename C = Identity>
+  requires Codec<C, Raw, detail::member_type_t<Member>>
+struct Bind
+{
+  static constexpr size_t size = sizeof(Raw);
+
+  template <typename Record>
+  static constexpr bool
+  decode(std::span<const std::byte> bytes, size_t offset, Record& record) noexcept;
+  template <typename Record>
+  static constexpr void
+  encode(const Record& record, std::span<std::byte> bytes, size_t offset) noexcept;
+};
+
+/// A record member which is itself a record described by the Layout L
+template <auto Member, typename L> struct Nested
+{
+  static constexpr size_t size = L::size;
+
+  template <typename Record>
+  static constexpr bool
+  decode(std::span<const std::byte> bytes, size_t offset, Record& record) noexcept;
+  template <typename Record>
+  static constexpr void
+  encode(const Record& record, std::span<std::byte> bytes, size_t offset) noexcept;
+};
+
+/// Width bits of a Packed field bound to the record member Member through the codec C
+template <auto Member, size_t Width, typename C = Identity> struct Bits
+{
+  static constexpr size_t width = Width;
+};
+
+/// Bit-fields packed into a single T; the first is allocated the most significant bits
+template <typename T, typename... Fields> struct Packed
+{
+  static constexpr size_t size = sizeof(T);
+  static_assert((Fields::width + ...) <= (sizeof(T) * 8UL), "Bit-fields exceed their storage");
+
+  template <typename Record>
+  static constexpr bool
+  decode(std::span<const std::byte> bytes, size_t offset, Record& record) noexcept;
+  template <typename Record>
+  static constexpr void
+  encode(const Record& record, std::span<std::byte> bytes, size_t offset) noexcept;
+
+private:
+  static constexpr std::array<size_t, sizeof...(Fields)> make_shifts() noexcept;
+};
+
+/// The wire layout of Record as a sequence of elements
+template <typename Record, typename... Elements> struct Layout
+{
+  using record_type = Record;
+  static constexpr size_t size = (Elements::size + ... + 0UL);
+
+  /// Decode every element of the record from the front of bytes
+  /// @pre bytes holds at least size bytes
+  /// @return Whether every element held a valid value; all elements are decoded regardless
+  static constexpr bool decode(std::span<const std::byte> bytes, Record& record) noexcept;
+
+  /// Encode every element of the record to the front of bytes
+  /// @pre bytes holds at least size bytes
+  static constexpr void encode(const Record& record, std::span<std::byte> bytes) noexcept;
+
+private:
+  static constexpr std::array<size_t, sizeof...(Elements)> make_offsets() noexcept;
+  static constexpr auto offsets = make_offsets();
+};
+} // namespace luz::layout
+
+#include "layout.inl"
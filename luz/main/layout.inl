@@ -0,0 +1,157 @@
+#pragma once
+
+#include "layout.hh"
+
+#include <utility>
+
+namespace luz::layout
+{
+template <typename T, T Expected>
+template <typename Record>
+constexpr bool Constant<T, Expected>::decode(std::span<const std::byte> bytes,
+                                             size_t offset,
+                                             Record&) noexcept
+{
+  return Field<T>{ offset }.value(bytes) == Expected;
+}
+
+template <typename T, T Expected>
+template <typename Record>
+constexpr void Constant<T, Expected>::encode(const Record&,
+                                             std::span<std::byte> bytes,
+                                             size_t offset) noexcept
+{
+  Field<T>{ offset }.write(bytes, Expected);
+}
+
+template <auto Member, typename Raw, typename C>
+  requires Codec<C, Raw, detail::member_type_t<Member>>
+template <typename Record>
+constexpr bool Bind<Member, Raw, C>::decode(std::span<const std::byte> bytes,
+                                            size_t offset,
+                                            Record& record) noexcept
+{
+  const auto raw = Field<Raw>{ offset }.value(bytes);
+  record.*Member = static_cast<detail::member_type_t<Member>>(C::decode(raw));
+  return C::valid(raw);
+}
+
+template <auto Member, typename Raw, typename C>
+  requires Codec<C, Raw, detail::member_type_t<Member>>
+template <typename Record>
+constexpr void Bind<Member, Raw, C>::encode(const Record& record,
+                                            std::span<std::byte> bytes,
+                                            size_t offset) noexcept
+{
+  Field<Raw>{ offset }.write(bytes, static_cast<Raw>(C::encode(record.*Member)));
+}
+
+template <auto Member, typename L>
+template <typename Record>
+constexpr bool Nested<Member, L>::decode(std::span<const std::byte> bytes,
+                                         size_t offset,
+                                         Record& record) noexcept
+{
+  return L::decode(bytes.subspan(offset, L::size), record.*Member);
+}
+
+template <auto Member, typename L>
+template <typename Record>
+constexpr void Nested<Member, L>::encode(const Record& record,
+                                         std::span<std::byte> bytes,
+                                         size_t offset) noexcept
+{
+  L::encode(record.*Member, bytes.subspan(offset, L::size));
+}
+
+template <typename T, typename... Fields>
+constexpr std::array<size_t, sizeof...(Fields)> Packed<T, Fields...>::make_shifts() noexcept
+{
+  constexpr std::array<size_t, sizeof...(Fields)> widths{ Fields::width... };
+  std::array<size_t, sizeof...(Fields)> shifts{};
+  size_t shift = sizeof(T) * 8UL;
+  for (size_t i = 0UL; i < widths.size(); ++i)
+  {
+    shift -= widths[i];
+    shifts[i] = shift;
+  }
+  return shifts;
+}
+
+template <typename T, typename... Fields>
+template <typename Record>
+constexpr bool Packed<T, Fields...>::decode(std::span<const std::byte> bytes,
+                                            size_t offset,
+                                            Record& record) noexcept
+{
+  constexpr auto shifts = make_shifts();
+  const auto raw = Field<T>{ offset }.value(bytes);
+  return [&]<size_t... Is>(std::index_sequence<Is...>) {
+    bool valid = true;
+    (
+        [&]<auto Member, size_t Width, typename C>(Bits<Member, Width, C>) {
+          constexpr auto mask = static_cast<T>((T{ 1 } << Width) - 1U);
+          const auto bits = static_cast<T>((raw >> shifts[Is]) & mask);
+          record.*Member = static_cast<detail::member_type_t<Member>>(C::decode(bits));
+          valid &= C::valid(bits);
+        }(Fields{}),
+        ...);
+    return valid;
+  }(std::index_sequence_for<Fields...>{});
+}
+
+template <typename T, typename... Fields>
+template <typename Record>
+constexpr void Packed<T, Fields...>::encode(const Record& record,
+                                            std::span<std::byte> bytes,
+                                            size_t offset) noexcept
+{
+  constexpr auto shifts = make_shifts();
+  T raw{};
+  [&]<size_t... Is>(std::index_sequence<Is...>) {
+    (
+        [&]<auto Member, size_t Width, typename C>(Bits<Member, Width, C>) {
+          constexpr auto mask = static_cast<T>((T{ 1 } << Width) - 1U);
+          raw |= static_cast<T>((static_cast<T>(C::encode(record.*Member)) & mask) << shifts[Is]);
+        }(Fields{}),
+        ...);
+  }(std::index_sequence_for<Fields...>{});
+  Field<T>{ offset }.write(bytes, raw);
+}
+
+template <typename Record, typename... Elements>
+constexpr std::array<size_t, sizeof...(Elements)>
+Layout<Record, Elements...>::make_offsets() noexcept
+{
+  constexpr std::array<size_t, sizeof...(Elements)> sizes{ Elements::size... };
+  std::array<size_t, sizeof...(Elements)> offsets{};
+  size_t offset = 0UL;
+  for (size_t i = 0UL; i < sizes.size(); ++i)
+  {
+    offsets[i] = offset;
+    offset += sizes[i];
+  }
+  return offsets;
+}
+
+template <typename Record, typename... Elements>
+constexpr bool Layout<Record, Elements...>::decode(std::span<const std::byte> bytes,
+                                                   Record& record) noexcept
+{
+  return [&]<size_t... Is>(std::index_sequence<Is...>) {
+    // Every element is decoded and validity is accumulated without branching
+    bool valid = true;
+    ((valid &= Elements::decode(bytes, offsets[Is], record)), ...);
+    return valid;
+  }(std::index_sequence_for<Elements...>{});
+}
+
+template <typename Record, typename... Elements>
+constexpr void Layout<Record, Elements...>::encode(const Record& record,
+                                                   std::span<std::byte> bytes) noexcept
+{
+  [&]<size_t... Is>(std::index_sequence<Is...>) {
+    (Elements::encode(record, bytes, offsets[Is]), ...);
+  }(std::index_sequence_for<Elements...>{});
+}
+} // namespace luz::layout
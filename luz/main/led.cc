@@ -1,4 +1,5 @@
 #include "led.hh"
+#include "trace.hh"
 
 #include "esp_err.h"
 #include "esp_heap_caps.h"
@@ -54,7 +55,11 @@ void ESP32LED::set_pixel(uint32_t idx, Color color) noexcept
   ESP_ERROR_CHECK(led_strip_set_pixel(led_strip_, idx, color.g, color.r, color.b));
 }
 
-void ESP32LED::submit() noexcept { ESP_ERROR_CHECK(led_strip_refresh(led_strip_)); }
+void ESP32LED::submit() noexcept
+{
+  LUZ_TRACE_SCOPE(scope, "ESP32LED::submit");
+  ESP_ERROR_CHECK(led_strip_refresh(led_strip_));
+}
 
 void ESP32LED::clear() noexcept { ESP_ERROR_CHECK(led_strip_clear(led_strip_)); }
 } // namespace luz::led
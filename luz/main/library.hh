@@ -0,0 +1,127 @@
+#pragma once
+
+#include "decoder.hh"
+#include "layout.hh"
+#include "packet.hh"
+#include "packet_layout.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/// A climb library is a read-only blob, normally held in the "library" flash partition:
+///
+///   Header  magic "LUZL", format version, API level of the frames, number of climbs
+///   Index   one Entry per climb: offset of its frame from the start of the blob, frame size and
+///           how long the playlist shows it
+///   Frames  each climb as a single packet in the Aurora wire format of the API level
+///
+/// Frames are decoded in place through the protocol decoder, so nothing is copied into RAM.
+namespace luz::library
+{
+constexpr uint32_t magic = 0x4C5A554CU; // "LUZL" in little endian
+constexpr uint8_t format_version = 1U;
+constexpr uint16_t default_dwell_s = 30U;
+
+struct Header
+{
+  uint16_t num_climbs{};
+};
+
+struct Entry
+{
+  uint32_t offset{};
+  uint16_t size{};
+  uint16_t dwell_s{};
+};
+
+namespace detail
+{
+using HeaderLayout = layout::Layout<Header,
+                                    layout::Constant<uint32_t, magic>,
+                                    layout::Constant<uint8_t, format_version>,
+                                    layout::Constant<uint8_t, protocol::api_level>,
+                                    layout::Bind<&Header::num_climbs>>;
+
+using EntryLayout = layout::Layout<Entry,
+                                   layout::Bind<&Entry::offset>,
+                                   layout::Bind<&Entry::size>,
+                                   layout::Bind<&Entry::dwell_s>>;
+
+/// Offset of the first frame in a library of num_climbs climbs
+constexpr size_t frames_offset(size_t num_climbs) noexcept
+{
+  return HeaderLayout::size + (num_climbs * EntryLayout::size);
+}
+} // namespace detail
+
+enum class LibraryStatus
+{
+  success = 0,
+  /// The blob is not a library, or was built for another format version or API level
+  bad_header,
+  /// An index entry refers to bytes outside the frames section
+  bad_index,
+};
+
+/// Non-owning view of a climb library. The viewed bytes must outlive the view.
+class Library
+{
+public:
+  constexpr Library() noexcept = default;
+
+  /// Validate the header and index of the library held in bytes
+  /// @param[out] library View of the library, unchanged unless the library is valid
+  static constexpr LibraryStatus try_make(std::span<const std::byte> bytes,
+                                          Library& library) noexcept;
+
+  constexpr size_t size() const noexcept { return num_climbs_; }
+  constexpr bool empty() const noexcept { return num_climbs_ == 0UL; }
+
+  /// @pre index < size()
+  constexpr Entry entry(size_t index) const noexcept;
+
+  /// The undecoded packet of a climb
+  /// @pre index < size()
+  constexpr std::span<const std::byte> frame(size_t index) const noexcept;
+
+  /// Decode the placements of a climb straight from the library
+  /// @pre index < size()
+  template <protocol::PlacementContainer P>
+  constexpr protocol::ProtocolStatus
+  decode(size_t index, Packet::Header& header, P& placements) const noexcept;
+
+private:
+  constexpr Library(std::span<const std::byte> bytes, size_t num_climbs) noexcept
+      : bytes_{ bytes }, num_climbs_{ num_climbs }
+  {
+  }
+
+  std::span<const std::byte> bytes_{};
+  size_t num_climbs_{};
+};
+
+/// Assembles a library blob from Aurora packets, e.g. on the host to flash with parttool.py
+class Builder
+{
+public:
+  constexpr Builder() noexcept = default;
+
+  /// Append a climb held as a single packet
+  /// @return false, leaving the library unchanged, unless frame is exactly one packet which decodes
+  /// successfully
+  constexpr bool add(std::span<const std::byte> frame, uint16_t dwell_s = default_dwell_s);
+
+  constexpr size_t size() const noexcept { return entries_.size(); }
+
+  /// The library blob holding every climb added so far
+  constexpr std::vector<std::byte> build() const;
+
+private:
+  std::vector<Entry> entries_{};
+  std::vector<std::byte> frames_{};
+};
+} // namespace luz::library
+
+#include "library.inl"
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "library.hh"
+
+#include <algorithm>
+#include <vector>
+
+namespace luz::library
+{
+constexpr LibraryStatus Library::try_make(std::span<const std::byte> bytes,
+                                          Library& library) noexcept
+{
+  Header header{};
+  if (bytes.size() < detail::HeaderLayout::size || !detail::HeaderLayout::decode(bytes, header))
+  {
+    return LibraryStatus::bad_header;
+  }
+
+  const auto frames_offset = detail::frames_offset(header.num_climbs);
+  if (bytes.size() < frames_offset)
+  {
+    return LibraryStatus::bad_index;
+  }
+
+  const auto candidate = Library{ bytes, header.num_climbs };
+  for (size_t index = 0UL; index < candidate.size(); ++index)
+  {
+    const auto entry = candidate.entry(index);
+    if (entry.offset < frames_offset || entry.offset > bytes.size()
+        || entry.size > bytes.size() - entry.offset)
+    {
+      return LibraryStatus::bad_index;
+    }
+  }
+
+  library = candidate;
+  return LibraryStatus::success;
+}
+
+constexpr Entry Library::entry(size_t index) const noexcept
+{
+  Entry entry{};
+  (void)detail::EntryLayout::decode(
+      bytes_.subspan(detail::HeaderLayout::size + (index * detail::EntryLayout::size)), entry);
+  return entry;
+}
+
+constexpr std::span<const std::byte> Library::frame(size_t index) const noexcept
+{
+  const auto entry = this->entry(index);
+  return bytes_.subspan(entry.offset, entry.size);
+}
+
+template <protocol::PlacementContainer P>
+constexpr protocol::ProtocolStatus
+Library::decode(size_t index, Packet::Header& header, P& placements) const noexcept
+{
+  return protocol::decode(frame(index), header, placements);
+}
+
+constexpr bool Builder::add(std::span<const std::byte> frame, uint16_t dwell_s)
+{
+  Packet::Header header{};
+  std::vector<Placement> placements{};
+  // A climb spanning several packets cannot be stored as one frame
+  if (protocol::decode(frame, header, placements) != protocol::ProtocolStatus::success
+      || protocol::packet_size(header) != frame.size())
+  {
+    return false;
+  }
+
+  entries_.push_back(Entry{ .offset = static_cast<uint32_t>(frames_.size()),
+                            .size = static_cast<uint16_t>(frame.size()),
+                            .dwell_s = dwell_s });
+  frames_.insert(frames_.end(), frame.begin(), frame.end());
+  return true;
+}
+
+constexpr std::vector<std::byte> Builder::build() const
+{
+  const auto frames_offset = detail::frames_offset(entries_.size());
+  std::vector<std::byte> bytes(frames_offset + frames_.size());
+
+  detail::HeaderLayout::encode(Header{ .num_climbs = static_cast<uint16_t>(entries_.size()) },
+                               bytes);
+  for (size_t index = 0UL; index < entries_.size(); ++index)
+  {
+    auto entry = entries_[index];
+    entry.offset += static_cast<uint32_t>(frames_offset);
+    const auto entry_offset = detail::HeaderLayout::size + (index * detail::EntryLayout::size);
+    detail::EntryLayout::encode(entry, std::span(bytes).subspan(entry_offset));
+  }
+  std::ranges::copy(frames_, bytes.begin() + static_cast<ptrdiff_t>(frames_offset));
+  return bytes;
+}
+} // namespace luz::library
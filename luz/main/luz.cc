@@ -1,11 +1,37 @@
+#include "advertising.hh"
+#include "alloc_guard.hh"
 #include "ble.hh"
+#include "builtin.hh"
 #include "color.hh"
 #include "database.hh"
+#include "decode_task.hh"
+#include "fanout.hh"
 #include "led.hh"
+#include "library.hh"
+#include "output.hh"
 #include "packet.hh"
+#include "partition.hh"
+#include "playlist.hh"
 #include "protocol.hh"
+#include "receive.hh"
+#include "render.hh"
+#include "scheduler.hh"
+#include "stats.hh"
+#include "status.hh"
+#include "trace.hh"
+#include "uart.hh"
+#include "upload.hh"
+
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 
 #include <algorithm>
+#include <array>
+#include <memory_resource>
+#include <mutex>
 #include <ranges>
 #include <span>
 
@@ -14,13 +40,295 @@ namespace
 constexpr auto peripheral_name = "Steve's Decoy Board";
 constexpr auto tag = "LUZ";
 
-constexpr uint16_t ms(uint16_t millis) noexcept { return millis / portTICK_PERIOD_MS; }
+/// Ticks covering micros, rounded up so that a delay never ends before it
+constexpr TickType_t ticks_covering(uint64_t micros) noexcept
+{
+  constexpr uint64_t tick_us = portTICK_PERIOD_MS * 1000U;
+  return static_cast<TickType_t>((micros + tick_us - 1U) / tick_us);
+}
+
+uint64_t now_us() noexcept { return static_cast<uint64_t>(esp_timer_get_time()); }
+uint32_t now_ms() noexcept { return static_cast<uint32_t>(now_us() / 1000U); }
+
+/// Rate at which frames are composed and submitted to the LED strip.
+/// A full refresh of the WS2811 strip takes num_leds * 24 bits * 1.25us, i.e. ~14ms for the Decoy
+/// board, which bounds the achievable frame rate.
+constexpr uint32_t frame_rate_hz = 60U;
+/// Time for which the built-in self-test climb is shown at boot
+constexpr uint32_t self_test_ms = 3'000U;
+/// Interval at which the main loop logs the runtime statistics
+constexpr uint32_t stats_interval_ms = 60'000U;
+/// Global brightness, the current the power supply can deliver to the LED strip (0 for no limit)
+/// and the current drawn by a single LED channel at full level
+constexpr uint8_t brightness = CONFIG_LUZ_BRIGHTNESS;
+constexpr uint32_t current_budget_ma = CONFIG_LUZ_CURRENT_BUDGET_MA;
+constexpr uint32_t led_channel_ma = CONFIG_LUZ_LED_CHANNEL_MA;
+/// Writes queued between the NimBLE host task and the decode task, which decodes them at a higher
+/// priority than the render task
+constexpr size_t receive_queue_depth = CONFIG_LUZ_RECEIVE_QUEUE_DEPTH;
+constexpr UBaseType_t decode_task_priority = 5U;
+#if CONFIG_LUZ_LAYOUT_UPLOAD
+/// Layout chunks queued between the NimBLE host task and the layout task, which writes them to
+/// flash below the priority of the decode task so that climbs are still shown during an upload
+constexpr size_t layout_queue_depth = 4UL;
+constexpr UBaseType_t layout_task_priority = 2U;
+constexpr uint32_t layout_task_stack_size = 4096U;
+#endif
+#if CONFIG_LUZ_PROGRESSIVE_RENDER
+constexpr bool progressive_render = true;
+#else
+constexpr bool progressive_render = false;
+#endif
+#if CONFIG_LUZ_FANOUT_PRIMARY || CONFIG_LUZ_FANOUT_SECONDARY
+/// The UART chaining the board to the boards before and after it
+constexpr int fanout_uart_num = CONFIG_LUZ_FANOUT_UART_NUM;
+constexpr int fanout_tx_pin = CONFIG_LUZ_FANOUT_TX_PIN;
+constexpr int fanout_rx_pin = CONFIG_LUZ_FANOUT_RX_PIN;
+constexpr uint32_t fanout_baud = CONFIG_LUZ_FANOUT_BAUD;
+#endif
+#if CONFIG_LUZ_FANOUT_PRIMARY
+constexpr uint32_t fanout_keyframe_interval_ms = CONFIG_LUZ_FANOUT_KEYFRAME_INTERVAL_MS;
+#endif
+#if CONFIG_LUZ_FANOUT_SECONDARY
+/// Frames from the chain are latched at the priority at which a client's writes are decoded
+constexpr UBaseType_t fanout_task_priority = decode_task_priority;
+constexpr uint32_t fanout_task_stack_size = 4096U;
+/// Longest wait for bytes from the chain
+constexpr uint32_t fanout_poll_ms = 1'000U;
+#endif
+#if LUZ_TRACE_ENABLED
+/// Trace events are dumped to the console below the render task, which never waits for them
+constexpr UBaseType_t trace_task_priority = tskIDLE_PRIORITY;
+constexpr uint32_t trace_task_stack_size = 4096U;
+#endif
+
+/// Mutex backed by statically allocated FreeRTOS storage; unlike std::mutex, whose pthread
+/// implementation allocates on first use, it never touches the heap
+class StaticMutex
+{
+public:
+  StaticMutex() noexcept : handle_{ xSemaphoreCreateMutexStatic(&storage_) } {}
+  ~StaticMutex() noexcept { vSemaphoreDelete(handle_); }
+
+  /// Copy/move constructor/assignment
+  StaticMutex(const StaticMutex&) = delete;
+  StaticMutex& operator=(const StaticMutex&) = delete;
+  StaticMutex(StaticMutex&&) = delete;
+  StaticMutex& operator=(StaticMutex&&) = delete;
+
+  void lock() noexcept { xSemaphoreTake(handle_, portMAX_DELAY); }
+  void unlock() noexcept { xSemaphoreGive(handle_); }
+
+private:
+  StaticSemaphore_t storage_{};
+  SemaphoreHandle_t handle_;
+};
+
+using FanoutPrimary = luz::fanout::Primary<luz::fanout::Uart>;
+
+/// Owns the LED strip and the render pipeline, shared between the BLE and render tasks
+class Renderer
+{
+public:
+  Renderer() noexcept = default;
+  ~Renderer() noexcept = default;
+
+  /// Copy/move constructor/assignment
+  Renderer(const Renderer&) = delete;
+  Renderer& operator=(const Renderer&) = delete;
+  Renderer(Renderer&&) = delete;
+  Renderer& operator=(Renderer&&) = delete;
+
+  /// Show a new climb, crossfading from the current one
+  void show(const luz::render::IndexedFrame& frame, uint32_t now) noexcept
+  {
+    const auto lock = std::lock_guard{ mutex_ };
+    pipeline_.layer<luz::render::ClimbLayer>().show(frame, now);
+    pipeline_.layer<luz::render::PulseLayer>().show(frame, now);
+    dirty_ = true;
+    forward(luz::fanout::FrameKind::commit, frame, now);
+  }
+
+  /// Draw a partially received climb at once, until the complete climb is shown or rolled back
+  void show_provisional(const luz::render::IndexedFrame& frame, uint32_t now) noexcept
+  {
+    const auto lock = std::lock_guard{ mutex_ };
+    pipeline_.layer<luz::render::ClimbLayer>().show_provisional(frame, now);
+    pipeline_.layer<luz::render::PulseLayer>().show(frame, now);
+    dirty_ = true;
+    forward(luz::fanout::FrameKind::provisional, frame, now);
+  }
+
+  /// Return to the climb shown before a provisional frame which was rejected
+  void rollback(uint32_t now) noexcept
+  {
+    const auto lock = std::lock_guard{ mutex_ };
+    auto& climb = pipeline_.layer<luz::render::ClimbLayer>();
+    if (!climb.provisional())
+    {
+      return;
+    }
+    climb.rollback(now);
+    pipeline_.layer<luz::render::PulseLayer>().show(climb.target(), now);
+    dirty_ = true;
+    forward(luz::fanout::FrameKind::rollback, climb.target(), now);
+  }
+
+  /// Send every climb shown from now on down the chain of boards through primary
+  void forward_to(FanoutPrimary& primary, luz::Stats& stats) noexcept
+  {
+    const auto lock = std::lock_guard{ mutex_ };
+    fanout_ = &primary;
+    fanout_stats_ = &stats;
+  }
+
+  /// Repeat the climb shown to the boards down the chain if it is due
+  void update_chain(uint32_t now) noexcept
+  {
+    const auto lock = std::lock_guard{ mutex_ };
+    if (fanout_ != nullptr && !fanout_->update(now))
+    {
+      ++fanout_stats_->fanout_errors;
+    }
+  }
+
+  /// Show that a client has connected or disconnected
+  void indicate_connection(bool connected, uint32_t now) noexcept
+  {
+    const auto lock = std::lock_guard{ mutex_ };
+    pipeline_.layer<luz::render::ConnectionOverlay>().flash(connected, now);
+    dirty_ = true;
+  }
+
+  /// Start the error overlay
+  void indicate_error(uint32_t now) noexcept
+  {
+    const auto lock = std::lock_guard{ mutex_ };
+    pipeline_.layer<luz::render::ErrorOverlay>().trigger(now);
+    dirty_ = true;
+  }
+
+  /// Compose and submit a frame if anything has changed since the last
+  /// @return Whether a frame was submitted
+  bool render(uint32_t now) noexcept
+  {
+    {
+      const auto lock = std::lock_guard{ mutex_ };
+      const bool animating = pipeline_.animating(now);
+      if (!dirty_ && !animating && !was_animating_)
+      {
+        return false;
+      }
+
+      pipeline_.compose(frame_, now);
+      // Once the animations end one more frame is required to draw their final state
+      dirty_ = false;
+      was_animating_ = animating;
+    }
+
+    // The output stage is only used by this task, and submitting blocks for the duration of the
+    // transfer, so both are done outside the lock
+    if (output_.apply(frame_))
+    {
+      ++current_limited_frames_;
+    }
+
+    LUZ_TRACE_SCOPE(scope, "Renderer::submit");
+    for (uint32_t pxl = 0U; pxl < frame_.size(); ++pxl)
+    {
+      leds_.set_pixel(pxl, frame_[pxl]);
+    }
+    leds_.submit();
+    return true;
+  }
+
+  /// Number of frames scaled down to keep within the current budget
+  uint32_t current_limited_frames() const noexcept { return current_limited_frames_; }
+
+private:
+  /// Send a climb down the chain, if this board is the primary of one
+  void forward(luz::fanout::FrameKind kind,
+               const luz::render::IndexedFrame& frame,
+               uint32_t now) noexcept
+  {
+    if (fanout_ == nullptr)
+    {
+      return;
+    }
+    if (fanout_->send(kind, frame, now))
+    {
+      ++fanout_stats_->fanout_frames;
+    }
+    else
+    {
+      ++fanout_stats_->fanout_errors;
+    }
+  }
+
+  luz::led::ESP32LED leds_{ luz::database::num_leds };
 
-// Function object invoked for each write to the DecoyPeripheral characteristic
+  /// Guards the pipeline, which is shared between the BLE and render tasks
+  StaticMutex mutex_{};
+  luz::render::DefaultPipeline pipeline_{};
+  /// Whether an event has occurred since the last frame was composed
+  bool dirty_ = false;
+  /// Whether the pipeline was animating when the last frame was composed
+  bool was_animating_ = false;
+  /// The composed frame; only accessed by the render task
+  luz::render::Frame frame_{};
+  /// Gamma, brightness and current limiting; only accessed by the render task
+  luz::render::OutputStage output_{ brightness, current_budget_ma, led_channel_ma };
+  uint32_t current_limited_frames_ = 0U;
+  /// Sends each climb down the chain on a primary board
+  FanoutPrimary* fanout_{};
+  luz::Stats* fanout_stats_{};
+};
+
+using LayoutStore = luz::upload::LayoutStore<luz::upload::FlashPartition>;
+
+/// Light the pixels of the placements in an otherwise blank frame
+/// @return The number of placements whose position has no pixel
+uint32_t to_frame(std::span<const luz::Placement> placements,
+                  const LayoutStore& layout,
+                  luz::render::IndexedFrame& frame) noexcept
+{
+  LUZ_TRACE_SCOPE(scope, "to_frame");
+  LUZ_TRACE_ARG(scope, "placements", placements.size());
+  frame.fill(luz::render::palette_index(luz::Color{}));
+
+  uint32_t num_invalid = 0U;
+  std::ranges::for_each(placements, [&layout, &frame, &num_invalid](const auto& placement) {
+    ESP_LOGD(tag,
+             "Placement: %d: Color(r=%#X, g=%#X, b=%#X)",
+             placement.position,
+             placement.color.r,
+             placement.color.g,
+             placement.color.b);
+
+    uint16_t pixel_idx;
+    if (!layout.placement_to_pixel(placement.position, pixel_idx))
+    {
+      ESP_LOGE(tag,
+               "Invalid placement position %u; cannot convert to "
+               "pixel index!",
+               placement.position);
+      ++num_invalid;
+      return;
+    }
+    ESP_LOGD(tag, "Setting placement position %u to pixel %u", placement.position, pixel_idx);
+    frame[pixel_idx] = luz::render::palette_index(placement.color);
+  });
+  return num_invalid;
+}
+
+// Function object invoked by the decode task for each write to the DecoyPeripheral characteristic
 class OnWrite
 {
 public:
-  OnWrite() noexcept = default;
+  OnWrite(luz::Stats& stats, Renderer& renderer, const LayoutStore& layout) noexcept
+      : stats_{ stats }, renderer_{ renderer }, layout_{ layout }
+  {
+  }
   ~OnWrite() noexcept = default;
 
   /// Copy/move constructor/assignment
@@ -29,80 +337,531 @@ public:
   OnWrite(OnWrite&&) = delete;
   OnWrite& operator=(OnWrite&&) = delete;
 
+  /// Report the status of each completed or rejected frame through notifier
+  void report_status_to(luz::ble::Notifier& notifier) noexcept
+  {
+    status_reporter_.attach(notifier);
+  }
+
   /// Call operator invoked each time the DecoyPeripheral characteristic is
   /// written to by a client
   /// @param bytes The payload written by the client
   void operator()(std::span<const std::byte> bytes) noexcept
   {
-    luz::Packet packet{};
-    if (protocol_.process(bytes, packet))
+    LUZ_TRACE_SCOPE(scope, "OnWrite");
+    // The placements are backed by placement_storage_, so decoding never allocates
+    placement_resource_.release();
+    luz::Packet packet{ .placements = std::pmr::vector<luz::Placement>{ &placement_resource_ } };
+    const auto decode_start = now_us();
+    const bool decoded = protocol_.process(bytes, packet);
+    const auto render_start = now_us();
+    if (decoded)
     {
       ESP_LOGD(tag, "OnWrite: Recieved a packet!");
+      ++stats_.packets_decoded;
+
+      const auto num_invalid = to_frame(packet.placements, layout_, frame_);
+
+      const auto now = now_ms();
+      renderer_.show(frame_, now);
+
+      if (num_invalid > 0U)
+      {
+        stats_.invalid_placements += num_invalid;
+        ++stats_.packets_with_errors;
+        renderer_.indicate_error(now);
+      }
+    }
+    else if (progressive_render)
+    {
+      show_provisional(packet, now_ms());
+    }
 
-      leds_.clear();
-
-      std::ranges::for_each(packet.placements, [this](const auto& placement) {
-        ESP_LOGD(tag,
-                 "Placement: %d: Color(r=%#X, g=%#X, b=%#X)",
-                 placement.position,
-                 placement.color.r,
-                 placement.color.g,
-                 placement.color.b);
-
-        uint16_t pixel_idx;
-        if (!luz::database::placement_to_pixel(placement.position, pixel_idx))
-        {
-          ESP_LOGE(tag,
-                   "Invalid placement position %u; cannot convert to "
-                   "pixel index!",
-                   placement.position);
-          indicate_failure();
-        }
-        ESP_LOGD(tag, "Setting placement position %u to pixel %u", placement.position, pixel_idx);
-        leds_.set_pixel(pixel_idx, placement.color);
-      });
-
-      leds_.submit();
+    const auto decode_us = static_cast<uint32_t>(render_start - decode_start);
+    const auto render_us = static_cast<uint32_t>(now_us() - render_start);
+    for (const auto status : protocol_.statuses())
+    {
+      status_reporter_.report(status,
+                              decode_us,
+                              status == luz::protocol::ProtocolStatus::success ? render_us : 0U);
     }
   };
 
 private:
-  /// Flash every tenth pixel red for 20s and terminate
-  void indicate_failure()
+  /// Light the placements received so far of a climb still arriving, or return to the previous
+  /// climb if the one shown provisionally has been rejected
+  void show_provisional(luz::Packet& packet, uint32_t now) noexcept
+  {
+    if (protocol_.provisional(packet))
+    {
+      // Unknown positions are counted once the climb is complete
+      (void)to_frame(packet.placements, layout_, frame_);
+      renderer_.show_provisional(frame_, now);
+    }
+    else if (!protocol_.statuses().empty())
+    {
+      renderer_.rollback(now);
+    }
+  }
+
+  luz::Stats& stats_;
+  Renderer& renderer_;
+  const LayoutStore& layout_;
+  luz::protocol::Protocol protocol_{};
+  luz::protocol::StatusReporter<luz::ble::Notifier> status_reporter_{};
+  alignas(luz::Placement) std::array<std::byte,
+                                     luz::protocol::detail::max_placements_per_packet
+                                         * sizeof(luz::Placement)> placement_storage_{};
+  std::pmr::monotonic_buffer_resource placement_resource_{ placement_storage_.data(),
+                                                           placement_storage_.size(),
+                                                           std::pmr::null_memory_resource() };
+  /// The frame of the most recently decoded climb
+  luz::render::IndexedFrame frame_{};
+};
+
+using DecodeTask = luz::receive::DecodeTask<receive_queue_depth, OnWrite, luz::ble::Notifier>;
+
+#if CONFIG_LUZ_FANOUT_SECONDARY
+// Shows the climbs sent down the chain by the primary board, passing them on to the next board
+class SecondaryTask
+{
+public:
+  SecondaryTask(luz::Stats& stats, Renderer& renderer, luz::fanout::Uart& uart) noexcept
+      : stats_{ stats },
+        renderer_{ renderer },
+        secondary_{ uart },
+        handle_{ xTaskCreateStatic(&SecondaryTask::run,
+                                   "fanout",
+                                   fanout_task_stack_size,
+                                   this,
+                                   fanout_task_priority,
+                                   stack_.data(),
+                                   &task_) }
   {
-    constexpr uint16_t num_100ms_cycles = 200U;
-    constexpr auto red = luz::Color(0U, 255U, 0U);
+  }
+  ~SecondaryTask() noexcept { vTaskDelete(handle_); }
+
+  /// Copy/move constructor/assignment
+  SecondaryTask(const SecondaryTask&) = delete;
+  SecondaryTask& operator=(const SecondaryTask&) = delete;
+  SecondaryTask(SecondaryTask&&) = delete;
+  SecondaryTask& operator=(SecondaryTask&&) = delete;
+
+private:
+  static void run(void* self) noexcept { static_cast<SecondaryTask*>(self)->receive(); }
 
-    for (uint16_t i = 0U; i < num_100ms_cycles; ++i)
+  [[noreturn]] void receive() noexcept
+  {
+    while (true)
+    {
+      secondary_.poll(fanout_poll_ms,
+                      [this](luz::fanout::FrameKind kind, const luz::render::IndexedFrame& frame) {
+                        latch(kind, frame);
+                      });
+      const auto& latch = secondary_.latch();
+      stats_.fanout_errors
+          = latch.corrupt() + latch.skipped() + secondary_.reader().discarded();
+    }
+  }
+
+  void latch(luz::fanout::FrameKind kind, const luz::render::IndexedFrame& frame) noexcept
+  {
+    LUZ_TRACE_SCOPE(scope, "SecondaryTask::latch");
+    const auto now = now_ms();
+    switch (kind)
+    {
+    case luz::fanout::FrameKind::commit:
+      renderer_.show(frame, now);
+      // Counted as a climb from a client, which holds off the library
+      ++stats_.packets_decoded;
+      break;
+    case luz::fanout::FrameKind::provisional:
+      renderer_.show_provisional(frame, now);
+      break;
+    case luz::fanout::FrameKind::rollback:
+      renderer_.rollback(now);
+      break;
+    }
+    ++stats_.fanout_frames;
+  }
+
+  luz::Stats& stats_;
+  Renderer& renderer_;
+  luz::fanout::Secondary<luz::fanout::Uart> secondary_;
+  StaticTask_t task_{};
+  std::array<StackType_t, fanout_task_stack_size> stack_{};
+  TaskHandle_t handle_;
+};
+#endif
+
+// Plays the climbs of the flash library while no client is sending climbs
+class LibraryPlayer
+{
+public:
+  LibraryPlayer(luz::Stats& stats, Renderer& renderer, const LayoutStore& layout) noexcept
+      : stats_{ stats }, renderer_{ renderer }, layout_{ layout }
+  {
+    if (const auto status = luz::library::Library::try_make(partition_.bytes(), library_);
+        status != luz::library::LibraryStatus::success)
     {
-      leds_.clear();
-      vTaskDelay(ms(100U));
-      for (uint32_t pxl = 0; pxl < luz::database::num_leds; pxl += 10)
+      ESP_LOGW(tag, "No climb library: status %d", static_cast<int>(status));
+      return;
+    }
+    ESP_LOGI(tag, "Climb library holds %u climbs", static_cast<unsigned>(library_.size()));
+  }
+  ~LibraryPlayer() noexcept = default;
+
+  /// Copy/move constructor/assignment
+  LibraryPlayer(const LibraryPlayer&) = delete;
+  LibraryPlayer& operator=(const LibraryPlayer&) = delete;
+  LibraryPlayer(LibraryPlayer&&) = delete;
+  LibraryPlayer& operator=(LibraryPlayer&&) = delete;
+
+  /// Start playing unless a client has sent a climb within playlist_idle_ms, or stop playing if
+  /// one just has, then show the next climb if it is due
+  void update(uint32_t now) noexcept
+  {
+    if (const uint32_t packets_decoded = stats_.packets_decoded;
+        packets_decoded != packets_decoded_)
+    {
+      packets_decoded_ = packets_decoded;
+      last_packet_ms_ = now;
+      playlist_.stop();
+    }
+    else if (!playlist_.playing()
+             && (packets_decoded_ == 0U || now - last_packet_ms_ >= playlist_idle_ms))
+    {
+      playlist_.start(now);
+    }
+
+    const auto index = playlist_.poll(now);
+    if (!index)
+    {
+      return;
+    }
+
+    placement_resource_.release();
+    luz::Packet::Header header{};
+    auto placements = std::pmr::vector<luz::Placement>{ &placement_resource_ };
+    if (const auto status = library_.decode(*index, header, placements);
+        status != luz::protocol::ProtocolStatus::success)
+    {
+      ESP_LOGE(tag,
+               "Library climb %u is corrupt: status %d",
+               static_cast<unsigned>(*index),
+               static_cast<int>(status));
+      renderer_.indicate_error(now);
+      return;
+    }
+    if (to_frame(placements, layout_, frame_) > 0U)
+    {
+      renderer_.indicate_error(now);
+    }
+    renderer_.show(frame_, now);
+  }
+
+private:
+  /// Time after the last climb sent by a client before the playlist resumes
+  static constexpr uint32_t playlist_idle_ms = 10U * 60'000U;
+
+  luz::Stats& stats_;
+  Renderer& renderer_;
+  const LayoutStore& layout_;
+  luz::library::MappedPartition partition_{ luz::library::partition_label };
+  luz::library::Library library_{};
+  luz::library::Playlist playlist_{ library_ };
+  uint32_t packets_decoded_{};
+  uint32_t last_packet_ms_{};
+  alignas(luz::Placement) std::array<std::byte,
+                                     luz::protocol::detail::max_placements_per_packet
+                                         * sizeof(luz::Placement)> placement_storage_{};
+  std::pmr::monotonic_buffer_resource placement_resource_{ placement_storage_.data(),
+                                                           placement_storage_.size(),
+                                                           std::pmr::null_memory_resource() };
+  luz::render::IndexedFrame frame_{};
+};
+
+#if CONFIG_LUZ_LAYOUT_UPLOAD
+// Function object invoked for each write to the layout characteristic. Erasing and writing the
+// flash takes tens to hundreds of milliseconds, so chunks are queued for a task of their own which
+// installs them and replies to each, leaving the NimBLE host task free to carry on.
+class LayoutTask
+{
+public:
+  explicit LayoutTask(LayoutStore& layout) noexcept
+      : layout_{ layout },
+        handle_{ xTaskCreateStatic(&LayoutTask::run,
+                                   "layout",
+                                   layout_task_stack_size,
+                                   this,
+                                   layout_task_priority,
+                                   stack_.data(),
+                                   &task_) }
+  {
+  }
+  ~LayoutTask() noexcept { vTaskDelete(handle_); }
+
+  /// Copy/move constructor/assignment
+  LayoutTask(const LayoutTask&) = delete;
+  LayoutTask& operator=(const LayoutTask&) = delete;
+  LayoutTask(LayoutTask&&) = delete;
+  LayoutTask& operator=(LayoutTask&&) = delete;
+
+  /// Reply to each chunk through notifier
+  void reply_to(luz::ble::Notifier& notifier) noexcept { notifier_ = &notifier; }
+
+  /// Call operator invoked each time the layout characteristic is written to by a client
+  /// @param bytes A chunk of the layout blob, prefixed by its offset; dropped if the queue is
+  /// full, in which case the reply to the next chunk tells the client to resume from it
+  void operator()(std::span<const std::byte> bytes) noexcept
+  {
+    LUZ_TRACE_SCOPE(scope, "LayoutTask::push");
+    (void)queue_.try_push(bytes);
+    xTaskNotifyGive(handle_);
+  }
+
+private:
+  static void run(void* self) noexcept { static_cast<LayoutTask*>(self)->drain(); }
+
+  [[noreturn]] void drain() noexcept
+  {
+    while (true)
+    {
+      (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      for (auto bytes = queue_.front(); bytes; bytes = queue_.front())
+      {
+        install(*bytes);
+        queue_.pop();
+      }
+      if (const auto overruns = queue_.overruns(); overruns != reported_overruns_)
       {
-        leds_.set_pixel(pxl, red);
+        ESP_LOGW(tag, "Layout chunks dropped: %lu", static_cast<unsigned long>(overruns));
+        reported_overruns_ = overruns;
       }
-      leds_.submit();
-      vTaskDelay(ms(100U));
     }
+  }
 
-    std::abort();
-  };
+  void install(std::span<const std::byte> bytes) noexcept
+  {
+    LUZ_TRACE_SCOPE(scope, "LayoutTask::install");
+    const auto reply = layout_.receive(bytes);
+    if (reply.status == luz::upload::UploadStatus::complete)
+    {
+      const auto active = layout_.active();
+      ESP_LOGI(tag,
+               "Layout %u of %u positions installed",
+               active->blob.layout_version,
+               active->blob.num_positions);
+    }
+    else if (reply.status != luz::upload::UploadStatus::in_progress)
+    {
+      ESP_LOGW(tag,
+               "Layout chunk rejected: status %d, next offset %lu",
+               static_cast<int>(reply.status),
+               static_cast<unsigned long>(reply.next_offset));
+    }
 
-  luz::led::ESP32LED leds_{ luz::database::num_leds };
-  luz::protocol::Protocol protocol_{};
+    if (notifier_ != nullptr)
+    {
+      std::array<std::byte, luz::upload::UploadReplyLayout::size> reply_bytes{};
+      luz::upload::UploadReplyLayout::encode(reply, reply_bytes);
+      notifier_->notify(reply_bytes);
+    }
+  }
+
+  LayoutStore& layout_;
+  luz::ble::Notifier* notifier_{};
+  luz::receive::ReceiveQueue<layout_queue_depth> queue_{};
+  uint32_t reported_overruns_{};
+  StaticTask_t task_{};
+  std::array<StackType_t, layout_task_stack_size> stack_{};
+  TaskHandle_t handle_;
+};
+#endif
+
+#if LUZ_TRACE_ENABLED
+// Writes the trace events to the console and starts the next trace. Sending them over the console
+// takes seconds, which the render task would otherwise spend blocked, distorting the very
+// latencies being traced.
+class TraceTask
+{
+public:
+  TraceTask() noexcept
+      : handle_{ xTaskCreateStatic(&TraceTask::run,
+                                   "trace",
+                                   trace_task_stack_size,
+                                   this,
+                                   trace_task_priority,
+                                   stack_.data(),
+                                   &task_) }
+  {
+  }
+  ~TraceTask() noexcept { vTaskDelete(handle_); }
+
+  /// Copy/move constructor/assignment
+  TraceTask(const TraceTask&) = delete;
+  TraceTask& operator=(const TraceTask&) = delete;
+  TraceTask(TraceTask&&) = delete;
+  TraceTask& operator=(TraceTask&&) = delete;
+
+  /// Dump the events recorded so far once the task gets to run
+  void dump() noexcept { xTaskNotifyGive(handle_); }
+
+private:
+  static void run(void* self) noexcept { static_cast<TraceTask*>(self)->write(); }
+
+  [[noreturn]] void write() noexcept
+  {
+    while (true)
+    {
+      (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      luz::trace::write_chrome_json(stdout);
+      luz::trace::clear();
+    }
+  }
+
+  StaticTask_t task_{};
+  std::array<StackType_t, trace_task_stack_size> stack_{};
+  TaskHandle_t handle_;
 };
+#endif
 } // anonymous namespace
 
 extern "C" void app_main(void)
 {
-  auto on_write = OnWrite{};
-  auto decoy_peripheral = luz::ble::DecoyPeripheral{ peripheral_name, on_write };
-  (void)decoy_peripheral;
+  static auto stats = luz::Stats{};
+  static auto renderer = Renderer{};
+#if CONFIG_LUZ_FANOUT_PRIMARY || CONFIG_LUZ_FANOUT_SECONDARY
+  static auto fanout_uart
+      = luz::fanout::Uart{ fanout_uart_num, fanout_tx_pin, fanout_rx_pin, fanout_baud };
+#endif
+#if CONFIG_LUZ_FANOUT_PRIMARY
+  static auto fanout_primary = FanoutPrimary{ fanout_uart, fanout_keyframe_interval_ms };
+  renderer.forward_to(fanout_primary, stats);
+#elif CONFIG_LUZ_FANOUT_SECONDARY
+  static auto secondary_task = SecondaryTask{ stats, renderer, fanout_uart };
+#endif
+  static auto layout_partition = luz::upload::FlashPartition{ luz::upload::partition_label };
+  static auto layout = LayoutStore{ layout_partition };
+  static auto on_write = OnWrite{ stats, renderer, layout };
+  static auto decode_task = DecodeTask{ stats, on_write, decode_task_priority };
+#if CONFIG_LUZ_LAYOUT_UPLOAD
+  static auto on_layout_write = LayoutTask{ layout };
+#else
+  // Without the layout characteristic nothing writes a layout
+  static auto on_layout_write = [](std::span<const std::byte>) {};
+#endif
+  static auto library_player = LibraryPlayer{ stats, renderer, layout };
+#if LUZ_TRACE_ENABLED
+  static auto trace_task = TraceTask{};
+#endif
+  auto decoy_peripheral = luz::ble::DecoyPeripheral{
+    peripheral_name, decode_task, decode_task.without_response(), on_layout_write
+  };
+  on_write.report_status_to(decoy_peripheral.status_notifier());
+  decode_task.report_credit_to(decoy_peripheral.credit_notifier());
+#if CONFIG_LUZ_LAYOUT_UPLOAD
+  on_layout_write.reply_to(decoy_peripheral.layout_notifier());
+#endif
+  if (const auto active = layout.active())
+  {
+    ESP_LOGI(tag, "Using uploaded layout %u", active->blob.layout_version);
+  }
 
   ESP_LOGI(tag, "Decoy Peripheral created");
 
+  auto advertising = luz::ble::AdvertisingScheduler{
+    decoy_peripheral.advertiser(),
+    [was_connected = false](luz::ble::ConnectionState state) mutable {
+      ESP_LOGI(tag, "Connection state: %d", static_cast<int>(state));
+      // Backing off to the slow interval is not worth showing
+      if (const bool connected = state == luz::ble::ConnectionState::connected;
+          connected != was_connected)
+      {
+        was_connected = connected;
+        renderer.indicate_connection(connected, now_ms());
+      }
+    }
+  };
+  const auto& connection_events = decoy_peripheral.connection_events();
+
+  // Everything the application needs has now been allocated
+  luz::heap::mark_boot_complete();
+
+  // The main task doubles as the render task
+  auto scheduler = luz::render::FrameScheduler{ frame_rate_hz };
+  scheduler.start(now_us());
+  const auto boot_ms = now_ms();
+  uint32_t last_stats_ms = boot_ms;
+
+  advertising.start(boot_ms);
+  renderer.show(luz::builtin::self_test, boot_ms);
+  bool self_test_shown = true;
   while (true)
   {
-    vTaskDelay(ms(2000));
+    if (const auto wait = scheduler.wait_us(now_us()); wait > 0U)
+    {
+      vTaskDelay(ticks_covering(wait));
+    }
+
+    const auto now = now_ms();
+    // Read before the connections, as follow() requires
+    const auto disconnects = connection_events.disconnects.load();
+    advertising.follow(connection_events.connects.load(), disconnects, now);
+    advertising.update(now);
+
+    if (self_test_shown && (now - boot_ms) >= self_test_ms)
+    {
+      // Clear the self-test unless a climb has already replaced it
+      self_test_shown = false;
+      if (stats.packets_decoded == 0U)
+      {
+        static constexpr auto blank = luz::render::IndexedFrame{};
+        renderer.show(blank, now);
+      }
+    }
+    if (!self_test_shown)
+    {
+      library_player.update(now);
+    }
+
+    renderer.update_chain(now);
+    if (renderer.render(now))
+    {
+      ++stats.frames_rendered;
+    }
+    scheduler.complete(now_us());
+    stats.missed_deadlines = scheduler.missed_deadlines();
+    stats.dropped_frames = scheduler.dropped_frames();
+    stats.current_limited_frames = renderer.current_limited_frames();
+    stats.allocations_after_boot = luz::heap::allocations_after_boot();
+
+    if (now - last_stats_ms >= stats_interval_ms)
+    {
+      last_stats_ms = now;
+      ESP_LOGI(tag,
+               "Stats: packets decoded=%lu, packets with errors=%lu, invalid placements=%lu, "
+               "receive overruns=%lu, frames rendered=%lu, current limited frames=%lu, "
+               "missed deadlines=%lu, dropped frames=%lu, chain frames=%lu, chain errors=%lu",
+               static_cast<unsigned long>(stats.packets_decoded.load()),
+               static_cast<unsigned long>(stats.packets_with_errors.load()),
+               static_cast<unsigned long>(stats.invalid_placements.load()),
+               static_cast<unsigned long>(stats.receive_overruns.load()),
+               static_cast<unsigned long>(stats.frames_rendered.load()),
+               static_cast<unsigned long>(stats.current_limited_frames.load()),
+               static_cast<unsigned long>(stats.missed_deadlines.load()),
+               static_cast<unsigned long>(stats.dropped_frames.load()),
+               static_cast<unsigned long>(stats.fanout_frames.load()),
+               static_cast<unsigned long>(stats.fanout_errors.load()));
+      ESP_LOGI(tag,
+               "Memory: min free heap=%lu bytes, render task stack high-water=%lu bytes, "
+               "allocations after boot=%lu",
+               static_cast<unsigned long>(heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT)),
+               static_cast<unsigned long>(uxTaskGetStackHighWaterMark(nullptr)),
+               static_cast<unsigned long>(stats.allocations_after_boot.load()));
+#if LUZ_TRACE_ENABLED
+      trace_task.dump();
+#endif
+    }
   }
 }
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "color.hh"
+#include "database.hh"
+#include "render.hh"
+#include "trace.hh"
+
+#include <array>
+#include <cstdint>
+
+namespace luz::render
+{
+/// Maps an 8-bit channel level to the level written to the LED strip
+using LevelTable = std::array<uint8_t, 256>;
+
+/// Exponent of the perceptual response corrected for before levels are written to the strip
+constexpr double default_gamma = 2.2;
+
+namespace detail
+{
+/// Natural logarithm of x > 0; x is reduced to [0.5, 1), over which the series of
+/// 2 atanh((x - 1) / (x + 1)) converges quickly
+constexpr double ln(double x) noexcept
+{
+  constexpr double ln_2 = 0.693147180559945309;
+  int32_t exponent = 0;
+  for (; x < 0.5; x *= 2.0)
+  {
+    --exponent;
+  }
+  for (; x >= 1.0; x /= 2.0)
+  {
+    ++exponent;
+  }
+
+  const double z = (x - 1.0) / (x + 1.0);
+  double term = z;
+  double sum = 0.0;
+  for (uint32_t n = 1U; n < 41U; n += 2U)
+  {
+    sum += term / n;
+    term *= z * z;
+  }
+  return 2.0 * sum + exponent * ln_2;
+}
+
+/// e to the power of x <= 0; the Taylor series of e^(x / 32) is squared five times
+constexpr double exp(double x) noexcept
+{
+  const double y = x / 32.0;
+  double term = 1.0;
+  double sum = 1.0;
+  for (uint32_t n = 1U; n < 20U; ++n)
+  {
+    term *= y / n;
+    sum += term;
+  }
+  for (uint32_t i = 0U; i < 5U; ++i)
+  {
+    sum *= sum;
+  }
+  return sum;
+}
+} // namespace detail
+
+/// Build the table raising each level, as a fraction of full scale, to the power of gamma
+constexpr LevelTable make_gamma_table(double gamma) noexcept
+{
+  LevelTable table{};
+  for (uint32_t level = 1U; level < table.size(); ++level)
+  {
+    const double fraction = detail::exp(gamma * detail::ln(level / 255.0));
+    table[level] = static_cast<uint8_t>(fraction * 255.0 + 0.5);
+  }
+  return table;
+}
+
+/// Gamma correction for the default gamma, computed at compile time
+constexpr auto gamma_table = make_gamma_table(default_gamma);
+
+/// Final stage between a composed Frame and the LED strip: applies gamma correction and the global
+/// brightness, fixed when the stage is built, through a single table lookup per channel, then scales the whole frame down if its
+/// estimated current exceeds the budget of the power supply.
+class OutputStage
+{
+public:
+  /// Current drawn by a single channel of a pixel at full level
+  static constexpr uint32_t default_channel_ma = 20U;
+
+  /// @param brightness Global brightness, where 255 is full brightness
+  /// @param budget_ma Maximum current drawn by the strip, or 0 for no limit
+  /// @param channel_ma Current drawn by a single channel of a pixel at full level; non-zero
+  constexpr explicit OutputStage(uint8_t brightness = 255U,
+                                 uint32_t budget_ma = 0U,
+                                 uint32_t channel_ma = default_channel_ma) noexcept;
+  ~OutputStage() noexcept = default;
+
+  /// Copy/move constructor/assignment
+  OutputStage(const OutputStage&) = delete;
+  OutputStage& operator=(const OutputStage&) = delete;
+  OutputStage(OutputStage&&) = delete;
+  OutputStage& operator=(OutputStage&&) = delete;
+
+  constexpr uint8_t brightness() const noexcept { return brightness_; }
+
+  /// The level written to the strip for each level of a composed frame
+  constexpr const LevelTable& levels() const noexcept { return levels_; }
+
+  /// Estimated current drawn by the strip showing the frame, which has already been applied
+  constexpr uint32_t estimate_ma(const Frame& frame) const noexcept;
+
+  /// Convert a composed frame in place to the levels written to the strip
+  /// @return Whether the frame was scaled down to keep within the current budget
+  constexpr bool apply(Frame& frame) noexcept;
+
+private:
+  LevelTable levels_{};
+  uint8_t brightness_{};
+  uint32_t budget_ma_{};
+  uint32_t channel_ma_{};
+  /// Pixels lit by the frame being applied, so scaling skips the dark majority of the board
+  std::array<uint16_t, database::num_leds> lit_{};
+};
+} // namespace luz::render
+
+#include "output.inl"
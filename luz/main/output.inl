@@ -0,0 +1,69 @@
+#pragma once
+
+#include "output.hh"
+
+namespace luz::render
+{
+constexpr OutputStage::OutputStage(uint8_t brightness,
+                                   uint32_t budget_ma,
+                                   uint32_t channel_ma) noexcept
+    : brightness_{ brightness }, budget_ma_{ budget_ma }, channel_ma_{ channel_ma }
+{
+  for (size_t level = 0UL; level < levels_.size(); ++level)
+  {
+    levels_[level] = static_cast<uint8_t>((gamma_table[level] * uint32_t{ brightness } + 127U)
+                                          / 255U);
+  }
+}
+
+constexpr uint32_t OutputStage::estimate_ma(const Frame& frame) const noexcept
+{
+  uint32_t total = 0U;
+  for (const auto& color : frame)
+  {
+    total += uint32_t{ color.r } + color.g + color.b;
+  }
+  return total * channel_ma_ / 255U;
+}
+
+constexpr bool OutputStage::apply(Frame& frame) noexcept
+{
+  LUZ_TRACE_SCOPE(scope, "OutputStage::apply");
+  // Sum of every channel level; each full level of 255 draws channel_ma_
+  uint32_t total = 0U;
+  size_t num_lit = 0UL;
+  for (size_t pxl = 0UL; pxl < frame.size(); ++pxl)
+  {
+    auto& color = frame[pxl];
+    color = Color{ levels_[color.r], levels_[color.g], levels_[color.b] };
+    if (const uint32_t sum = uint32_t{ color.r } + color.g + color.b; sum > 0U)
+    {
+      total += sum;
+      lit_[num_lit++] = static_cast<uint16_t>(pxl);
+    }
+  }
+
+  if (budget_ma_ == 0U)
+  {
+    return false;
+  }
+  const uint32_t budget = budget_ma_ * 255U / channel_ma_;
+  if (total <= budget)
+  {
+    return false;
+  }
+
+  // Fixed-point fraction factor / 2^16 of the frame which fits the budget; rounding down keeps the
+  // scaled frame within it
+  const uint32_t factor = static_cast<uint32_t>((uint64_t{ budget } << 16U) / total);
+  const auto channel = [factor](uint8_t level) {
+    return static_cast<uint8_t>((level * factor) >> 16U);
+  };
+  for (size_t index = 0UL; index < num_lit; ++index)
+  {
+    auto& color = frame[lit_[index]];
+    color = Color{ channel(color.r), channel(color.g), channel(color.b) };
+  }
+  return true;
+}
+} // namespace luz::render
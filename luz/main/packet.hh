@@ -1,6 +1,7 @@
 #pragma once
 
 #include "color.hh"
+#include <memory_resource>
 #include <optional>
 #include <vector>
 
@@ -37,7 +38,7 @@ struct Placement
   uint16_t position{};
   Color color{};
 
-  friend bool operator==(const Placement& lhs, const Placement& rhs)
+  friend constexpr bool operator==(const Placement& lhs, const Placement& rhs)
   {
     return lhs.position == rhs.position && lhs.color == rhs.color;
   };
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "color.hh"
+#include "layout.hh"
+#include "packet.hh"
+
+#include <cstdint>
+
+namespace luz::protocol
+{
+/// The Aurora API level implemented, which selects the PacketLayout and is advertised to clients
+constexpr uint8_t api_level = 3U;
+
+namespace codec
+{
+/// The payload size on the wire includes the index marker, which is decoded into the header
+struct PayloadSize
+{
+  static constexpr uint8_t decode(uint8_t raw) noexcept { return raw - 1U; }
+  static constexpr uint8_t encode(uint8_t value) noexcept { return value + 1U; }
+  static constexpr bool valid(uint8_t) noexcept { return true; }
+};
+
+struct IndexMarker
+{
+  static constexpr luz::IndexMarker decode(uint8_t raw) noexcept
+  {
+    return static_cast<luz::IndexMarker>(raw);
+  }
+  static constexpr uint8_t encode(luz::IndexMarker value) noexcept
+  {
+    return static_cast<uint8_t>(value);
+  }
+  static constexpr bool valid(uint8_t raw) noexcept
+  {
+    return index_marker_from_underlying(raw).has_value();
+  }
+};
+} // namespace codec
+
+/// Wire layouts of the Aurora protocol records, selected at compile time by API level
+template <uint8_t ApiLevel> struct PacketLayout;
+
+template <> struct PacketLayout<3U>
+{
+  using Header = layout::Layout<
+      Packet::Header,
+      layout::Constant<uint8_t, Packet::Header::first_byte_indicator>,
+      layout::Bind<&Packet::Header::payload_size, uint8_t, codec::PayloadSize>,
+      layout::Bind<&Packet::Header::checksum>,
+      layout::Constant<uint8_t, Packet::Header::second_byte_indicator>,
+      layout::Bind<&Packet::Header::index_marker, uint8_t, codec::IndexMarker>>;
+
+  /// Colors are a single 3-3-2 RGB byte
+  using Color
+      = layout::Layout<luz::Color,
+                       layout::Packed<uint8_t,
+                                      layout::Bits<&luz::Color::r, 3UL, layout::Scale<32U>>,
+                                      layout::Bits<&luz::Color::g, 3UL, layout::Scale<32U>>,
+                                      layout::Bits<&luz::Color::b, 2UL, layout::Scale<64U>>>>;
+
+  using Placement = layout::Layout<luz::Placement,
+                                   layout::Bind<&luz::Placement::position>,
+                                   layout::Nested<&luz::Placement::color, PacketLayout::Color>>;
+
+  using Footer = layout::Layout<Packet::Footer,
+                                layout::Constant<uint8_t, Packet::Footer::third_byte_indicator>>;
+};
+
+/// The layouts of the implemented API level
+using Layouts = PacketLayout<api_level>;
+} // namespace luz::protocol
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "color.hh"
+#include "database.hh"
+#include "packet_layout.hh"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace luz::render
+{
+/// Index of a color in the palette, which is the 3-3-2 color byte of the protocol
+using PaletteIndex = uint8_t;
+
+namespace detail
+{
+constexpr std::array<Color, 256> make_palette() noexcept
+{
+  std::array<Color, 256> palette{};
+  for (size_t index = 0UL; index < palette.size(); ++index)
+  {
+    const auto bytes = std::array{ static_cast<std::byte>(index) };
+    (void)protocol::Layouts::Color::decode(bytes, palette[index]);
+  }
+  return palette;
+}
+} // namespace detail
+
+/// Every color a client can send, indexed by its color byte
+constexpr auto palette = detail::make_palette();
+
+/// The palette index of a color; colors outside the palette are rounded down to one within it
+constexpr PaletteIndex palette_index(Color color) noexcept
+{
+  std::array<std::byte, 1> bytes{};
+  protocol::Layouts::Color::encode(color, bytes);
+  return std::to_integer<PaletteIndex>(bytes[0]);
+}
+
+/// A climb stored as one palette index per pixel, a third of the size of the equivalent Frame.
+/// Indices are only expanded to colors when a frame is composed for the LED strip.
+using IndexedFrame = std::array<PaletteIndex, database::num_leds>;
+
+/// Look up the color of each palette index
+/// @pre colors holds at least as many elements as indices
+constexpr void expand(std::span<const PaletteIndex> indices, std::span<Color> colors) noexcept
+{
+  for (size_t pxl = 0UL; pxl < indices.size(); ++pxl)
+  {
+    colors[pxl] = palette[indices[pxl]];
+  }
+}
+} // namespace luz::render
@@ -0,0 +1,79 @@
+#include "partition.hh"
+
+#include "esp_log.h"
+
+namespace
+{
+constexpr auto tag = "PARTITION";
+} // anonymous namespace
+
+namespace luz::library
+{
+MappedPartition::MappedPartition(const char* label) noexcept
+{
+  const auto* partition
+      = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+  if (partition == nullptr)
+  {
+    ESP_LOGW(tag, "No %s partition", label);
+    return;
+  }
+
+  const void* data = nullptr;
+  if (const auto err = esp_partition_mmap(
+          partition, 0U, partition->size, ESP_PARTITION_MMAP_DATA, &data, &handle_);
+      err != ESP_OK)
+  {
+    ESP_LOGE(tag, "Failed to map %s partition: %s", label, esp_err_to_name(err));
+    return;
+  }
+  bytes_ = std::span{ static_cast<const std::byte*>(data), partition->size };
+}
+
+MappedPartition::~MappedPartition() noexcept
+{
+  if (!bytes_.empty())
+  {
+    esp_partition_munmap(handle_);
+  }
+}
+} // namespace luz::library
+
+namespace luz::upload
+{
+FlashPartition::FlashPartition(const char* label) noexcept
+    : partition_{ esp_partition_find_first(
+          ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label) },
+      mapped_{ label }
+{
+}
+
+bool FlashPartition::erase(size_t offset, size_t size) noexcept
+{
+  if (bytes().empty())
+  {
+    return false;
+  }
+  if (const auto err = esp_partition_erase_range(partition_, offset, size); err != ESP_OK)
+  {
+    ESP_LOGE(tag, "Failed to erase %s partition: %s", partition_->label, esp_err_to_name(err));
+    return false;
+  }
+  return true;
+}
+
+bool FlashPartition::write(size_t offset, std::span<const std::byte> bytes) noexcept
+{
+  if (this->bytes().empty())
+  {
+    return false;
+  }
+  if (const auto err = esp_partition_write(partition_, offset, bytes.data(), bytes.size());
+      err != ESP_OK)
+  {
+    ESP_LOGE(tag, "Failed to write %s partition: %s", partition_->label, esp_err_to_name(err));
+    return false;
+  }
+  return true;
+}
+} // namespace luz::upload
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "esp_partition.h"
+
+#include <cstddef>
+#include <span>
+
+namespace luz::library
+{
+/// Label of the data partition holding the climb library
+constexpr auto partition_label = "library";
+
+/// A data partition mapped read-only into the data address space, so its contents are read in
+/// place from flash rather than copied into RAM
+class MappedPartition
+{
+public:
+  /// Map the data partition with the given label; bytes() is empty if it cannot be mapped
+  explicit MappedPartition(const char* label) noexcept;
+  ~MappedPartition() noexcept;
+
+  /// Copy/move constructor/assignment
+  MappedPartition(const MappedPartition&) = delete;
+  MappedPartition& operator=(const MappedPartition&) = delete;
+  MappedPartition(MappedPartition&&) = delete;
+  MappedPartition& operator=(MappedPartition&&) = delete;
+
+  std::span<const std::byte> bytes() const noexcept { return bytes_; }
+
+private:
+  esp_partition_mmap_handle_t handle_{};
+  std::span<const std::byte> bytes_{};
+};
+} // namespace luz::library
+
+namespace luz::upload
+{
+/// A data partition written through the flash driver and read through a mapping, which the
+/// driver keeps coherent with every erase and write
+class FlashPartition
+{
+public:
+  /// Find and map the data partition with the given label; bytes() is empty and every erase or
+  /// write fails if it cannot be mapped
+  explicit FlashPartition(const char* label) noexcept;
+  ~FlashPartition() noexcept = default;
+
+  /// Copy/move constructor/assignment
+  FlashPartition(const FlashPartition&) = delete;
+  FlashPartition& operator=(const FlashPartition&) = delete;
+  FlashPartition(FlashPartition&&) = delete;
+  FlashPartition& operator=(FlashPartition&&) = delete;
+
+  std::span<const std::byte> bytes() const noexcept { return mapped_.bytes(); }
+
+  bool erase(size_t offset, size_t size) noexcept;
+  bool write(size_t offset, std::span<const std::byte> bytes) noexcept;
+
+private:
+  const esp_partition_t* partition_{};
+  library::MappedPartition mapped_;
+};
+} // namespace luz::upload
@@ -0,0 +1,42 @@
+#include "playlist.hh"
+
+namespace luz::library
+{
+Playlist::Playlist(const Library& library) noexcept : library_{ library } {}
+
+void Playlist::start(uint32_t now_ms) noexcept
+{
+  if (library_.empty())
+  {
+    return;
+  }
+  playing_ = true;
+  pending_ = true;
+  shown_ms_ = now_ms;
+}
+
+std::optional<size_t> Playlist::poll(uint32_t now_ms) noexcept
+{
+  if (!playing_)
+  {
+    return std::nullopt;
+  }
+
+  if (pending_)
+  {
+    pending_ = false;
+    shown_ms_ = now_ms;
+    return current_;
+  }
+
+  const uint32_t dwell_ms = library_.entry(current_).dwell_s * 1000U;
+  if (now_ms - shown_ms_ < dwell_ms)
+  {
+    return std::nullopt;
+  }
+
+  current_ = (current_ + 1UL) % library_.size();
+  shown_ms_ = now_ms;
+  return current_;
+}
+} // namespace luz::library
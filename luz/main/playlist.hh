@@ -0,0 +1,40 @@
+#pragma once
+
+#include "library.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace luz::library
+{
+/// Cycles through the climbs of a library, showing each for its dwell time
+class Playlist
+{
+public:
+  explicit Playlist(const Library& library) noexcept;
+  ~Playlist() noexcept = default;
+
+  /// Copy/move constructor/assignment
+  Playlist(const Playlist&) = delete;
+  Playlist& operator=(const Playlist&) = delete;
+  Playlist(Playlist&&) = delete;
+  Playlist& operator=(Playlist&&) = delete;
+
+  /// Start or resume playing, showing the next climb at the following poll
+  void start(uint32_t now_ms) noexcept;
+  void stop() noexcept { playing_ = false; }
+  bool playing() const noexcept { return playing_; }
+
+  /// Advance the playlist to now_ms
+  /// @return The index of the climb to show if it has changed since the last poll
+  std::optional<size_t> poll(uint32_t now_ms) noexcept;
+
+private:
+  const Library& library_;
+  bool playing_{};
+  bool pending_{};
+  size_t current_{};
+  uint32_t shown_ms_{};
+};
+} // namespace luz::library
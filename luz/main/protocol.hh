@@ -1,24 +1,18 @@
 #pragma once
 
 #include "buffer.hh"
+#include "decoder.hh"
 #include "packet.hh"
 
 #include <array>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
-#include <list>
 #include <memory_resource>
 #include <span>
-#include <vector>
 
 namespace luz::protocol
 {
-namespace detail
-{
-static constexpr size_t max_placements_per_climb = 35UL;
-} // namespace detail
-
 class Protocol
 {
 public:
@@ -34,11 +28,24 @@ public:
   /// Process an incoming payload and attempt to extract a complete set of placements
   /// @param bytes The incoming byte payload
   /// @param[out] placements The set of placements if parsing the incoming payload completes the
-  /// set
+  /// set. The placements are reserved to max_placements_per_packet, so supplying a vector backed
+  /// by a memory resource of at least that capacity avoids any heap allocation.
   /// @return Boolean indicating if the set of placements is valid
   bool process(std::span<const std::byte> bytes, Packet& packet) noexcept;
 
+  /// The status of each frame completed or rejected by the most recent call to process(), oldest
+  /// first. Frames still waiting for further bytes are not included.
+  std::span<const ProtocolStatus> statuses() const noexcept;
+
+  /// Decode the placements received so far of a frame still waiting for further bytes
+  /// @param[out] packet The provisional placements, valid only if true is returned
+  /// @return Whether a frame is partially received and holds at least one placement
+  bool provisional(Packet& packet) const noexcept;
+
 private:
   BufferList buffer_list_{};
+  /// Each pass over the buffers either completes a frame or rejects the oldest buffer
+  std::array<ProtocolStatus, BufferList::max_buffers + 1UL> statuses_{};
+  size_t num_statuses_{};
 };
 } // namespace luz::protocol
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "layout.hh"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+/// Fragments written by the client are handed from the NimBLE host task to the decode task
+/// through a bounded queue, so the BLE stack acknowledges a write, or accepts the next write
+/// without response, without waiting for it to be decoded. A write with response is only
+/// acknowledged once queued, so it is never dropped.
+///
+/// Writes without response are not flow controlled by ATT, so the queue grants the client credits
+/// instead: the client counts the fragments it sends, and may only send while its count is below
+/// the limit last reported, which advances as the decode task drains the queue. The counts are
+/// 16 bit and wrap around.
+namespace luz::receive
+{
+/// Largest value of an attribute, and so of a single write
+constexpr size_t max_fragment_size = 512UL;
+
+/// Reported to the client whenever credits are granted, and readable at any time
+struct Credit
+{
+  /// Number of fragments accepted into the queue; once the client has stopped sending, fewer
+  /// than it sent means fragments were dropped because it exceeded its credit
+  uint16_t received{};
+  /// Number of fragments the client may have sent in total
+  uint16_t limit{};
+
+  friend constexpr bool operator==(const Credit& lhs, const Credit& rhs) = default;
+};
+
+using CreditLayout
+    = layout::Layout<Credit, layout::Bind<&Credit::received>, layout::Bind<&Credit::limit>>;
+
+/// Lock-free queue of fragments between a single producer, the NimBLE host task, and a single
+/// consumer, the decode task. Fragments are copied into fixed slots, so it never allocates.
+template <size_t Depth, size_t MaxSize = max_fragment_size> class ReceiveQueue
+{
+public:
+  static_assert(std::has_single_bit(Depth), "The depth must be a power of two");
+
+  constexpr ReceiveQueue() noexcept = default;
+  ~ReceiveQueue() noexcept = default;
+
+  /// Copy/move constructor/assignment
+  ReceiveQueue(const ReceiveQueue&) = delete;
+  ReceiveQueue& operator=(const ReceiveQueue&) = delete;
+  ReceiveQueue(ReceiveQueue&&) = delete;
+  ReceiveQueue& operator=(ReceiveQueue&&) = delete;
+
+  static constexpr size_t capacity() noexcept { return Depth; }
+
+  /// Producer: copy a fragment to the back of the queue
+  /// @return false, dropping the fragment, if the queue is full or the fragment too large
+  bool try_push(std::span<const std::byte> fragment) noexcept;
+
+  /// Consumer: the fragment at the front of the queue, valid until it is popped
+  std::optional<std::span<const std::byte>> front() const noexcept;
+  /// Consumer: release the fragment at the front of the queue, granting the client a credit
+  /// @pre front() holds a fragment
+  void pop() noexcept;
+  bool empty() const noexcept { return size() == 0UL; }
+  bool full() const noexcept { return size() == Depth; }
+  size_t size() const noexcept;
+
+  /// Number of fragments dropped because the queue was full or they were too large
+  uint32_t overruns() const noexcept { return overruns_.load(std::memory_order_relaxed); }
+
+  /// The credit granted so far
+  Credit credit() const noexcept;
+  /// Consumer: the credit to report to the client, if enough has been granted since the last
+  /// report. Credit is reported once half of the queue has been drained, so the client need not
+  /// stall, or once the queue is empty, so that none is held back.
+  std::optional<Credit> poll_credit() noexcept;
+
+private:
+  struct Slot
+  {
+    uint16_t size{};
+    std::array<std::byte, MaxSize> bytes{};
+  };
+
+  std::array<Slot, Depth> slots_{};
+  /// Number of fragments pushed; only written by the producer
+  std::atomic<uint32_t> tail_{};
+  /// Number of fragments popped; only written by the consumer
+  std::atomic<uint32_t> head_{};
+  std::atomic<uint32_t> overruns_{};
+  /// Limit of the credit last reported; only accessed by the consumer
+  uint16_t reported_limit_{ static_cast<uint16_t>(Depth) };
+};
+} // namespace luz::receive
+
+#include "receive.inl"
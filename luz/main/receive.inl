@@ -0,0 +1,69 @@
+#pragma once
+
+#include "receive.hh"
+
+#include <algorithm>
+
+namespace luz::receive
+{
+template <size_t Depth, size_t MaxSize>
+bool ReceiveQueue<Depth, MaxSize>::try_push(std::span<const std::byte> fragment) noexcept
+{
+  const auto tail = tail_.load(std::memory_order_relaxed);
+  if (fragment.size() > MaxSize || tail - head_.load(std::memory_order_acquire) == Depth)
+  {
+    overruns_.fetch_add(1U, std::memory_order_relaxed);
+    return false;
+  }
+
+  auto& slot = slots_[tail % Depth];
+  slot.size = static_cast<uint16_t>(fragment.size());
+  std::ranges::copy(fragment, slot.bytes.begin());
+  // Publish the slot to the consumer
+  tail_.store(tail + 1U, std::memory_order_release);
+  return true;
+}
+
+template <size_t Depth, size_t MaxSize>
+std::optional<std::span<const std::byte>> ReceiveQueue<Depth, MaxSize>::front() const noexcept
+{
+  const auto head = head_.load(std::memory_order_relaxed);
+  if (head == tail_.load(std::memory_order_acquire))
+  {
+    return std::nullopt;
+  }
+  const auto& slot = slots_[head % Depth];
+  return std::span{ slot.bytes }.first(slot.size);
+}
+
+template <size_t Depth, size_t MaxSize> void ReceiveQueue<Depth, MaxSize>::pop() noexcept
+{
+  // Hand the slot back to the producer
+  head_.store(head_.load(std::memory_order_relaxed) + 1U, std::memory_order_release);
+}
+
+template <size_t Depth, size_t MaxSize> size_t ReceiveQueue<Depth, MaxSize>::size() const noexcept
+{
+  return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+}
+
+template <size_t Depth, size_t MaxSize>
+Credit ReceiveQueue<Depth, MaxSize>::credit() const noexcept
+{
+  return Credit{ .received = static_cast<uint16_t>(tail_.load(std::memory_order_acquire)),
+                 .limit = static_cast<uint16_t>(head_.load(std::memory_order_acquire) + Depth) };
+}
+
+template <size_t Depth, size_t MaxSize>
+std::optional<Credit> ReceiveQueue<Depth, MaxSize>::poll_credit() noexcept
+{
+  const auto credit = this->credit();
+  const auto granted = static_cast<uint16_t>(credit.limit - reported_limit_);
+  if (granted == 0U || (granted < (Depth + 1UL) / 2UL && !empty()))
+  {
+    return std::nullopt;
+  }
+  reported_limit_ = credit.limit;
+  return credit;
+}
+} // namespace luz::receive
@@ -0,0 +1,148 @@
+#include "render.hh"
+
+namespace luz::render
+{
+void ClimbLayer::show(const IndexedFrame& frame, uint32_t now_ms) noexcept
+{
+  // Start from whatever is currently drawn so that interrupting a crossfade does not jump
+  apply(from_, now_ms);
+  to_ = frame;
+  shown_at_ms_ = now_ms;
+  provisional_ = false;
+}
+
+void ClimbLayer::show_provisional(const IndexedFrame& frame, uint32_t now_ms) noexcept
+{
+  if (!provisional_)
+  {
+    committed_ = to_;
+    provisional_ = true;
+  }
+  expand(frame, from_);
+  to_ = frame;
+  shown_at_ms_ = now_ms;
+}
+
+void ClimbLayer::rollback(uint32_t now_ms) noexcept
+{
+  if (!provisional_)
+  {
+    return;
+  }
+  expand(committed_, from_);
+  to_ = committed_;
+  shown_at_ms_ = now_ms;
+  provisional_ = false;
+}
+
+uint16_t ClimbLayer::progress(uint32_t now_ms) const noexcept
+{
+  const uint32_t elapsed = now_ms - shown_at_ms_;
+  if (elapsed >= crossfade_ms)
+  {
+    return 256U;
+  }
+  return static_cast<uint16_t>((elapsed << 8) / crossfade_ms);
+}
+
+void ClimbLayer::apply(Frame& frame, uint32_t now_ms) const noexcept
+{
+  const auto t = progress(now_ms);
+  if (t >= 256U)
+  {
+    expand(to_, frame);
+    return;
+  }
+
+  for (size_t pxl = 0UL; pxl < frame.size(); ++pxl)
+  {
+    frame[pxl] = lerp(from_[pxl], palette[to_[pxl]], t);
+  }
+}
+
+bool ClimbLayer::animating(uint32_t now_ms) const noexcept { return progress(now_ms) < 256U; }
+
+void PulseLayer::show(const IndexedFrame& frame, uint32_t now_ms) noexcept
+{
+  static constexpr auto start_index = palette_index(start_color);
+  static constexpr auto finish_index = palette_index(finish_color);
+  static_assert(palette[start_index] == start_color && palette[finish_index] == finish_color);
+
+  num_pixels_ = 0UL;
+  shown_at_ms_ = now_ms;
+  for (size_t pxl = 0UL; pxl < frame.size() && num_pixels_ < pixels_.size(); ++pxl)
+  {
+    if (frame[pxl] == start_index || frame[pxl] == finish_index)
+    {
+      pixels_[num_pixels_++] = static_cast<uint16_t>(pxl);
+    }
+  }
+}
+
+void PulseLayer::apply(Frame& frame, uint32_t now_ms) const noexcept
+{
+  const uint32_t phase = (((now_ms - shown_at_ms_) % period_ms) << 8) / period_ms;
+  const uint8_t level = table[phase];
+  for (size_t i = 0UL; i < num_pixels_; ++i)
+  {
+    frame[pixels_[i]] = scale(frame[pixels_[i]], level);
+  }
+}
+
+bool PulseLayer::animating(uint32_t) const noexcept { return num_pixels_ > 0UL; }
+
+void ConnectionOverlay::flash(bool connected, uint32_t now_ms) noexcept
+{
+  color_ = connected ? connected_color : disconnected_color;
+  flashed_at_ms_ = now_ms;
+}
+
+bool ConnectionOverlay::active(uint32_t now_ms) const noexcept
+{
+  return flashed_at_ms_ && (now_ms - *flashed_at_ms_) < duration_ms;
+}
+
+void ConnectionOverlay::apply(Frame& frame, uint32_t now_ms) const noexcept
+{
+  if (!active(now_ms))
+  {
+    return;
+  }
+
+  // Triangle from 0 up to 256 half way through and back down again
+  const uint32_t elapsed = now_ms - *flashed_at_ms_;
+  const uint32_t half = duration_ms / 2U;
+  const auto t = static_cast<uint16_t>(((elapsed < half ? elapsed : duration_ms - elapsed) << 8)
+                                       / half);
+  for (size_t pxl = first_pixel; pxl < frame.size(); pxl += pixel_stride)
+  {
+    frame[pxl] = lerp(frame[pxl], color_, t);
+  }
+}
+
+void ErrorOverlay::trigger(uint32_t now_ms) noexcept { triggered_at_ms_ = now_ms; }
+
+bool ErrorOverlay::active(uint32_t now_ms) const noexcept
+{
+  // Unsigned subtraction keeps the comparison correct across wrap-around of the clock
+  return triggered_at_ms_ && (now_ms - *triggered_at_ms_) < duration_ms;
+}
+
+void ErrorOverlay::apply(Frame& frame, uint32_t now_ms) const noexcept
+{
+  if (!active(now_ms))
+  {
+    return;
+  }
+
+  if (((now_ms - *triggered_at_ms_) % blink_period_ms) >= (blink_period_ms / 2U))
+  {
+    return;
+  }
+
+  for (size_t pxl = 0UL; pxl < frame.size(); pxl += pixel_stride)
+  {
+    frame[pxl] = color;
+  }
+}
+} // namespace luz::render
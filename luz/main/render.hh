@@ -0,0 +1,231 @@
+#pragma once
+
+#include "color.hh"
+#include "database.hh"
+#include "palette.hh"
+#include "trace.hh"
+
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <optional>
+#include <tuple>
+
+namespace luz::render
+{
+/// A complete set of pixel colors indexed by pixel
+using Frame = std::array<Color, database::num_leds>;
+
+/// Scale each channel of a color by the fixed-point fraction (level + 1) / 256
+constexpr Color scale(Color color, uint8_t level) noexcept
+{
+  const uint16_t factor = uint16_t{ level } + 1U;
+  return Color{ static_cast<uint8_t>((color.r * factor) >> 8),
+                static_cast<uint8_t>((color.g * factor) >> 8),
+                static_cast<uint8_t>((color.b * factor) >> 8) };
+}
+
+/// Linearly interpolate between two colors where t is the fixed-point fraction t / 256
+constexpr Color lerp(Color from, Color to, uint16_t t) noexcept
+{
+  const auto channel = [t](uint8_t a, uint8_t b) {
+    return static_cast<uint8_t>(a + (((static_cast<int32_t>(b) - a) * t) >> 8));
+  };
+  return Color{ channel(from.r, to.r), channel(from.g, to.g), channel(from.b, to.b) };
+}
+
+namespace detail
+{
+/// Brightness table for one period of a pulse; a smoothstep-eased triangle wave from min_level up
+/// to full brightness and back down again
+constexpr std::array<uint8_t, 256> make_pulse_table(uint8_t min_level) noexcept
+{
+  std::array<uint8_t, 256> table{};
+  for (uint32_t phase = 0U; phase < table.size(); ++phase)
+  {
+    // Triangle wave in [0, 255]
+    const uint32_t x = (phase < 128U ? phase : 255U - phase) * 2U + 1U;
+    // Smoothstep 3x^2 - 2x^3 in [0, 255^3]
+    const uint32_t eased = (3U * 255U - 2U * x) * x * x;
+    const uint32_t level = eased / (255U * 255U);
+    table[phase] = static_cast<uint8_t>(min_level + level * (255U - min_level) / 255U);
+  }
+  return table;
+}
+} // namespace detail
+
+/// Requirements of a single layer in a render Pipeline
+template <typename T>
+concept Layer = requires(const T& layer, Frame& frame, uint32_t now_ms) {
+  { layer.apply(frame, now_ms) } -> std::same_as<void>;
+  { layer.animating(now_ms) } -> std::same_as<bool>;
+};
+
+/// Base layer drawing the current climb, crossfading from the previously shown climb
+class ClimbLayer
+{
+public:
+  /// Duration of the crossfade between consecutive climbs
+  static constexpr uint32_t crossfade_ms = 250U;
+
+  ClimbLayer() noexcept = default;
+  ~ClimbLayer() noexcept = default;
+
+  /// Begin a crossfade from what is currently drawn at time now_ms towards the given frame,
+  /// committing any provisional frame
+  void show(const IndexedFrame& frame, uint32_t now_ms) noexcept;
+
+  /// Draw a partially received climb at once; it is replaced when the complete climb is shown, or
+  /// undone by rollback() if the climb is rejected
+  void show_provisional(const IndexedFrame& frame, uint32_t now_ms) noexcept;
+
+  /// Return at once to the last climb shown before any provisional frame
+  void rollback(uint32_t now_ms) noexcept;
+
+  bool provisional() const noexcept { return provisional_; }
+
+  void apply(Frame& frame, uint32_t now_ms) const noexcept;
+  bool animating(uint32_t now_ms) const noexcept;
+
+  /// The frame being faded to, i.e. the most recently shown climb
+  const IndexedFrame& target() const noexcept { return to_; }
+
+private:
+  /// Fixed-point crossfade progress in [0, 256]
+  uint16_t progress(uint32_t now_ms) const noexcept;
+
+  /// What was drawn when the crossfade began, which may be part way through another crossfade
+  Frame from_{};
+  IndexedFrame to_{};
+  uint32_t shown_at_ms_{};
+  /// The last climb shown, held while a provisional frame is drawn
+  IndexedFrame committed_{};
+  bool provisional_{};
+};
+
+/// Layer pulsing the brightness of the start and finish holds of the current climb
+class PulseLayer
+{
+public:
+  /// Period of a single pulse
+  static constexpr uint32_t period_ms = 1500U;
+  /// Holds are pulsed between this level and full brightness
+  static constexpr uint8_t min_level = 64U;
+  /// Expanded 3-3-2 colors used by the Aurora apps for start and finish holds
+  static constexpr auto start_color = Color(0U, 224U, 0U);
+  static constexpr auto finish_color = Color(224U, 0U, 192U);
+  /// Maximum number of holds which are pulsed; any further start/finish holds are drawn steady
+  static constexpr size_t max_pulsed = 16UL;
+
+  PulseLayer() noexcept = default;
+  ~PulseLayer() noexcept = default;
+
+  /// Select the pixels to be pulsed from the given climb
+  void show(const IndexedFrame& frame, uint32_t now_ms) noexcept;
+
+  void apply(Frame& frame, uint32_t now_ms) const noexcept;
+  bool animating(uint32_t now_ms) const noexcept;
+
+private:
+  static constexpr auto table = detail::make_pulse_table(min_level);
+
+  std::array<uint16_t, max_pulsed> pixels_{};
+  size_t num_pixels_{};
+  uint32_t shown_at_ms_{};
+};
+
+/// Overlay flashing every tenth pixel to indicate an error (e.g. an invalid placement position).
+/// The overlay is time-sliced: it holds no timers of its own and is applied to each frame rendered
+/// while it is active, so indicating an error never blocks the caller.
+class ErrorOverlay
+{
+public:
+  /// Period of a single on/off blink
+  static constexpr uint32_t blink_period_ms = 200U;
+  /// Total time the overlay remains active after the most recent trigger
+  static constexpr uint32_t duration_ms = 2000U;
+  /// Every n-th pixel is lit by the overlay
+  static constexpr uint16_t pixel_stride = 10U;
+  /// Color of the lit overlay pixels
+  static constexpr auto color = Color(0U, 255U, 0U);
+
+  ErrorOverlay() noexcept = default;
+  ~ErrorOverlay() noexcept = default;
+
+  /// (Re)start the overlay
+  /// @param now_ms The current time in milliseconds
+  void trigger(uint32_t now_ms) noexcept;
+
+  /// Whether the overlay is still to be applied at time now_ms
+  bool active(uint32_t now_ms) const noexcept;
+
+  /// Draw the overlay on top of the frame if it is active and in the "on" half of a blink
+  void apply(Frame& frame, uint32_t now_ms) const noexcept;
+  bool animating(uint32_t now_ms) const noexcept { return active(now_ms); }
+
+private:
+  std::optional<uint32_t> triggered_at_ms_{};
+};
+
+/// Layer briefly glowing every n-th pixel when a client connects or disconnects
+class ConnectionOverlay
+{
+public:
+  /// Time taken to fade the glow in and back out
+  static constexpr uint32_t duration_ms = 600U;
+  /// Every n-th pixel, starting from first_pixel, glows; interleaved with the ErrorOverlay pixels
+  static constexpr uint16_t pixel_stride = 10U;
+  static constexpr uint16_t first_pixel = 5U;
+  static constexpr auto connected_color = Color(0U, 0U, 255U);
+  static constexpr auto disconnected_color = Color(255U, 96U, 0U);
+
+  ConnectionOverlay() noexcept = default;
+  ~ConnectionOverlay() noexcept = default;
+
+  /// (Re)start the glow in the color of the new connection state
+  void flash(bool connected, uint32_t now_ms) noexcept;
+
+  /// Whether the overlay is still to be applied at time now_ms
+  bool active(uint32_t now_ms) const noexcept;
+
+  void apply(Frame& frame, uint32_t now_ms) const noexcept;
+  bool animating(uint32_t now_ms) const noexcept { return active(now_ms); }
+
+private:
+  Color color_{};
+  std::optional<uint32_t> flashed_at_ms_{};
+};
+
+/// An ordered stack of layers composed into a single frame; the first layer is the base layer and
+/// is expected to draw every pixel
+template <Layer... Layers> class Pipeline
+{
+public:
+  Pipeline() noexcept = default;
+  ~Pipeline() noexcept = default;
+
+  /// Copy/move constructor/assignment
+  Pipeline(const Pipeline&) = delete;
+  Pipeline& operator=(const Pipeline&) = delete;
+  Pipeline(Pipeline&&) = delete;
+  Pipeline& operator=(Pipeline&&) = delete;
+
+  /// Access an individual layer, e.g. to forward an event to it
+  template <Layer L> L& layer() noexcept;
+
+  /// Compose the frame at time now_ms by applying each layer in order
+  void compose(Frame& frame, uint32_t now_ms) const noexcept;
+
+  /// Whether any layer changes over time, i.e. whether the frame must be re-composed even if no
+  /// new events have occurred
+  bool animating(uint32_t now_ms) const noexcept;
+
+private:
+  std::tuple<Layers...> layers_{};
+};
+
+/// The default pipeline of the luz application
+using DefaultPipeline = Pipeline<ClimbLayer, PulseLayer, ConnectionOverlay, ErrorOverlay>;
+} // namespace luz::render
+
+#include "render.inl"
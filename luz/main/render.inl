@@ -0,0 +1,27 @@
+#pragma once
+
+#include "render.hh"
+
+namespace luz::render
+{
+template <Layer... Layers>
+template <Layer L>
+L& Pipeline<Layers...>::layer() noexcept
+{
+  return std::get<L>(layers_);
+}
+
+template <Layer... Layers>
+void Pipeline<Layers...>::compose(Frame& frame, uint32_t now_ms) const noexcept
+{
+  LUZ_TRACE_SCOPE(scope, "Pipeline::compose");
+  std::apply([&frame, now_ms](const auto&... layers) { (layers.apply(frame, now_ms), ...); },
+             layers_);
+}
+
+template <Layer... Layers> bool Pipeline<Layers...>::animating(uint32_t now_ms) const noexcept
+{
+  return std::apply([now_ms](const auto&... layers) { return (layers.animating(now_ms) || ...); },
+                    layers_);
+}
+} // namespace luz::render
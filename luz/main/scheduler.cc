@@ -0,0 +1,37 @@
+#include "scheduler.hh"
+
+#include <cassert>
+
+namespace luz::render
+{
+FrameScheduler::FrameScheduler(uint32_t frame_rate_hz) noexcept
+    : period_us_{ 1'000'000U / frame_rate_hz }
+{
+  assert(frame_rate_hz > 0U);
+}
+
+void FrameScheduler::start(uint64_t now_us) noexcept { release_us_ = now_us; }
+
+uint64_t FrameScheduler::wait_us(uint64_t now_us) const noexcept
+{
+  return now_us < release_us_ ? release_us_ - now_us : 0U;
+}
+
+void FrameScheduler::complete(uint64_t now_us) noexcept
+{
+  ++frames_;
+  release_us_ = deadline_us();
+  if (now_us <= release_us_)
+  {
+    return;
+  }
+
+  ++missed_deadlines_;
+
+  // The next frame can still meet its deadline if it is released immediately, but any whole
+  // periods already elapsed are lost
+  const auto overrun_periods = (now_us - release_us_) / period_us_;
+  dropped_frames_ += static_cast<uint32_t>(overrun_periods);
+  release_us_ += overrun_periods * period_us_;
+}
+} // namespace luz::render
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+namespace luz::render
+{
+/// Deadline-aware scheduler releasing frames at a fixed rate.
+/// Each frame is released at the start of its period and must be complete by the start of the
+/// next. Late frames are counted as missed deadlines; if a frame overruns by whole periods the
+/// overrun periods are dropped rather than rendered back to back, keeping the output phase-locked
+/// to the frame clock.
+class FrameScheduler
+{
+public:
+  explicit FrameScheduler(uint32_t frame_rate_hz) noexcept;
+  ~FrameScheduler() noexcept = default;
+
+  /// Begin the schedule, releasing the first frame at now_us
+  void start(uint64_t now_us) noexcept;
+
+  /// Time until the current frame is released, or zero if it has already been released
+  uint64_t wait_us(uint64_t now_us) const noexcept;
+
+  /// The time by which the current frame must be complete
+  uint64_t deadline_us() const noexcept { return release_us_ + period_us_; }
+
+  /// Record the completion of the current frame at now_us and advance to the next frame
+  void complete(uint64_t now_us) noexcept;
+
+  uint64_t period_us() const noexcept { return period_us_; }
+  /// Number of frames completed
+  uint32_t frames() const noexcept { return frames_; }
+  /// Number of frames completed after their deadline
+  uint32_t missed_deadlines() const noexcept { return missed_deadlines_; }
+  /// Number of frame periods skipped to recover from overruns
+  uint32_t dropped_frames() const noexcept { return dropped_frames_; }
+
+private:
+  uint64_t period_us_;
+  uint64_t release_us_{};
+  uint32_t frames_{};
+  uint32_t missed_deadlines_{};
+  uint32_t dropped_frames_{};
+};
+} // namespace luz::render
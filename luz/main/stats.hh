@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace luz
+{
+/// Runtime counters shared between the BLE and render tasks
+struct Stats
+{
+  /// Number of complete packets decoded by the protocol
+  std::atomic<uint32_t> packets_decoded{};
+  /// Number of decoded packets containing at least one invalid placement
+  std::atomic<uint32_t> packets_with_errors{};
+  /// Number of placements skipped because their position has no pixel on this board
+  std::atomic<uint32_t> invalid_placements{};
+  /// Number of writes dropped because the client sent more than its credit allowed
+  std::atomic<uint32_t> receive_overruns{};
+  /// Number of frames submitted to the LED strip
+  std::atomic<uint32_t> frames_rendered{};
+  /// Number of frames completed after their deadline
+  std::atomic<uint32_t> missed_deadlines{};
+  /// Number of frames scaled down to keep within the LED current budget
+  std::atomic<uint32_t> current_limited_frames{};
+  /// Number of frame periods skipped to recover from overruns
+  std::atomic<uint32_t> dropped_frames{};
+  /// Number of frames sent down the chain of boards by a primary, or latched by a secondary
+  std::atomic<uint32_t> fanout_frames{};
+  /// Number of frames a primary could not send down the chain, or packets a secondary discarded
+  /// as corrupt or out of sequence
+  std::atomic<uint32_t> fanout_errors{};
+  /// Number of heap allocations made after boot completed; see luz::heap
+  std::atomic<uint32_t> allocations_after_boot{};
+};
+} // namespace luz
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "decoder.hh"
+#include "layout.hh"
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace luz::protocol
+{
+/// Outcome of a single frame completed or rejected by the Protocol, as reported to clients
+struct FrameStatus
+{
+  /// Incremented for each report, so clients can detect missed notifications
+  uint16_t sequence{};
+  ProtocolStatus status{};
+  /// Time taken to decode the write which completed or rejected the frame
+  uint16_t decode_us{};
+  /// Time taken to hand the decoded frame to the renderer; zero for rejected frames
+  uint16_t render_us{};
+
+  friend constexpr bool operator==(const FrameStatus& lhs, const FrameStatus& rhs) = default;
+};
+
+namespace codec
+{
+struct ProtocolStatus
+{
+  static constexpr protocol::ProtocolStatus decode(uint8_t raw) noexcept
+  {
+    return static_cast<protocol::ProtocolStatus>(raw);
+  }
+  static constexpr uint8_t encode(protocol::ProtocolStatus value) noexcept
+  {
+    return static_cast<uint8_t>(value);
+  }
+  static constexpr bool valid(uint8_t raw) noexcept
+  {
+    return raw <= static_cast<uint8_t>(protocol::ProtocolStatus::bad_checksum);
+  }
+};
+} // namespace codec
+
+/// Wire layout of a FrameStatus notification
+using FrameStatusLayout
+    = layout::Layout<FrameStatus,
+                     layout::Bind<&FrameStatus::sequence>,
+                     layout::Bind<&FrameStatus::status, uint8_t, codec::ProtocolStatus>,
+                     layout::Bind<&FrameStatus::decode_us>,
+                     layout::Bind<&FrameStatus::render_us>>;
+
+/// Transport over which encoded status records are pushed to the client
+template <typename T>
+concept StatusSink = requires(T& sink, std::span<const std::byte> bytes) { sink.notify(bytes); };
+
+/// Encodes and sends a FrameStatus for every frame completed or rejected
+template <StatusSink Sink> class StatusReporter
+{
+public:
+  StatusReporter() noexcept = default;
+  ~StatusReporter() noexcept = default;
+
+  /// Copy/move constructor/assignment
+  StatusReporter(const StatusReporter&) = delete;
+  StatusReporter& operator=(const StatusReporter&) = delete;
+  StatusReporter(StatusReporter&&) = delete;
+  StatusReporter& operator=(StatusReporter&&) = delete;
+
+  /// Send reports to sink; until attached, reports are only counted
+  void attach(Sink& sink) noexcept { sink_ = &sink; }
+
+  void report(ProtocolStatus status, uint32_t decode_us, uint32_t render_us) noexcept
+  {
+    const auto record = FrameStatus{ .sequence = sequence_++,
+                                     .status = status,
+                                     .decode_us = saturate(decode_us),
+                                     .render_us = saturate(render_us) };
+    if (sink_ == nullptr)
+    {
+      return;
+    }
+
+    std::array<std::byte, FrameStatusLayout::size> bytes{};
+    FrameStatusLayout::encode(record, bytes);
+    sink_->notify(bytes);
+  }
+
+private:
+  static constexpr uint16_t saturate(uint32_t value) noexcept
+  {
+    return static_cast<uint16_t>(std::min<uint32_t>(value, UINT16_MAX));
+  }
+
+  Sink* sink_{};
+  uint16_t sequence_{};
+};
+} // namespace luz::protocol
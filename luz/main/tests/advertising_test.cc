@@ -0,0 +1,132 @@
+#include "advertising.hh"
+
+#include <cstdint>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace luz::ble::test
+{
+/// Records the interval of each advertisement started
+struct MockAdvertiser
+{
+  void start(uint16_t interval)
+  {
+    REQUIRE_FALSE(running);
+    running = true;
+    intervals.push_back(interval);
+  }
+  void stop() { running = false; }
+
+  bool running{};
+  std::vector<uint16_t> intervals{};
+};
+
+TEST_CASE("advertising scheduler", "[advertising]")
+{
+  MockAdvertiser advertiser{};
+  std::vector<ConnectionState> states{};
+  auto scheduler = AdvertisingScheduler{
+    advertiser, [&states](ConnectionState state) { states.push_back(state); }
+  };
+  using Scheduler = decltype(scheduler);
+
+  // Virtual clock, starting close to wrap-around
+  uint32_t now = UINT32_MAX - 1'000U;
+  scheduler.start(now);
+  REQUIRE(scheduler.state() == ConnectionState::advertising_fast);
+  REQUIRE(advertiser.intervals == std::vector{ Scheduler::fast_interval });
+  REQUIRE(states == std::vector{ ConnectionState::advertising_fast });
+
+  SECTION("backs off after the burst")
+  {
+    now += Scheduler::burst_ms - 1U;
+    scheduler.update(now);
+    REQUIRE(scheduler.state() == ConnectionState::advertising_fast);
+
+    now += 1U;
+    scheduler.update(now);
+    REQUIRE(scheduler.state() == ConnectionState::advertising_slow);
+    REQUIRE(advertiser.running);
+    REQUIRE(advertiser.intervals.back() == Scheduler::slow_interval);
+
+    // Nothing changes until a client connects
+    now += 10U * Scheduler::burst_ms;
+    scheduler.update(now);
+    REQUIRE(advertiser.intervals.size() == 2UL);
+    REQUIRE(states.back() == ConnectionState::advertising_slow);
+  }
+
+  SECTION("bursts again after a disconnection")
+  {
+    now += 1'000U;
+    scheduler.connected(now);
+    REQUIRE(scheduler.state() == ConnectionState::connected);
+    REQUIRE(advertiser.intervals.back() == Scheduler::slow_interval);
+
+    // Repeated connection events from further clients do not restart the advertisement
+    scheduler.connected(now);
+    REQUIRE(advertiser.intervals.size() == 2UL);
+
+    now += 10U * Scheduler::burst_ms;
+    scheduler.update(now);
+    REQUIRE(scheduler.state() == ConnectionState::connected);
+
+    scheduler.disconnected(now);
+    REQUIRE(scheduler.state() == ConnectionState::advertising_fast);
+    REQUIRE(advertiser.intervals.back() == Scheduler::fast_interval);
+
+    now += Scheduler::burst_ms;
+    scheduler.update(now);
+    REQUIRE(scheduler.state() == ConnectionState::advertising_slow);
+    REQUIRE(states
+            == std::vector{ ConnectionState::advertising_fast,
+                            ConnectionState::connected,
+                            ConnectionState::advertising_fast,
+                            ConnectionState::advertising_slow });
+  }
+
+  SECTION("follows connections counted between updates")
+  {
+    now += Scheduler::burst_ms;
+    scheduler.update(now);
+    REQUIRE(scheduler.state() == ConnectionState::advertising_slow);
+
+    // A client connects and disconnects before the counts are next read
+    scheduler.follow(1U, 1U, now);
+    REQUIRE(scheduler.state() == ConnectionState::advertising_fast);
+    REQUIRE(advertiser.intervals.back() == Scheduler::fast_interval);
+    REQUIRE(states
+            == std::vector{ ConnectionState::advertising_fast,
+                            ConnectionState::advertising_slow,
+                            ConnectionState::advertising_fast });
+
+    // Nothing changes until the counts do
+    const auto num_intervals = advertiser.intervals.size();
+    scheduler.follow(1U, 1U, now);
+    REQUIRE(advertiser.intervals.size() == num_intervals);
+
+    // A disconnection during the burst restarts it without restarting the advertisement
+    now += Scheduler::burst_ms - 1U;
+    scheduler.follow(2U, 2U, now);
+    scheduler.update(now + 1U);
+    REQUIRE(scheduler.state() == ConnectionState::advertising_fast);
+    REQUIRE(advertiser.intervals.size() == num_intervals);
+  }
+
+  SECTION("stays connected while one of two clients leaves")
+  {
+    const auto num_states = states.size();
+    scheduler.follow(2U, 0U, now);
+    const auto num_intervals = advertiser.intervals.size();
+    scheduler.follow(2U, 1U, now);
+    REQUIRE(scheduler.state() == ConnectionState::connected);
+    REQUIRE(states.size() == num_states + 1UL);
+    REQUIRE(states.back() == ConnectionState::connected);
+    REQUIRE(advertiser.intervals.size() == num_intervals);
+
+    scheduler.follow(2U, 2U, now);
+    REQUIRE(scheduler.state() == ConnectionState::advertising_fast);
+  }
+}
+} // namespace luz::ble::test
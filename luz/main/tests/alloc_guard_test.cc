@@ -0,0 +1,81 @@
+#include "alloc_guard.hh"
+#include "protocol.hh"
+
+#include <array>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+static_assert(LUZ_HEAP_GUARD_ENABLED, "alloc_guard_test must be built with LUZ_HEAP_GUARD");
+
+namespace luz::heap::test
+{
+constexpr auto top_row_p1
+    = std::array{ std::byte{ 1 },   std::byte{ 52 },  std::byte{ 32 },  std::byte{ 2 },
+                  std::byte{ 84 },  std::byte{ 17 },  std::byte{ 0 },   std::byte{ 224 },
+                  std::byte{ 52 },  std::byte{ 0 },   std::byte{ 224 }, std::byte{ 87 },
+                  std::byte{ 0 },   std::byte{ 227 }, std::byte{ 122 }, std::byte{ 0 },
+                  std::byte{ 227 }, std::byte{ 157 }, std::byte{ 0 },   std::byte{ 227 } };
+constexpr auto top_row_p2
+    = std::array{ std::byte{ 192 }, std::byte{ 0 },   std::byte{ 227 }, std::byte{ 227 },
+                  std::byte{ 0 },   std::byte{ 227 }, std::byte{ 6 },   std::byte{ 1 },
+                  std::byte{ 227 }, std::byte{ 41 },  std::byte{ 1 },   std::byte{ 227 },
+                  std::byte{ 76 },  std::byte{ 1 },   std::byte{ 28 },  std::byte{ 111 },
+                  std::byte{ 1 },   std::byte{ 3 },   std::byte{ 146 }, std::byte{ 1 } };
+constexpr auto top_row_p3
+    = std::array{ std::byte{ 3 },   std::byte{ 181 }, std::byte{ 1 },  std::byte{ 3 },
+                  std::byte{ 216 }, std::byte{ 1 },   std::byte{ 3 },  std::byte{ 251 },
+                  std::byte{ 1 },   std::byte{ 227 }, std::byte{ 30 }, std::byte{ 2 },
+                  std::byte{ 227 }, std::byte{ 65 },  std::byte{ 2 },  std::byte{ 227 },
+                  std::byte{ 3 } };
+
+TEST_CASE("allocations after boot are counted", "[alloc_guard]")
+{
+  reset();
+  auto before_boot = std::make_unique<int>(0);
+  REQUIRE(allocations_after_boot() == 0U);
+
+  mark_boot_complete(Policy::count);
+  auto after_boot = std::make_unique<int>(0);
+  const auto allocations = allocations_after_boot();
+  const auto bytes = bytes_after_boot();
+  reset();
+
+  REQUIRE(before_boot != nullptr);
+  REQUIRE(after_boot != nullptr);
+  REQUIRE(allocations == 1U);
+  REQUIRE(bytes == sizeof(int));
+}
+
+TEST_CASE("decoding does not allocate after boot", "[alloc_guard]")
+{
+  reset();
+  auto protocol = std::make_unique<protocol::Protocol>();
+  alignas(Placement) std::array<std::byte, protocol::detail::max_placements_per_packet
+                                               * sizeof(Placement)> storage{};
+  auto resource = std::pmr::monotonic_buffer_resource{ storage.data(),
+                                                       storage.size(),
+                                                       std::pmr::null_memory_resource() };
+
+  mark_boot_complete(Policy::count);
+  bool decoded = false;
+  size_t num_placements = 0UL;
+  for (size_t i = 0UL; i < 100UL; ++i)
+  {
+    resource.release();
+    Packet packet{ .placements = std::pmr::vector<Placement>{ &resource } };
+    (void)protocol->process(top_row_p1, packet);
+    (void)protocol->process(top_row_p2, packet);
+    decoded = protocol->process(top_row_p3, packet);
+    num_placements = packet.placements.size();
+  }
+  const auto allocations = allocations_after_boot();
+  reset();
+
+  REQUIRE(decoded);
+  REQUIRE(num_placements == 17UL);
+  REQUIRE(allocations == 0U);
+}
+} // namespace luz::heap::test
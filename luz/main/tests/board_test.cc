@@ -0,0 +1,86 @@
+#include "board.hh"
+#include "database.hh"
+
+#include <algorithm>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace luz::board::test
+{
+TEST_CASE("grid coordinates follow the snaking hold positions", "[board]")
+{
+  STATIC_REQUIRE(num_columns == 33U);
+  STATIC_REQUIRE(num_rows == 35U);
+
+  STATIC_REQUIRE(position_to_grid(0U) == GridPoint{ 0U, 0U });
+  STATIC_REQUIRE(position_to_grid(17U) == GridPoint{ 0U, 34U });
+  STATIC_REQUIRE(position_to_grid(18U) == GridPoint{ 1U, 33U });
+  STATIC_REQUIRE(position_to_grid(34U) == GridPoint{ 1U, 1U });
+  STATIC_REQUIRE(position_to_grid(35U) == GridPoint{ 2U, 0U });
+  STATIC_REQUIRE(position_to_grid(577U) == GridPoint{ 32U, 34U });
+
+  for (uint16_t position = 0U; position < database::decoy::num_positions; ++position)
+  {
+    REQUIRE(grid_to_position(position_to_grid(position)) == position);
+  }
+  REQUIRE_FALSE(grid_to_position(GridPoint{ 0U, 1U }));
+  REQUIRE_FALSE(grid_to_position(GridPoint{ 33U, 0U }));
+}
+
+TEST_CASE("pixels map back to positions", "[board]")
+{
+  for (uint16_t position = 0U; position < database::decoy::num_positions; ++position)
+  {
+    uint16_t pixel{};
+    if (!database::placement_to_pixel(position, pixel))
+    {
+      continue;
+    }
+
+    const auto mapped = index.pixel_to_position(pixel);
+    REQUIRE(mapped);
+    // Only where two positions share a pixel may the reverse mapping differ
+    if (*mapped != position)
+    {
+      uint16_t shared{};
+      REQUIRE(database::placement_to_pixel(*mapped, shared));
+      REQUIRE(shared == pixel);
+    }
+    REQUIRE(index.pixel_to_grid(pixel) == position_to_grid(*mapped));
+  }
+
+  REQUIRE_FALSE(index.pixel_to_position(database::num_leds));
+}
+
+TEST_CASE("rows and columns partition the mapped pixels", "[board]")
+{
+  size_t row_total = 0UL;
+  for (uint8_t y = 0U; y < num_rows; ++y)
+  {
+    const auto row = index.row(y);
+    row_total += row.size();
+    REQUIRE(std::ranges::all_of(
+        row, [y](uint16_t pixel) { return index.pixel_to_grid(pixel)->y == y; }));
+    REQUIRE(std::ranges::is_sorted(
+        row, {}, [](uint16_t pixel) { return index.pixel_to_grid(pixel)->x; }));
+  }
+
+  size_t column_total = 0UL;
+  for (uint8_t x = 0U; x < num_columns; ++x)
+  {
+    const auto column = index.column(x);
+    column_total += column.size();
+    REQUIRE(std::ranges::all_of(
+        column, [x](uint16_t pixel) { return index.pixel_to_grid(pixel)->x == x; }));
+    REQUIRE(std::ranges::is_sorted(
+        column, {}, [](uint16_t pixel) { return index.pixel_to_grid(pixel)->y; }));
+  }
+
+  REQUIRE(row_total == index.num_mapped_pixels());
+  REQUIRE(column_total == index.num_mapped_pixels());
+
+  // The top row climb lights every full column along the top row
+  REQUIRE(index.row(num_rows - 1U).size() == 17UL);
+  REQUIRE(index.row(num_rows).empty());
+}
+} // namespace luz::board::test
@@ -0,0 +1,106 @@
+#include "composite.hh"
+#include "database.hh"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace luz::database::test
+{
+// A main board of six positions lit by four LEDs, and a kickboard of four positions lit by three
+// LEDs whose positions follow a gap in the position space
+constexpr auto main_lookup = std::array<int16_t, 6>{ 0, -1, 1, 3, 2, -1 };
+constexpr auto kick_lookup = std::array<int16_t, 4>{ 2, 1, -1, 0 };
+
+constexpr auto boards = std::array{
+  SubBoard{ .lookup = main_lookup, .num_leds = 4U, .first_position = 0U },
+  SubBoard{ .lookup = kick_lookup, .num_leds = 3U, .first_position = 10U },
+};
+
+constexpr auto layout
+    = CompositeLayout<position_space(boards), total_leds(boards)>::make(boards);
+
+constexpr std::optional<uint16_t> pixel_of(uint16_t position)
+{
+  uint16_t pixel{};
+  if (!layout.placement_to_pixel(position, pixel))
+  {
+    return std::nullopt;
+  }
+  return pixel;
+}
+
+TEST_CASE("sub-boards are chained into one pixel space", "[composite]")
+{
+  STATIC_REQUIRE(total_leds(boards) == 7U);
+  STATIC_REQUIRE(position_space(boards) == 14U);
+  STATIC_REQUIRE(disjoint(boards));
+  STATIC_REQUIRE(within_strips(boards));
+
+  // The main board keeps its pixels...
+  STATIC_REQUIRE(pixel_of(0U) == 0U);
+  STATIC_REQUIRE(pixel_of(3U) == 3U);
+  STATIC_REQUIRE_FALSE(pixel_of(1U));
+  // ... and the kickboard follows on from them
+  STATIC_REQUIRE(pixel_of(10U) == 6U);
+  STATIC_REQUIRE(pixel_of(13U) == 4U);
+  STATIC_REQUIRE_FALSE(pixel_of(12U));
+
+  // Positions between and beyond the boards light nothing
+  STATIC_REQUIRE_FALSE(pixel_of(6U));
+  STATIC_REQUIRE_FALSE(pixel_of(14U));
+  STATIC_REQUIRE_FALSE(pixel_of(UINT16_MAX));
+}
+
+TEST_CASE("overlapping sub-boards are detected", "[composite]")
+{
+  constexpr auto overlapping = std::array{
+    SubBoard{ .lookup = main_lookup, .num_leds = 4U, .first_position = 0U },
+    SubBoard{ .lookup = kick_lookup, .num_leds = 3U, .first_position = 5U },
+  };
+  STATIC_REQUIRE_FALSE(disjoint(overlapping));
+}
+
+TEST_CASE("pixels beyond the strip of their board are detected", "[composite]")
+{
+  // The kickboard has three LEDs, so its pixel 3 would light the first of the next board
+  static constexpr auto beyond_lookup = std::array<int16_t, 4>{ 2, 1, 3, 0 };
+  constexpr auto beyond = std::array{
+    SubBoard{ .lookup = main_lookup, .num_leds = 4U, .first_position = 0U },
+    SubBoard{ .lookup = beyond_lookup, .num_leds = 3U, .first_position = 10U },
+  };
+  STATIC_REQUIRE(disjoint(beyond));
+  STATIC_REQUIRE_FALSE(within_strips(beyond));
+}
+
+TEST_CASE("a climb across both boards lights one frame", "[composite]")
+{
+  constexpr auto positions = std::array<uint16_t, 4>{ 0U, 4U, 11U, 13U };
+  std::array<bool, total_leds(boards)> lit{};
+  for (const auto position : positions)
+  {
+    const auto pixel = pixel_of(position);
+    REQUIRE(pixel);
+    lit[*pixel] = true;
+  }
+  REQUIRE(lit == std::array{ true, false, true, false, true, true, false });
+}
+
+TEST_CASE("the firmware layout flattens the Decoy board", "[composite]")
+{
+  STATIC_REQUIRE(num_leds == decoy::num_leds);
+  STATIC_REQUIRE(num_positions == decoy::num_positions);
+  for (uint16_t position = 0U; position < decoy::num_positions; ++position)
+  {
+    uint16_t pixel{};
+    const bool mapped = placement_to_pixel(position, pixel);
+    REQUIRE(mapped == (decoy::lookup[position] >= 0));
+    if (mapped)
+    {
+      REQUIRE(pixel == decoy::lookup[position]);
+    }
+  }
+}
+} // namespace luz::database::test
@@ -0,0 +1,110 @@
+#include "listing.hh"
+#include "validate.hh"
+#include "work_stealing_pool.hh"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace luz::host::test
+{
+TEST_CASE("listing lines", "[corpus]")
+{
+  ListingLine parsed{};
+  REQUIRE(is_comment(""));
+  REQUIRE(is_comment("# climbs"));
+  REQUIRE(parse_line("30 01 04 a1 02 54 29 01 E0 03", parsed));
+  REQUIRE(parsed.dwell_s == 30U);
+  REQUIRE(parsed.bytes.size() == 9UL);
+  REQUIRE(parsed.bytes[2] == std::byte{ 0xA1 });
+
+  REQUIRE_FALSE(parse_line("01 1FF", parsed));
+  REQUIRE_FALSE(parse_line("30 01 zz", parsed));
+  REQUIRE_FALSE(parse_line("70000 01", parsed));
+}
+
+TEST_CASE("climb validation", "[corpus]")
+{
+  // Positions 297 and 108 are on the board, 1000 is not
+  constexpr auto packet = std::array{ std::byte{ 0x01 }, std::byte{ 0x0A }, std::byte{ 0x84 },
+                                      std::byte{ 0x02 }, std::byte{ 0x54 }, std::byte{ 0x29 },
+                                      std::byte{ 0x01 }, std::byte{ 0xE0 }, std::byte{ 0xE8 },
+                                      std::byte{ 0x03 }, std::byte{ 0xE3 }, std::byte{ 0x6C },
+                                      std::byte{ 0x00 }, std::byte{ 0xE3 }, std::byte{ 0x03 } };
+  std::vector<Placement> scratch{};
+
+  SECTION("unknown positions are reported")
+  {
+    const auto report = validate(packet, scratch);
+    REQUIRE(report.status == protocol::ProtocolStatus::success);
+    REQUIRE(report.num_packets == 1UL);
+    REQUIRE(report.num_placements == 3UL);
+    REQUIRE(report.unknown_positions == std::vector<uint16_t>{ 1000U });
+    REQUIRE_FALSE(report.valid());
+  }
+
+  SECTION("every packet of a climb is validated")
+  {
+    std::vector<std::byte> bytes{ packet.begin(), packet.end() };
+    bytes.insert(bytes.end(), packet.begin(), packet.end());
+    const auto report = validate(bytes, scratch);
+    REQUIRE(report.num_packets == 2UL);
+    REQUIRE(report.unknown_positions == std::vector<uint16_t>{ 1000U, 1000U });
+  }
+
+  SECTION("malformed packets are reported")
+  {
+    auto corrupted = packet;
+    corrupted[2] = std::byte{ 0x00 };
+    REQUIRE(validate(corrupted, scratch).status == protocol::ProtocolStatus::bad_checksum);
+    REQUIRE(validate(std::span(packet).first(10UL), scratch).status
+            == protocol::ProtocolStatus::incomplete);
+    REQUIRE(validate({}, scratch).status == protocol::ProtocolStatus::insufficient_header_bytes);
+  }
+}
+
+TEST_CASE("work stealing pool", "[corpus]")
+{
+  WorkStealingPool pool{ 4UL };
+  REQUIRE(pool.num_workers() == 4UL);
+
+  SECTION("every index is visited exactly once")
+  {
+    // Assertions are not thread-safe, so results are checked once the workers have finished
+    std::vector<std::atomic<int>> visits(1'001UL);
+    std::atomic<size_t> max_worker{};
+    pool.for_each_index(visits.size(), 16UL, [&](size_t worker, size_t index) {
+      ++visits[index];
+      size_t seen = max_worker;
+      while (seen < worker && !max_worker.compare_exchange_weak(seen, worker))
+      {
+      }
+    });
+    REQUIRE(std::ranges::all_of(visits, [](const auto& count) { return count == 1; }));
+    REQUIRE(max_worker < pool.num_workers());
+  }
+
+  SECTION("idle workers steal from a slow one")
+  {
+    // Worker 0 is dealt chunks 0, 4, 8, ...; make each of them slow
+    const auto steals = pool.for_each_index(64UL, 1UL, [](size_t, size_t index) {
+      if (index % 4UL == 0UL)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 5 });
+      }
+    });
+    REQUIRE(steals > 0UL);
+  }
+
+  SECTION("no work")
+  {
+    std::atomic<size_t> calls{};
+    REQUIRE(pool.for_each_index(0UL, 8UL, [&calls](size_t, size_t) { ++calls; }) == 0UL);
+    REQUIRE(calls == 0UL);
+  }
+}
+} // namespace luz::host::test
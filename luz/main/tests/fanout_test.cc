@@ -0,0 +1,334 @@
+#include "fanout.hh"
+#include "pseudo_terminal.hh"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace luz::fanout::test
+{
+/// Collects what is written to it, and drops every write while full
+struct RecordingPort
+{
+  bool write(std::span<const std::byte> bytes)
+  {
+    if (full)
+    {
+      return false;
+    }
+    line.insert(line.end(), bytes.begin(), bytes.end());
+    return true;
+  }
+  size_t read(std::span<std::byte>, uint32_t) { return 0UL; }
+
+  std::vector<std::byte> line{};
+  bool full = false;
+};
+
+/// A climb of num_holds random pixels
+render::IndexedFrame random_frame(std::mt19937& random, size_t num_holds)
+{
+  render::IndexedFrame frame{};
+  frame.fill(render::palette_index(Color{}));
+  std::uniform_int_distribution<size_t> pixel{ 0UL, frame.size() - 1UL };
+  std::uniform_int_distribution<int> index{ 1, 255 };
+  for (size_t hold = 0UL; hold < num_holds; ++hold)
+  {
+    frame[pixel(random)] = static_cast<render::PaletteIndex>(index(random));
+  }
+  return frame;
+}
+
+/// Decode each packet on the line
+std::vector<std::vector<std::byte>> packets(std::span<const std::byte> line)
+{
+  std::vector<std::vector<std::byte>> packets{};
+  PacketReader reader{};
+  for (const auto byte : line)
+  {
+    if (const auto packet = reader.push(byte))
+    {
+      packets.emplace_back(packet->begin(), packet->end());
+    }
+  }
+  return packets;
+}
+
+FrameHeader header_of(std::span<const std::byte> packet)
+{
+  FrameHeader header{};
+  REQUIRE(FrameHeaderLayout::decode(packet, header));
+  return header;
+}
+
+TEST_CASE("COBS removes every zero from a packet and restores it", "[fanout]")
+{
+  std::mt19937 random{ 1U };
+  for (const size_t size : { 0UL, 1UL, 253UL, 254UL, 255UL, 508UL, max_packet_size })
+  {
+    for (const int zeros : { 0, 1, 10 })
+    {
+      std::vector<std::byte> bytes(size);
+      std::ranges::generate(bytes, [&] { return static_cast<std::byte>((random() % 255U) + 1U); });
+      for (int zero = 0; zero < zeros && size > 0UL; ++zero)
+      {
+        bytes[random() % size] = delimiter;
+      }
+
+      std::vector<std::byte> line(line_size(size));
+      const auto encoded = cobs_encode(bytes, line);
+      REQUIRE(encoded <= line_size(size));
+      REQUIRE(line[encoded - 1UL] == delimiter);
+      REQUIRE(std::ranges::count(std::span{ line }.first(encoded), delimiter) == 1);
+
+      const auto decoded = cobs_decode(std::span{ line }.first(encoded - 1UL));
+      REQUIRE(decoded == size);
+      REQUIRE(std::ranges::equal(std::span{ line }.first(size), bytes));
+    }
+  }
+}
+
+TEST_CASE("frames are sent in the smallest encoding", "[fanout]")
+{
+  std::mt19937 random{ 2U };
+  std::array<std::byte, max_packet_size> packet{};
+
+  // An empty board lists no pixels
+  render::IndexedFrame blank{};
+  blank.fill(render::palette_index(Color{}));
+  auto size = encode_frame(1U, FrameKind::commit, blank, nullptr, packet);
+  REQUIRE(size == FrameHeaderLayout::size + crc_size);
+  REQUIRE(header_of(packet).encoding == Encoding::sparse);
+
+  // A climb lists its holds
+  const auto climb = random_frame(random, 40UL);
+  size = encode_frame(2U, FrameKind::commit, climb, nullptr, packet);
+  const auto header = header_of(packet);
+  REQUIRE(header == FrameHeader{ .sequence = 2U,
+                                 .kind = FrameKind::commit,
+                                 .encoding = Encoding::sparse,
+                                 .count = header.count });
+  REQUIRE(size == FrameHeaderLayout::size + (header.count * PixelUpdateLayout::size) + crc_size);
+
+  // A climb with a hold changed lists only that hold
+  auto next = climb;
+  next[10] = static_cast<render::PaletteIndex>(next[10] + 1U);
+  size = encode_frame(3U, FrameKind::provisional, next, &climb, packet);
+  REQUIRE(header_of(packet).encoding == Encoding::delta);
+  REQUIRE(header_of(packet).count == 1U);
+
+  // A board lit all over is sent pixel by pixel
+  const auto lit = random_frame(random, 2'000UL);
+  size = encode_frame(4U, FrameKind::commit, lit, &climb, packet);
+  REQUIRE(header_of(packet).encoding == Encoding::dense);
+  REQUIRE(size == max_packet_size);
+}
+
+TEST_CASE("a secondary applies deltas in sequence and resynchronises at keyframes", "[fanout]")
+{
+  std::mt19937 random{ 3U };
+  RecordingPort port{};
+  Primary primary{ port, 1'000U };
+  Latch latch{};
+  std::vector<FrameKind> kinds{};
+  const auto deliver = [&](size_t from) {
+    for (const auto& packet : packets(std::span{ port.line }.subspan(from)))
+    {
+      if (const auto kind = latch.apply(packet))
+      {
+        kinds.push_back(*kind);
+      }
+    }
+  };
+
+  auto frame = random_frame(random, 30UL);
+  REQUIRE(primary.send(FrameKind::commit, frame, 0U));
+  deliver(0UL);
+  REQUIRE(latch.synced());
+  REQUIRE(latch.frame() == frame);
+
+  frame[0] = 7U;
+  REQUIRE(primary.send(FrameKind::provisional, frame, 10U));
+  frame[1] = 8U;
+  REQUIRE(primary.send(FrameKind::commit, frame, 20U));
+  deliver(0UL);
+  REQUIRE(latch.frame() == frame);
+  REQUIRE(latch.sequence() == primary.sequence());
+  REQUIRE(kinds == std::vector{ FrameKind::commit, FrameKind::provisional, FrameKind::commit });
+
+  // A missed delta stops the secondary from applying the next...
+  frame[2] = 9U;
+  REQUIRE(primary.send(FrameKind::commit, frame, 30U));
+  const auto missed_from = port.line.size();
+  frame[3] = 10U;
+  REQUIRE(primary.send(FrameKind::commit, frame, 40U));
+  deliver(missed_from);
+  REQUIRE_FALSE(latch.synced());
+  REQUIRE(latch.skipped() == 1U);
+
+  // ... until the primary repeats the frame as a keyframe
+  auto repeated_from = port.line.size();
+  REQUIRE(primary.update(999U));
+  REQUIRE(port.line.size() == repeated_from);
+  REQUIRE(primary.update(1'000U));
+  REQUIRE(header_of(packets(std::span{ port.line }.subspan(repeated_from)).front()).encoding
+          == Encoding::sparse);
+  deliver(repeated_from);
+  REQUIRE(latch.synced());
+  REQUIRE(latch.frame() == frame);
+
+  // Secondaries already showing the frame ignore the repeat
+  repeated_from = port.line.size();
+  const auto num_kinds = kinds.size();
+  REQUIRE(primary.update(2'000U));
+  deliver(repeated_from);
+  REQUIRE(kinds.size() == num_kinds);
+
+  // A frame dropped by the port is followed by a keyframe
+  port.full = true;
+  frame[4] = 11U;
+  REQUIRE_FALSE(primary.send(FrameKind::commit, frame, 2'010U));
+  REQUIRE(primary.dropped() == 1U);
+  port.full = false;
+  repeated_from = port.line.size();
+  frame[5] = 12U;
+  REQUIRE(primary.send(FrameKind::commit, frame, 2'020U));
+  REQUIRE(header_of(packets(std::span{ port.line }.subspan(repeated_from)).front()).encoding
+          != Encoding::delta);
+  deliver(repeated_from);
+  REQUIRE(latch.frame() == frame);
+}
+
+TEST_CASE("corrupt packets are discarded without losing the next", "[fanout]")
+{
+  std::mt19937 random{ 4U };
+  RecordingPort port{};
+  Primary primary{ port, 1'000U };
+  const auto first = random_frame(random, 50UL);
+  const auto second = random_frame(random, 50UL);
+  REQUIRE(primary.send(FrameKind::commit, first, 0U));
+  const auto first_size = port.line.size();
+  REQUIRE(primary.send(FrameKind::commit, second, 10U));
+
+  // Join the line halfway through the first packet, and flip a bit of the second
+  auto line = std::vector<std::byte>(port.line.begin() + (first_size / 2UL), port.line.end());
+  Latch latch{};
+  for (const auto& packet : packets(line))
+  {
+    (void)latch.apply(packet);
+  }
+  REQUIRE(latch.synced());
+  REQUIRE(latch.frame() == second);
+
+  line[line.size() - 10UL] ^= std::byte{ 0x10 };
+  Latch corrupted{};
+  for (const auto& packet : packets(line))
+  {
+    REQUIRE_FALSE(corrupted.apply(packet));
+  }
+  REQUIRE(corrupted.corrupt() >= 1U);
+
+  // A packet too long for any frame is skipped up to its delimiter
+  PacketReader reader{};
+  for (size_t byte = 0UL; byte < 2UL * line_size(max_packet_size); ++byte)
+  {
+    REQUIRE_FALSE(reader.push(std::byte{ 1 }));
+  }
+  REQUIRE_FALSE(reader.push(delimiter));
+  REQUIRE(reader.discarded() == 1U);
+}
+
+TEST_CASE("a full frame crosses the chain within one LED refresh at the default baud rate",
+          "[fanout]")
+{
+  constexpr uint32_t baud = 2'000'000U;
+  constexpr uint32_t refresh_us = 1'000'000U / 60U;
+  // Each board passes bytes on as soon as the UART hands them over, after at most a FIFO's worth
+  constexpr size_t forward_bytes = 120UL;
+  constexpr size_t num_secondaries = 8UL;
+  REQUIRE(airtime_us(line_size(max_packet_size), baud)
+              + (num_secondaries * airtime_us(forward_bytes, baud))
+          < refresh_us);
+}
+
+TEST_CASE("frames travel down a chain of pseudo-terminals", "[fanout]")
+{
+  // primary -> first -> second -> (nothing)
+  host::PseudoTerminal first_line{};
+  host::PseudoTerminal second_line{};
+  host::PseudoTerminal end_of_chain{};
+  REQUIRE(first_line.valid());
+  REQUIRE(second_line.valid());
+  REQUIRE(end_of_chain.valid());
+
+  host::SerialPort primary_port{ -1, first_line.master() };
+  host::SerialPort first_port{ first_line.slave(), second_line.master() };
+  host::SerialPort second_port{ second_line.slave(), end_of_chain.master() };
+
+  struct Board
+  {
+    std::mutex mutex{};
+    std::vector<std::pair<FrameKind, render::IndexedFrame>> latched{};
+  };
+  std::array<Board, 2> boards{};
+  std::atomic<bool> running{ true };
+  const auto run = [&running](host::SerialPort& port, Board& board) {
+    Secondary secondary{ port };
+    while (running)
+    {
+      secondary.poll(10U, [&board](FrameKind kind, const render::IndexedFrame& frame) {
+        const auto lock = std::lock_guard{ board.mutex };
+        board.latched.emplace_back(kind, frame);
+      });
+    }
+  };
+  std::thread first{ run, std::ref(first_port), std::ref(boards[0]) };
+  std::thread second{ run, std::ref(second_port), std::ref(boards[1]) };
+
+  std::mt19937 random{ 5U };
+  Primary primary{ primary_port, 1'000U };
+  std::vector<std::pair<FrameKind, render::IndexedFrame>> sent{};
+  for (int climb = 0; climb < 20; ++climb)
+  {
+    auto frame = random_frame(random, 60UL);
+    auto partial = frame;
+    std::fill(partial.begin() + (partial.size() / 2UL), partial.end(), frame.back());
+    sent.emplace_back(FrameKind::provisional, partial);
+    sent.emplace_back(climb % 5 == 4 ? FrameKind::rollback : FrameKind::commit, frame);
+  }
+  for (const auto& [kind, frame] : sent)
+  {
+    REQUIRE(primary.send(kind, frame, 0U));
+    // Give the pseudo-terminals time to drain, as the baud rate would on the device
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 2 });
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ 5 };
+  const auto complete = [&](Board& board) {
+    const auto lock = std::lock_guard{ board.mutex };
+    return board.latched.size() >= sent.size();
+  };
+  while ((!complete(boards[0]) || !complete(boards[1]))
+         && std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 5 });
+  }
+  running = false;
+  first.join();
+  second.join();
+
+  REQUIRE(boards[0].latched == sent);
+  REQUIRE(boards[1].latched == sent);
+}
+} // namespace luz::fanout::test
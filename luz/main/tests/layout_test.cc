@@ -0,0 +1,114 @@
+#include "field.hh"
+#include "layout.hh"
+#include "packet_layout.hh"
+
+#include <array>
+#include <span>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace luz::layout::test
+{
+using protocol::Layouts;
+
+constexpr auto header_bytes
+    = std::array{ std::byte{ 0x01 }, std::byte{ 0x1F }, std::byte{ 0xD6 }, std::byte{ 0x02 },
+                  std::byte{ 0x54 } };
+constexpr auto placement_bytes
+    = std::array{ std::byte{ 0x29 }, std::byte{ 0x01 }, std::byte{ 0xE3 } };
+
+constexpr Packet::Header decode_header(std::span<const std::byte> bytes)
+{
+  Packet::Header header{};
+  return Layouts::Header::decode(bytes, header) ? header : Packet::Header{};
+}
+
+constexpr Placement decode_placement(std::span<const std::byte> bytes)
+{
+  Placement placement{};
+  (void)Layouts::Placement::decode(bytes, placement);
+  return placement;
+}
+
+template <typename L>
+constexpr std::array<std::byte, L::size> encode(const typename L::record_type& record)
+{
+  std::array<std::byte, L::size> bytes{};
+  L::encode(record, bytes);
+  return bytes;
+}
+
+TEST_CASE("fields are constexpr", "[field]")
+{
+  constexpr auto position = Field<uint16_t>{ 0UL };
+  constexpr auto color = offset_from<uint8_t>(position);
+  STATIC_REQUIRE(position.value(std::span(placement_bytes)) == 297U);
+  STATIC_REQUIRE(color.value(std::span(placement_bytes)) == 0xE3U);
+
+  auto bytes = placement_bytes;
+  color.write(std::span(bytes), 0x43U);
+  REQUIRE(bytes[2] == std::byte{ 0x43 });
+}
+
+/// A byte split into the top three bits and the remaining five
+struct Split
+{
+  uint8_t high{};
+  uint8_t low{};
+};
+
+using SplitLayout
+    = Layout<Split, Packed<uint8_t, Bits<&Split::high, 3UL>, Bits<&Split::low, 5UL>>>;
+
+TEST_CASE("packed bit-fields", "[layout]")
+{
+  constexpr auto bytes = std::array{ std::byte{ 0xE3 } };
+  constexpr auto split = [&] {
+    Split decoded{};
+    (void)SplitLayout::decode(bytes, decoded);
+    return decoded;
+  }();
+  STATIC_REQUIRE(split.high == 7U);
+  STATIC_REQUIRE(split.low == 3U);
+
+  // Each field is encoded into its own bits
+  STATIC_REQUIRE(encode<SplitLayout>(Split{ .high = 2U, .low = split.low })
+                 == std::array{ std::byte{ 0x43 } });
+}
+
+TEST_CASE("header layout", "[layout]")
+{
+  STATIC_REQUIRE(Layouts::Header::size == 5UL);
+
+  constexpr auto header = decode_header(header_bytes);
+  STATIC_REQUIRE(header.payload_size == 0x1E);
+  STATIC_REQUIRE(header.checksum == 0xD6);
+  STATIC_REQUIRE(header.index_marker == IndexMarker::solo);
+
+  STATIC_REQUIRE(encode<Layouts::Header>(header) == header_bytes);
+
+  auto bad_marker = header_bytes;
+  bad_marker[4] = std::byte{ 0x50 };
+  Packet::Header decoded{};
+  REQUIRE_FALSE(Layouts::Header::decode(bad_marker, decoded));
+
+  auto bad_indicator = header_bytes;
+  bad_indicator[3] = std::byte{ 0x03 };
+  REQUIRE_FALSE(Layouts::Header::decode(bad_indicator, decoded));
+}
+
+TEST_CASE("placement layout", "[layout]")
+{
+  STATIC_REQUIRE(Layouts::Placement::size == 3UL);
+
+  constexpr auto placement = decode_placement(placement_bytes);
+  STATIC_REQUIRE(placement == Placement{ 297U, Color{ 224U, 0U, 192U } });
+  STATIC_REQUIRE(encode<Layouts::Placement>(placement) == placement_bytes);
+
+  for (uint16_t raw = 0U; raw <= UINT8_MAX; ++raw)
+  {
+    const auto bytes = std::array{ std::byte{ 0x00 }, std::byte{ 0x00 }, std::byte(raw) };
+    REQUIRE(encode<Layouts::Placement>(decode_placement(bytes)) == bytes);
+  }
+}
+} // namespace luz::layout::test
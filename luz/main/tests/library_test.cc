@@ -0,0 +1,175 @@
+#include "library.hh"
+#include "mapped_file.hh"
+#include "playlist.hh"
+
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace luz::library::test
+{
+constexpr auto single_hold = std::array{ std::byte{ 0x01 }, std::byte{ 0x04 }, std::byte{ 0xA1 },
+                                         std::byte{ 0x02 }, std::byte{ 0x54 }, std::byte{ 0x29 },
+                                         std::byte{ 0x01 }, std::byte{ 0xE0 }, std::byte{ 0x03 } };
+constexpr auto two_holds = std::array{ std::byte{ 0x01 }, std::byte{ 0x07 }, std::byte{ 0x52 },
+                                       std::byte{ 0x02 }, std::byte{ 0x54 }, std::byte{ 0x29 },
+                                       std::byte{ 0x01 }, std::byte{ 0xE0 }, std::byte{ 0x6C },
+                                       std::byte{ 0x00 }, std::byte{ 0xE3 }, std::byte{ 0x03 } };
+
+std::vector<std::byte> make_library()
+{
+  Builder builder{};
+  REQUIRE(builder.add(single_hold, 5U));
+  REQUIRE(builder.add(two_holds, 10U));
+  return builder.build();
+}
+
+constexpr size_t num_placements(std::span<const std::byte> bytes, size_t index)
+{
+  Library library{};
+  if (Library::try_make(bytes, library) != LibraryStatus::success)
+  {
+    return 0UL;
+  }
+  Packet::Header header{};
+  std::vector<Placement> placements{};
+  (void)library.decode(index, header, placements);
+  return placements.size();
+}
+
+TEST_CASE("library format", "[library]")
+{
+  STATIC_REQUIRE(detail::HeaderLayout::size == 8UL);
+  STATIC_REQUIRE(detail::EntryLayout::size == 8UL);
+
+  STATIC_REQUIRE([] {
+    Builder builder{};
+    (void)builder.add(two_holds);
+    return num_placements(builder.build(), 0UL);
+  }() == 2UL);
+
+  Builder builder{};
+  REQUIRE_FALSE(builder.add(std::span(single_hold).first(8UL)));
+  REQUIRE(builder.size() == 0UL);
+
+  // A climb of several packets would be stored only in part
+  std::vector<std::byte> two_packets(single_hold.begin(), single_hold.end());
+  two_packets.insert(two_packets.end(), two_holds.begin(), two_holds.end());
+  REQUIRE_FALSE(builder.add(two_packets));
+  REQUIRE(builder.size() == 0UL);
+
+  const auto bytes = make_library();
+  REQUIRE(bytes.size() == detail::frames_offset(2UL) + single_hold.size() + two_holds.size());
+
+  Library library{};
+  REQUIRE(Library::try_make(bytes, library) == LibraryStatus::success);
+  REQUIRE(library.size() == 2UL);
+  REQUIRE(library.entry(0UL).dwell_s == 5U);
+  REQUIRE(library.entry(1UL).dwell_s == 10U);
+  REQUIRE(std::ranges::equal(library.frame(1UL), two_holds));
+
+  Packet::Header header{};
+  std::vector<Placement> placements{};
+  REQUIRE(library.decode(1UL, header, placements) == protocol::ProtocolStatus::success);
+  REQUIRE(placements
+          == std::vector{ Placement{ 297U, Color{ 224, 0, 0 } },
+                          Placement{ 108U, Color{ 224, 0, 192 } } });
+}
+
+TEST_CASE("invalid libraries are rejected", "[library]")
+{
+  auto bytes = make_library();
+  Library library{};
+
+  SECTION("truncated header")
+  {
+    REQUIRE(Library::try_make(std::span(bytes).first(4UL), library) == LibraryStatus::bad_header);
+  }
+  SECTION("bad magic")
+  {
+    bytes[0] = std::byte{ 0x00 };
+    REQUIRE(Library::try_make(bytes, library) == LibraryStatus::bad_header);
+  }
+  SECTION("other API level")
+  {
+    bytes[5] = std::byte{ 0x02 };
+    REQUIRE(Library::try_make(bytes, library) == LibraryStatus::bad_header);
+  }
+  SECTION("truncated frames")
+  {
+    REQUIRE(Library::try_make(std::span(bytes).first(bytes.size() - 1UL), library)
+            == LibraryStatus::bad_index);
+  }
+  SECTION("entry inside the index")
+  {
+    bytes[detail::HeaderLayout::size] = std::byte{ 0x00 };
+    REQUIRE(Library::try_make(bytes, library) == LibraryStatus::bad_index);
+  }
+  REQUIRE(library.empty());
+}
+
+TEST_CASE("library read in place from a mapped file", "[library]")
+{
+  const auto bytes = make_library();
+  const auto path = "library_test.bin";
+  {
+    std::ofstream output{ path, std::ios::binary };
+    output.write(reinterpret_cast<const char*>(bytes.data()),
+                 static_cast<std::streamsize>(bytes.size()));
+  }
+
+  {
+    const host::MappedFile file{ path };
+    REQUIRE(std::ranges::equal(file.bytes(), bytes));
+
+    Library library{};
+    REQUIRE(Library::try_make(file.bytes(), library) == LibraryStatus::success);
+    REQUIRE(library.frame(0UL).data() >= file.bytes().data());
+    REQUIRE(num_placements(file.bytes(), 0UL) == 1UL);
+    REQUIRE(num_placements(file.bytes(), 1UL) == 2UL);
+  }
+  std::remove(path);
+
+  REQUIRE(host::MappedFile{ path }.bytes().empty());
+}
+
+TEST_CASE("playlist", "[library]")
+{
+  const auto bytes = make_library();
+  Library library{};
+  REQUIRE(Library::try_make(bytes, library) == LibraryStatus::success);
+
+  Playlist playlist{ library };
+  REQUIRE_FALSE(playlist.poll(0U));
+
+  playlist.start(1'000U);
+  REQUIRE(playlist.playing());
+  REQUIRE(playlist.poll(1'000U) == 0UL);
+  REQUIRE_FALSE(playlist.poll(5'999U));
+  REQUIRE(playlist.poll(6'000U) == 1UL);
+  REQUIRE_FALSE(playlist.poll(15'999U));
+  REQUIRE(playlist.poll(16'000U) == 0UL);
+
+  SECTION("stopping holds the current climb")
+  {
+    playlist.stop();
+    REQUIRE_FALSE(playlist.poll(30'000U));
+    playlist.start(40'000U);
+    REQUIRE(playlist.poll(40'000U) == 0UL);
+    REQUIRE(playlist.poll(45'000U) == 1UL);
+  }
+
+  SECTION("an empty library never plays")
+  {
+    const Library empty{};
+    Playlist empty_playlist{ empty };
+    empty_playlist.start(0U);
+    REQUIRE_FALSE(empty_playlist.playing());
+    REQUIRE_FALSE(empty_playlist.poll(0U));
+  }
+}
+} // namespace luz::library::test
@@ -0,0 +1,88 @@
+#include "output.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace luz::render::test
+{
+constexpr auto white = Color{ 255U, 255U, 255U };
+
+TEST_CASE("gamma table", "[output]")
+{
+  STATIC_REQUIRE(gamma_table[0] == 0U);
+  STATIC_REQUIRE(gamma_table[255] == 255U);
+  STATIC_REQUIRE(std::ranges::is_sorted(gamma_table));
+
+  for (uint32_t level = 0U; level < gamma_table.size(); ++level)
+  {
+    const auto expected = std::lround(std::pow(level / 255.0, default_gamma) * 255.0);
+    REQUIRE(std::abs(gamma_table[level] - expected) <= 1L);
+  }
+}
+
+TEST_CASE("brightness is folded into the level table", "[output]")
+{
+  const OutputStage full{};
+  REQUIRE(full.levels() == gamma_table);
+
+  const OutputStage half{ 128U };
+  REQUIRE(half.brightness() == 128U);
+  REQUIRE(half.levels()[0] == 0U);
+  REQUIRE(half.levels()[255] == 128U);
+  REQUIRE(half.levels()[128] == (gamma_table[128] * 128U + 127U) / 255U);
+
+  const OutputStage off{ 0U };
+  REQUIRE(std::ranges::all_of(off.levels(), [](uint8_t level) { return level == 0U; }));
+}
+
+TEST_CASE("frames within the budget are only gamma corrected", "[output]")
+{
+  OutputStage output{ 255U, 1'000U };
+  Frame frame{};
+  frame[0] = Color{ 224U, 0U, 192U };
+  frame[10] = white;
+
+  REQUIRE_FALSE(output.apply(frame));
+  REQUIRE(frame[0] == Color{ gamma_table[224], 0U, gamma_table[192] });
+  REQUIRE(frame[10] == white);
+  REQUIRE(frame[1] == Color{});
+}
+
+TEST_CASE("frames over the budget are scaled down to it", "[output]")
+{
+  constexpr uint32_t budget_ma = 2'000U;
+  OutputStage output{ 255U, budget_ma };
+  Frame frame{};
+  frame.fill(white);
+  frame[5] = Color{};
+
+  // Each pixel at full white draws 60mA, far more than the budget across the board
+  REQUIRE(output.estimate_ma(frame) > budget_ma);
+  REQUIRE(output.apply(frame));
+  REQUIRE(output.estimate_ma(frame) <= budget_ma);
+  REQUIRE(output.estimate_ma(frame) >= budget_ma * 95U / 100U);
+  REQUIRE(frame[5] == Color{});
+
+  SECTION("without a budget")
+  {
+    OutputStage unlimited{};
+    frame.fill(white);
+    REQUIRE_FALSE(unlimited.apply(frame));
+    REQUIRE(frame[0] == white);
+  }
+}
+
+TEST_CASE("brightness is applied before the budget", "[output]")
+{
+  OutputStage output{ 64U, 8'000U };
+  Frame frame{};
+  frame.fill(white);
+
+  // At a quarter of full brightness each pixel draws 15mA, keeping the board within the budget
+  REQUIRE_FALSE(output.apply(frame));
+  REQUIRE(frame[0] == Color{ 64U, 64U, 64U });
+}
+} // namespace luz::render::test
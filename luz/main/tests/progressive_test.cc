@@ -0,0 +1,163 @@
+#include "database.hh"
+#include "protocol.hh"
+#include "render.hh"
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace luz::render::test
+{
+// A ten hold climb as sent by the Aurora app
+constexpr auto climb = std::array{
+  std::byte{ 0x01 }, std::byte{ 0x1F }, std::byte{ 0xD6 }, std::byte{ 0x02 }, std::byte{ 0x54 },
+  std::byte{ 0x29 }, std::byte{ 0x01 }, std::byte{ 0xE0 }, std::byte{ 0x6C }, std::byte{ 0x00 },
+  std::byte{ 0xE3 }, std::byte{ 0x8D }, std::byte{ 0x01 }, std::byte{ 0x03 }, std::byte{ 0x12 },
+  std::byte{ 0x01 }, std::byte{ 0x1C }, std::byte{ 0xAA }, std::byte{ 0x00 }, std::byte{ 0x1C },
+  std::byte{ 0xEC }, std::byte{ 0x00 }, std::byte{ 0x03 }, std::byte{ 0x0F }, std::byte{ 0x01 },
+  std::byte{ 0x03 }, std::byte{ 0x34 }, std::byte{ 0x01 }, std::byte{ 0xE3 }, std::byte{ 0x7C },
+  std::byte{ 0x01 }, std::byte{ 0xE3 }, std::byte{ 0x78 }, std::byte{ 0x01 }, std::byte{ 0x03 },
+  std::byte{ 0x03 },
+};
+
+/// Connection interval between consecutive writes on a slow link
+constexpr uint32_t write_interval_ms = 45U;
+/// Climbs are split into writes of at most this many bytes
+constexpr size_t write_size = 12UL;
+
+IndexedFrame to_frame(std::span<const Placement> placements)
+{
+  IndexedFrame frame{};
+  for (const auto& placement : placements)
+  {
+    if (uint16_t pixel = 0U; database::placement_to_pixel(placement.position, pixel))
+    {
+      frame[pixel] = palette_index(placement.color);
+    }
+  }
+  return frame;
+}
+
+bool any_lit(const Frame& frame)
+{
+  return std::ranges::any_of(frame, [](const Color& color) { return color != Color{}; });
+}
+
+/// Plays the climb, one write every write_interval_ms, into a pipeline composed after each
+/// @return The time at which the first hold was lit, if any
+std::optional<uint32_t> first_lit_ms(std::span<const std::byte> bytes, bool progressive)
+{
+  protocol::Protocol protocol{};
+  Pipeline<ClimbLayer> pipeline{};
+  Frame composed{};
+
+  uint32_t now = 0U;
+  for (; !bytes.empty(); now += write_interval_ms)
+  {
+    const auto write = bytes.first(std::min(bytes.size(), write_size));
+    bytes = bytes.subspan(write.size());
+
+    Packet packet{};
+    if (protocol.process(write, packet))
+    {
+      pipeline.layer<ClimbLayer>().show(to_frame(packet.placements), now);
+    }
+    else if (progressive && protocol.provisional(packet))
+    {
+      pipeline.layer<ClimbLayer>().show_provisional(to_frame(packet.placements), now);
+    }
+    else if (progressive && !protocol.statuses().empty())
+    {
+      pipeline.layer<ClimbLayer>().rollback(now);
+    }
+
+    // Compose at the end of the crossfade, the latest the holds can take to appear
+    pipeline.compose(composed, now + ClimbLayer::crossfade_ms);
+    if (any_lit(composed))
+    {
+      return now;
+    }
+  }
+  return std::nullopt;
+}
+
+TEST_CASE("provisional placements", "[progressive]")
+{
+  protocol::Protocol protocol{};
+  Packet packet{};
+
+  REQUIRE_FALSE(protocol.provisional(packet));
+
+  // The first write holds the header and two complete placements
+  REQUIRE_FALSE(protocol.process(std::span(climb).first(13UL), packet));
+  REQUIRE(protocol.provisional(packet));
+  constexpr auto expected = std::array{ Placement{ 297U, Color{ 224, 0, 0 } },
+                                        Placement{ 108U, Color{ 224, 0, 192 } } };
+  REQUIRE(std::ranges::equal(packet.placements, expected));
+
+  REQUIRE(protocol.process(std::span(climb).subspan(13UL), packet));
+  REQUIRE(packet.placements.size() == 10UL);
+  REQUIRE_FALSE(protocol.provisional(packet));
+}
+
+TEST_CASE("time to first lit hold", "[progressive]")
+{
+  const auto all_or_nothing = first_lit_ms(climb, false);
+  const auto progressive = first_lit_ms(climb, true);
+  REQUIRE(all_or_nothing == 2U * write_interval_ms);
+  REQUIRE(progressive == 0U);
+  REQUIRE(*progressive < *all_or_nothing);
+}
+
+TEST_CASE("provisional frames are committed or rolled back", "[progressive]")
+{
+  protocol::Protocol protocol{};
+  ClimbLayer layer{};
+  IndexedFrame previous{};
+  previous[0] = palette_index(Color{ 0U, 0U, 192U });
+  layer.show(previous, 0U);
+
+  Packet packet{};
+  REQUIRE_FALSE(protocol.process(std::span(climb).first(write_size), packet));
+  REQUIRE(protocol.provisional(packet));
+  const auto provisional = to_frame(packet.placements);
+  layer.show_provisional(provisional, 1'000U);
+  REQUIRE(layer.provisional());
+
+  // Provisional frames are drawn at once, without a crossfade
+  Frame composed{};
+  layer.apply(composed, 1'000U);
+  REQUIRE(std::ranges::equal(
+      composed, provisional, {}, {}, [](PaletteIndex index) { return palette[index]; }));
+
+  SECTION("commit")
+  {
+    REQUIRE(protocol.process(std::span(climb).subspan(write_size), packet));
+    const auto complete = to_frame(packet.placements);
+    layer.show(complete, 1'100U);
+    REQUIRE_FALSE(layer.provisional());
+    layer.apply(composed, 1'100U + ClimbLayer::crossfade_ms);
+    REQUIRE(std::ranges::equal(
+        composed, complete, {}, {}, [](PaletteIndex index) { return palette[index]; }));
+  }
+
+  SECTION("rollback on checksum failure")
+  {
+    auto corrupted = std::vector(climb.begin() + write_size, climb.end());
+    corrupted[4] ^= std::byte{ 0xFF };
+    REQUIRE_FALSE(protocol.process(corrupted, packet));
+    REQUIRE(protocol.statuses().front() == protocol::ProtocolStatus::bad_checksum);
+    REQUIRE_FALSE(protocol.provisional(packet));
+
+    layer.rollback(1'100U);
+    REQUIRE_FALSE(layer.provisional());
+    layer.apply(composed, 1'100U);
+    REQUIRE(composed[0] == Color{ 0U, 0U, 192U });
+    REQUIRE(std::ranges::count(composed, Color{}) == composed.size() - 1UL);
+  }
+}
+} // namespace luz::render::test
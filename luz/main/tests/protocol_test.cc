@@ -1,8 +1,11 @@
+#include "builtin.hh"
+#include "decoder.hh"
 #include "protocol.hh"
 
 #include <array>
 #include <memory_resource>
 #include <span>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -29,6 +32,24 @@ constexpr auto wilbur_wright_takes_flight_expected = std::array{
   Placement{ 380U, Color{ 224, 0, 192 } }, Placement{ 376U, Color{ 0, 0, 192 } },
 };
 
+constexpr auto wilbur_wright_takes_flight
+    = builtin::concat(wilbur_wright_takes_flight_p1, wilbur_wright_takes_flight_p2);
+
+template <size_t N> constexpr ProtocolStatus decode_status(const std::array<std::byte, N>& bytes)
+{
+  Packet::Header header{};
+  std::vector<Placement> placements{};
+  return decode(bytes, header, placements);
+}
+
+constexpr bool decodes_to_expected(std::span<const std::byte> bytes)
+{
+  Packet::Header header{};
+  std::vector<Placement> placements{};
+  return decode(bytes, header, placements) == ProtocolStatus::success
+         && std::ranges::equal(placements, wilbur_wright_takes_flight_expected);
+}
+
 TEST_CASE("top row", "[top_row]")
 {
   constexpr auto top_row_p1
@@ -136,4 +157,26 @@ TEST_CASE("decode wilbur_write_takes_flight incorrect byte indicators", "[byte_i
   REQUIRE_FALSE(protocol.process(wilbur_wright_takes_flight_p1, packet));
   REQUIRE(protocol.process(wilbur_wright_takes_flight_p2, packet));
 }
+
+TEST_CASE("decode wilbur_wright_takes_flight at compile time", "[constexpr]")
+{
+  STATIC_REQUIRE(decodes_to_expected(wilbur_wright_takes_flight));
+  STATIC_REQUIRE(decode_status(wilbur_wright_takes_flight_p1) == ProtocolStatus::incomplete);
+  STATIC_REQUIRE(decode_status(wilbur_wright_takes_flight_p2) == ProtocolStatus::bad_header);
+
+  constexpr auto corrupt = [] {
+    auto bytes = wilbur_wright_takes_flight;
+    bytes[6] = std::byte{ 0x02 };
+    return bytes;
+  }();
+  STATIC_REQUIRE(decode_status(corrupt) == ProtocolStatus::bad_checksum);
+}
+
+TEST_CASE("built-in climbs are decoded at compile time", "[constexpr]")
+{
+  constexpr auto lit = std::ranges::count_if(builtin::self_test, [](render::PaletteIndex index) {
+    return render::palette[index] != Color{};
+  });
+  STATIC_REQUIRE(lit == 17);
+}
 } // namespace luz::protocol::test
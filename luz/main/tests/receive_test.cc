@@ -0,0 +1,247 @@
+#include "decode_task.hh"
+#include "encoder.hh"
+#include "link.hh"
+#include "protocol.hh"
+#include "receive.hh"
+#include "rtos.hh"
+#include "stats.hh"
+#include "workload.hh"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace luz::receive::test
+{
+TEST_CASE("fragments are queued in order until the queue is full", "[receive]")
+{
+  ReceiveQueue<4> queue{};
+  REQUIRE(queue.empty());
+  REQUIRE_FALSE(queue.front());
+
+  const auto bytes = std::array{ std::byte{ 1 }, std::byte{ 2 }, std::byte{ 3 } };
+  for (size_t count = 1UL; count <= queue.capacity(); ++count)
+  {
+    REQUIRE(queue.try_push(std::span{ bytes }.first(count - 1UL)));
+  }
+  REQUIRE(queue.size() == 4UL);
+  REQUIRE_FALSE(queue.try_push(bytes));
+  REQUIRE(queue.overruns() == 1U);
+
+  // Fragments keep their size, even when empty
+  for (size_t count = 0UL; count < queue.capacity(); ++count)
+  {
+    const auto front = queue.front();
+    REQUIRE(front);
+    REQUIRE(std::ranges::equal(*front, std::span{ bytes }.first(count)));
+    queue.pop();
+  }
+  REQUIRE(queue.empty());
+
+  // Slots are reused once drained
+  REQUIRE(queue.try_push(bytes));
+  REQUIRE(std::ranges::equal(*queue.front(), bytes));
+}
+
+TEST_CASE("fragments larger than a slot are dropped", "[receive]")
+{
+  ReceiveQueue<2, 4> queue{};
+  REQUIRE_FALSE(queue.try_push(std::array<std::byte, 5>{}));
+  REQUIRE(queue.overruns() == 1U);
+  REQUIRE(queue.empty());
+  REQUIRE(queue.try_push(std::array<std::byte, 4>{}));
+}
+
+TEST_CASE("credit is granted as the queue is drained", "[receive]")
+{
+  ReceiveQueue<4> queue{};
+  const auto bytes = std::array{ std::byte{ 0 } };
+
+  // The whole queue is granted up front
+  REQUIRE(queue.credit() == Credit{ .received = 0U, .limit = 4U });
+  REQUIRE_FALSE(queue.poll_credit());
+
+  for (size_t count = 0UL; count < 4UL; ++count)
+  {
+    REQUIRE(queue.try_push(bytes));
+  }
+  // A single drained fragment is not worth a notification while more are queued...
+  queue.pop();
+  REQUIRE_FALSE(queue.poll_credit());
+  // ... but half of the queue is
+  queue.pop();
+  REQUIRE(queue.poll_credit() == Credit{ .received = 4U, .limit = 6U });
+  REQUIRE_FALSE(queue.poll_credit());
+
+  // Any credit held back is granted once the queue is empty
+  queue.pop();
+  REQUIRE_FALSE(queue.poll_credit());
+  queue.pop();
+  REQUIRE(queue.poll_credit() == Credit{ .received = 4U, .limit = 8U });
+
+  // A client which overruns its credit sees fewer fragments received than it sent
+  for (size_t count = 0UL; count < 5UL; ++count)
+  {
+    (void)queue.try_push(bytes);
+  }
+  REQUIRE(queue.credit().received == 8U);
+  REQUIRE(queue.overruns() == 1U);
+}
+
+TEST_CASE("counts wrap around", "[receive]")
+{
+  ReceiveQueue<2> queue{};
+  const auto bytes = std::array{ std::byte{ 0 } };
+  for (uint32_t count = 0U; count < 70'000U; ++count)
+  {
+    REQUIRE(queue.try_push(bytes));
+    queue.pop();
+    (void)queue.poll_credit();
+  }
+  REQUIRE(queue.credit() == Credit{ .received = static_cast<uint16_t>(70'000U),
+                                    .limit = static_cast<uint16_t>(70'002U) });
+}
+
+TEST_CASE("fragments pass intact between a producer and a consumer thread", "[receive]")
+{
+  constexpr uint32_t num_fragments = 100'000U;
+  ReceiveQueue<8, 8> queue{};
+
+  std::thread producer{ [&queue] {
+    for (uint32_t index = 0U; index < num_fragments;)
+    {
+      std::array<std::byte, 8> bytes{};
+      const auto size = (index % bytes.size()) + 1UL;
+      std::ranges::fill(std::span{ bytes }.first(size), static_cast<std::byte>(index));
+      if (queue.try_push(std::span{ bytes }.first(size)))
+      {
+        ++index;
+      }
+      else
+      {
+        std::this_thread::yield();
+      }
+    }
+  } };
+
+  uint32_t num_corrupt = 0U;
+  for (uint32_t index = 0U; index < num_fragments;)
+  {
+    const auto front = queue.front();
+    if (!front)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+    const bool intact = front->size() == (index % 8UL) + 1UL
+                        && std::ranges::all_of(*front, [index](std::byte byte) {
+                             return byte == static_cast<std::byte>(index);
+                           });
+    num_corrupt += intact ? 0U : 1U;
+    queue.pop();
+    ++index;
+  }
+  producer.join();
+
+  REQUIRE(num_corrupt == 0U);
+  REQUIRE(queue.empty());
+}
+
+TEST_CASE("writes with response wait for a slot while writes without response are dropped",
+          "[receive]")
+{
+  struct IgnoreCredit
+  {
+    void update(std::span<const std::byte>) noexcept {}
+  };
+
+  host::rtos::Scheduler scheduler{};
+  Stats stats{};
+  std::vector<uint8_t> decoded{};
+  auto on_write = [&](std::span<const std::byte> bytes) {
+    decoded.push_back(std::to_integer<uint8_t>(bytes[0]));
+  };
+
+  {
+    DecodeTask<4, decltype(on_write), IgnoreCredit> decode_task{ stats, on_write, 1U };
+
+    // The NimBLE host task, writing faster than the decode task drains the queue
+    auto ble = [&] {
+      for (uint8_t index = 0U; index < 12U; ++index)
+      {
+        decode_task(std::array{ std::byte{ index } });
+      }
+      // Let the decode task drain the queue
+      vTaskDelay(1U);
+      for (uint8_t index = 12U; index < 24U; ++index)
+      {
+        decode_task.without_response()(std::array{ std::byte{ index } });
+      }
+    };
+    (void)xTaskCreate(
+        [](void* body) {
+          (*static_cast<decltype(ble)*>(body))();
+          vTaskDelete(nullptr);
+        },
+        "ble",
+        4096U,
+        &ble,
+        20U,
+        nullptr);
+    scheduler.run_for(pdMS_TO_TICKS(100U));
+  }
+
+  // Every write with response is decoded, in order, but only as many writes without response as
+  // the queue holds
+  std::vector<uint8_t> expected(16UL);
+  std::iota(expected.begin(), expected.end(), uint8_t{ 0U });
+  REQUIRE(decoded == expected);
+  REQUIRE(stats.receive_overruns == 8U);
+}
+
+TEST_CASE("writing without response at least halves the latency of large climbs", "[receive]")
+{
+  // Climbs of several packets, each split into writes for the default ATT MTU
+  host::ClimbGenerator generator{ 3U, 60UL, 120UL };
+  std::vector<Placement> placements{};
+
+  const auto latency = [&](host::WriteMode mode) {
+    ReceiveQueue<8> queue{};
+    host::SimulatedLink link{ host::LinkTiming{}, queue };
+    protocol::Protocol protocol{};
+    Packet packet{};
+    uint32_t total_us = 0U;
+    size_t num_decoded = 0UL;
+    for (int climb = 0; climb < 20; ++climb)
+    {
+      generator.next(placements);
+      std::vector<std::byte> bytes{};
+      host::encode_climb(placements, bytes);
+      host::Writes writes{};
+      host::split(bytes, 23UL, writes);
+
+      total_us += link.send(writes, mode, [&](std::span<const std::byte> write) {
+        num_decoded += protocol.process(write, packet) ? 1UL : 0UL;
+      });
+    }
+    REQUIRE(num_decoded == 20UL);
+    REQUIRE(queue.overruns() == 0U);
+    return total_us;
+  };
+
+  const auto with_response = latency(host::WriteMode::with_response);
+  generator = host::ClimbGenerator{ 3U, 60UL, 120UL };
+  const auto without_response = latency(host::WriteMode::without_response);
+  REQUIRE(without_response * 2U <= with_response);
+}
+} // namespace luz::receive::test
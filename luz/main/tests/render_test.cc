@@ -0,0 +1,142 @@
+#include "render.hh"
+#include "scheduler.hh"
+
+#include <algorithm>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace luz::render::test
+{
+TEST_CASE("fixed-point color maths", "[color]")
+{
+  constexpr auto white = Color{ 255U, 255U, 255U };
+  constexpr auto black = Color{};
+
+  STATIC_REQUIRE(scale(white, 255U) == white);
+  STATIC_REQUIRE(scale(white, 127U) == Color{ 127U, 127U, 127U });
+  STATIC_REQUIRE(lerp(black, white, 0U) == black);
+  STATIC_REQUIRE(lerp(black, white, 256U) == white);
+  STATIC_REQUIRE(lerp(white, black, 128U) == Color{ 127U, 127U, 127U });
+}
+
+TEST_CASE("frame scheduler", "[scheduler]")
+{
+  auto scheduler = FrameScheduler{ 50U };
+  REQUIRE(scheduler.period_us() == 20'000U);
+  scheduler.start(1'000U);
+
+  SECTION("on time")
+  {
+    REQUIRE(scheduler.wait_us(0U) == 1'000U);
+    REQUIRE(scheduler.wait_us(1'000U) == 0U);
+    scheduler.complete(15'000U);
+    REQUIRE(scheduler.wait_us(15'000U) == 6'000U);
+    REQUIRE(scheduler.deadline_us() == 41'000U);
+    REQUIRE(scheduler.missed_deadlines() == 0U);
+    REQUIRE(scheduler.dropped_frames() == 0U);
+  }
+
+  SECTION("late by less than a period")
+  {
+    scheduler.complete(25'000U);
+    REQUIRE(scheduler.missed_deadlines() == 1U);
+    REQUIRE(scheduler.dropped_frames() == 0U);
+    REQUIRE(scheduler.wait_us(25'000U) == 0U);
+    REQUIRE(scheduler.deadline_us() == 41'000U);
+  }
+
+  SECTION("late by several periods")
+  {
+    scheduler.complete(65'000U);
+    REQUIRE(scheduler.missed_deadlines() == 1U);
+    REQUIRE(scheduler.dropped_frames() == 2U);
+    REQUIRE(scheduler.deadline_us() == 81'000U);
+  }
+
+  REQUIRE(scheduler.frames() == 1U);
+}
+
+TEST_CASE("palette", "[palette]")
+{
+  STATIC_REQUIRE(sizeof(Frame) == 3UL * sizeof(IndexedFrame));
+  STATIC_REQUIRE(palette[0x00] == Color{});
+  STATIC_REQUIRE(palette[0x1C] == PulseLayer::start_color);
+  STATIC_REQUIRE(palette[0xE3] == PulseLayer::finish_color);
+  STATIC_REQUIRE(palette[0xFF] == Color{ 224U, 224U, 192U });
+
+  for (size_t index = 0UL; index < palette.size(); ++index)
+  {
+    REQUIRE(palette_index(palette[index]) == index);
+  }
+
+  const auto indices = std::array<PaletteIndex, 3>{ 0x00, 0x1C, 0xE3 };
+  auto colors = std::array<Color, 3>{};
+  expand(indices, colors);
+  REQUIRE(colors == std::array{ Color{}, PulseLayer::start_color, PulseLayer::finish_color });
+}
+
+TEST_CASE("pipeline composes layers in order", "[pipeline]")
+{
+  auto pipeline = DefaultPipeline{};
+  auto climb = IndexedFrame{};
+  climb[1] = palette_index(PulseLayer::start_color);
+  climb[2] = palette_index(Color{ 0U, 0U, 192U });
+
+  auto frame = Frame{};
+  pipeline.layer<ClimbLayer>().show(climb, 0U);
+  pipeline.layer<PulseLayer>().show(climb, 0U);
+
+  SECTION("crossfade")
+  {
+    pipeline.compose(frame, ClimbLayer::crossfade_ms / 2U);
+    REQUIRE(frame[2] == Color{ 0U, 0U, 96U });
+    REQUIRE(pipeline.animating(0U));
+
+    pipeline.compose(frame, ClimbLayer::crossfade_ms);
+    REQUIRE(frame[2] == palette[climb[2]]);
+  }
+
+  SECTION("start hold pulses")
+  {
+    auto levels = std::vector<uint8_t>{};
+    for (uint32_t now = ClimbLayer::crossfade_ms; now < PulseLayer::period_ms * 2U; now += 50U)
+    {
+      pipeline.compose(frame, now);
+      REQUIRE(frame[2] == palette[climb[2]]);
+      levels.push_back(frame[1].g);
+    }
+    REQUIRE(std::ranges::max(levels) > std::ranges::min(levels));
+    REQUIRE(std::ranges::max(levels) <= palette[climb[1]].g);
+  }
+
+  SECTION("connection overlay")
+  {
+    const auto flashed_at = ClimbLayer::crossfade_ms;
+    pipeline.layer<ConnectionOverlay>().flash(true, flashed_at);
+    pipeline.compose(frame, flashed_at + ConnectionOverlay::duration_ms / 2U);
+    REQUIRE(frame[ConnectionOverlay::first_pixel] == ConnectionOverlay::connected_color);
+    REQUIRE(frame[2] == palette[climb[2]]);
+
+    pipeline.compose(frame, flashed_at + ConnectionOverlay::duration_ms);
+    REQUIRE(frame[ConnectionOverlay::first_pixel] == Color{});
+    REQUIRE_FALSE(
+        pipeline.layer<ConnectionOverlay>().active(flashed_at + ConnectionOverlay::duration_ms));
+  }
+
+  SECTION("error overlay")
+  {
+    pipeline.layer<ErrorOverlay>().trigger(ClimbLayer::crossfade_ms);
+    pipeline.compose(frame, ClimbLayer::crossfade_ms);
+    REQUIRE(frame[0] == ErrorOverlay::color);
+    REQUIRE(frame[2] == palette[climb[2]]);
+
+    pipeline.compose(frame, ClimbLayer::crossfade_ms + ErrorOverlay::blink_period_ms / 2U);
+    REQUIRE(frame[0] == Color{});
+
+    pipeline.compose(frame, ClimbLayer::crossfade_ms + ErrorOverlay::duration_ms);
+    REQUIRE(frame[0] == Color{});
+    REQUIRE_FALSE(pipeline.layer<ErrorOverlay>().active(ClimbLayer::crossfade_ms
+                                                        + ErrorOverlay::duration_ms));
+  }
+}
+} // namespace luz::render::test
@@ -0,0 +1,332 @@
+#include "decode_task.hh"
+#include "encoder.hh"
+#include "protocol.hh"
+#include "rtos.hh"
+#include "workload.hh"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace luz::host::rtos::test
+{
+/// Run body as a task; a task may not return, so it deletes itself once body has
+template <typename Body> TaskHandle_t spawn(const char* name, UBaseType_t priority, Body& body)
+{
+  TaskHandle_t handle{};
+  (void)xTaskCreate(
+      [](void* body) {
+        (*static_cast<Body*>(body))();
+        vTaskDelete(nullptr);
+      },
+      name,
+      4096U,
+      &body,
+      priority,
+      &handle);
+  return handle;
+}
+
+TEST_CASE("the ready task of the highest priority runs first", "[rtos]")
+{
+  Scheduler scheduler{};
+  std::string order{};
+  TaskHandle_t high_handle{};
+
+  auto high = [&] {
+    order += 'H';
+    (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    order += 'h';
+  };
+  auto low = [&] {
+    order += 'L';
+    // Readying a task of a higher priority hands it the processor at once
+    (void)xTaskNotifyGive(high_handle);
+    order += 'l';
+  };
+  auto other_low = [&] { order += 'O'; };
+
+  (void)spawn("low", 1U, low);
+  (void)spawn("other", 1U, other_low);
+  high_handle = spawn("high", 2U, high);
+  REQUIRE(order.empty());
+
+  scheduler.run_for(0U);
+  // Tasks of equal priority run in the order they became ready
+  REQUIRE(order == "HLhlO");
+  REQUIRE(scheduler.now() == 0U);
+}
+
+TEST_CASE("a task created by a task of a lower priority preempts it", "[rtos]")
+{
+  Scheduler scheduler{};
+  std::string order{};
+
+  auto child = [&] { order += 'c'; };
+  auto parent = [&] {
+    order += 'p';
+    (void)spawn("child", 3U, child);
+    order += 'P';
+  };
+  (void)spawn("parent", 1U, parent);
+  scheduler.run_for(0U);
+  REQUIRE(order == "pcP");
+}
+
+TEST_CASE("the clock advances only while every task is blocked", "[rtos]")
+{
+  Scheduler scheduler{};
+  std::vector<TickType_t> delayed{};
+  std::vector<TickType_t> periodic{};
+
+  auto delaying = [&] {
+    for (int count = 0; count < 3; ++count)
+    {
+      vTaskDelay(10U);
+      delayed.push_back(xTaskGetTickCount());
+    }
+  };
+  auto periodic_task = [&] {
+    auto last_wake = xTaskGetTickCount();
+    for (int count = 0; count < 4; ++count)
+    {
+      (void)xTaskDelayUntil(&last_wake, 7U);
+      periodic.push_back(xTaskGetTickCount());
+    }
+  };
+  (void)spawn("delaying", 1U, delaying);
+  (void)spawn("periodic", 2U, periodic_task);
+
+  scheduler.run_for(25U);
+  REQUIRE(scheduler.now() == 25U);
+  REQUIRE(delayed == std::vector<TickType_t>{ 10U, 20U });
+  REQUIRE(periodic == std::vector<TickType_t>{ 7U, 14U, 21U });
+
+  scheduler.run_for(100U);
+  REQUIRE(scheduler.now() == 125U);
+  REQUIRE(delayed == std::vector<TickType_t>{ 10U, 20U, 30U });
+  REQUIRE(periodic == std::vector<TickType_t>{ 7U, 14U, 21U, 28U });
+}
+
+TEST_CASE("queues hand items over between tasks and time out", "[rtos]")
+{
+  Scheduler scheduler{};
+  auto* queue = xQueueCreate(2U, sizeof(uint32_t));
+  std::vector<std::pair<uint32_t, TickType_t>> received{};
+  BaseType_t timed_out_send = pdPASS;
+  TickType_t timed_out_at{};
+
+  auto producer = [&] {
+    for (uint32_t item = 1U; item <= 4U; ++item)
+    {
+      // Blocks once the queue holds two items, until the consumer takes one
+      (void)xQueueSend(queue, &item, portMAX_DELAY);
+    }
+    vTaskDelay(5U);
+    const uint32_t item = 5U;
+    (void)xQueueSend(queue, &item, portMAX_DELAY);
+  };
+  auto consumer = [&] {
+    for (int count = 0; count < 5; ++count)
+    {
+      uint32_t item{};
+      if (xQueueReceive(queue, &item, portMAX_DELAY) == pdPASS)
+      {
+        received.emplace_back(item, xTaskGetTickCount());
+      }
+      vTaskDelay(1U);
+    }
+
+    uint32_t item{};
+    if (xQueueReceive(queue, &item, 3U) == pdFAIL)
+    {
+      timed_out_at = xTaskGetTickCount();
+    }
+    const uint32_t fill = 0U;
+    (void)xQueueSend(queue, &fill, 0U);
+    (void)xQueueSend(queue, &fill, 0U);
+    timed_out_send = xQueueSend(queue, &fill, 2U);
+  };
+  (void)spawn("producer", 1U, producer);
+  (void)spawn("consumer", 2U, consumer);
+
+  scheduler.run_for(50U);
+  REQUIRE(received
+          == std::vector<std::pair<uint32_t, TickType_t>>{
+              { 1U, 0U }, { 2U, 1U }, { 3U, 2U }, { 4U, 3U }, { 5U, 6U } });
+  REQUIRE(timed_out_at == 10U);
+  REQUIRE(timed_out_send == pdFAIL);
+  REQUIRE(uxQueueMessagesWaiting(queue) == 2U);
+  vQueueDelete(queue);
+}
+
+TEST_CASE("notifications are counted and taken from outside the tasks", "[rtos]")
+{
+  Scheduler scheduler{};
+  std::vector<uint32_t> taken{};
+
+  auto waiting = [&] {
+    for (int count = 0; count < 2; ++count)
+    {
+      taken.push_back(ulTaskNotifyTake(pdFALSE, portMAX_DELAY));
+    }
+    taken.push_back(ulTaskNotifyTake(pdTRUE, 10U));
+    taken.push_back(ulTaskNotifyTake(pdTRUE, 10U));
+  };
+  auto* handle = spawn("waiting", 1U, waiting);
+
+  // Given from the driving thread, as from an interrupt; the task runs once the scheduler does
+  (void)xTaskNotifyGive(handle);
+  (void)xTaskNotifyGive(handle);
+  (void)xTaskNotifyGive(handle);
+  REQUIRE(taken.empty());
+
+  scheduler.run_for(20U);
+  REQUIRE(taken == std::vector<uint32_t>{ 3U, 2U, 1U, 0U });
+  REQUIRE(scheduler.now() == 20U);
+}
+
+TEST_CASE("a mutex excludes the other tasks until it is given", "[rtos]")
+{
+  Scheduler scheduler{};
+  auto* mutex = xSemaphoreCreateMutex();
+  std::string order{};
+
+  auto holder = [&] {
+    (void)xSemaphoreTake(mutex, portMAX_DELAY);
+    order += 'a';
+    vTaskDelay(5U);
+    order += 'b';
+    (void)xSemaphoreGive(mutex);
+  };
+  TickType_t acquired_at{};
+  auto waiter = [&] {
+    vTaskDelay(1U);
+    REQUIRE(xSemaphoreTake(mutex, 0U) == pdFAIL);
+    (void)xSemaphoreTake(mutex, portMAX_DELAY);
+    acquired_at = xTaskGetTickCount();
+    order += 'c';
+    (void)xSemaphoreGive(mutex);
+  };
+  (void)spawn("holder", 1U, holder);
+  (void)spawn("waiter", 2U, waiter);
+
+  scheduler.run_for(10U);
+  // The waiter, of a higher priority, takes the mutex as soon as it is given
+  REQUIRE(order == "abc");
+  REQUIRE(acquired_at == 5U);
+  vSemaphoreDelete(mutex);
+}
+
+/// Latency in ticks of each climb sent over BLE, through the receive queue and decode task of
+/// the firmware, and the time taken to send it
+struct Pipeline
+{
+  /// From the first connection event of a climb until the render task shows it
+  std::vector<TickType_t> latencies{};
+  /// From the first to the last connection event of a climb
+  std::vector<TickType_t> transfers{};
+
+  friend bool operator==(const Pipeline& lhs, const Pipeline& rhs) = default;
+};
+
+constexpr TickType_t connection_interval = pdMS_TO_TICKS(15U);
+constexpr TickType_t frame_period = pdMS_TO_TICKS(16U);
+constexpr size_t num_climbs = 10UL;
+
+Pipeline run_pipeline()
+{
+  constexpr size_t writes_per_event = 4UL;
+
+  struct CreditLog
+  {
+    void update(std::span<const std::byte>) noexcept { ++num_updates; }
+    size_t num_updates{};
+  };
+
+  Scheduler scheduler{};
+  Stats stats{};
+  protocol::Protocol protocol{};
+  size_t decoded{};
+  auto on_write = [&](std::span<const std::byte> bytes) {
+    Packet packet{};
+    decoded += protocol.process(bytes, packet) ? 1UL : 0UL;
+  };
+  CreditLog credit_log{};
+  std::vector<TickType_t> sent_at{};
+  Pipeline pipeline{};
+
+  {
+    receive::DecodeTask<8, decltype(on_write), CreditLog> decode_task{ stats, on_write, 5U };
+    decode_task.report_credit_to(credit_log);
+
+    // The NimBLE host task, passing on the writes of each connection event
+    auto ble = [&] {
+      host::ClimbGenerator generator{ 7U, 20UL, 120UL };
+      std::vector<Placement> placements{};
+      for (size_t climb = 0UL; climb < num_climbs; ++climb)
+      {
+        generator.next(placements);
+        std::vector<std::byte> bytes{};
+        host::encode_climb(placements, bytes);
+        host::Writes writes{};
+        host::split(bytes, 23UL, writes);
+
+        sent_at.push_back(xTaskGetTickCount());
+        for (size_t index = 0UL; index < writes.size(); ++index)
+        {
+          if (index > 0UL && index % writes_per_event == 0UL)
+          {
+            vTaskDelay(connection_interval);
+          }
+          decode_task(writes[index]);
+        }
+        pipeline.transfers.push_back(xTaskGetTickCount() - sent_at.back());
+        vTaskDelay(connection_interval);
+      }
+    };
+    auto render = [&] {
+      auto last_wake = xTaskGetTickCount();
+      for (size_t shown = 0UL; shown < num_climbs;)
+      {
+        (void)xTaskDelayUntil(&last_wake, frame_period);
+        for (; shown < decoded; ++shown)
+        {
+          pipeline.latencies.push_back(xTaskGetTickCount() - sent_at[shown]);
+        }
+      }
+    };
+    (void)spawn("ble", 20U, ble);
+    (void)spawn("render", 1U, render);
+    scheduler.run_for(pdMS_TO_TICKS(10'000U));
+  }
+
+  REQUIRE(decoded == num_climbs);
+  REQUIRE(stats.receive_overruns == 0U);
+  REQUIRE(credit_log.num_updates > 0UL);
+  return pipeline;
+}
+
+TEST_CASE("latencies through the receive pipeline are measured deterministically", "[rtos]")
+{
+  const auto pipeline = run_pipeline();
+  REQUIRE(pipeline.latencies.size() == num_climbs);
+  REQUIRE(pipeline.transfers.size() == num_climbs);
+  // Each climb is decoded as its last write arrives, and shown by the next frame
+  for (size_t climb = 0UL; climb < num_climbs; ++climb)
+  {
+    REQUIRE(pipeline.latencies[climb] >= pipeline.transfers[climb]);
+    REQUIRE(pipeline.latencies[climb] <= pipeline.transfers[climb] + frame_period);
+  }
+  REQUIRE(run_pipeline() == pipeline);
+}
+} // namespace luz::host::rtos::test
@@ -0,0 +1,116 @@
+#include "protocol.hh"
+#include "status.hh"
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace luz::protocol::test
+{
+/// Host stand-in for the NOTIFY characteristic, recording each notification
+struct RecordingSink
+{
+  void notify(std::span<const std::byte> bytes)
+  {
+    FrameStatus record{};
+    REQUIRE(bytes.size() == FrameStatusLayout::size);
+    REQUIRE(FrameStatusLayout::decode(bytes, record));
+    records.push_back(record);
+  }
+
+  std::vector<FrameStatus> records{};
+};
+
+constexpr auto single_hold = std::array{ std::byte{ 0x01 }, std::byte{ 0x04 }, std::byte{ 0xA1 },
+                                         std::byte{ 0x02 }, std::byte{ 0x54 }, std::byte{ 0x29 },
+                                         std::byte{ 0x01 }, std::byte{ 0xE0 }, std::byte{ 0x03 } };
+
+TEST_CASE("frame status layout", "[status]")
+{
+  STATIC_REQUIRE(FrameStatusLayout::size == 7UL);
+
+  constexpr auto record = FrameStatus{ .sequence = 0x1234U,
+                                       .status = ProtocolStatus::bad_checksum,
+                                       .decode_us = 850U,
+                                       .render_us = 12U };
+  std::array<std::byte, FrameStatusLayout::size> bytes{};
+  FrameStatusLayout::encode(record, bytes);
+  REQUIRE(bytes[0] == std::byte{ 0x34 });
+  REQUIRE(bytes[1] == std::byte{ 0x12 });
+  REQUIRE(bytes[2] == std::byte{ static_cast<uint8_t>(ProtocolStatus::bad_checksum) });
+
+  FrameStatus decoded{};
+  REQUIRE(FrameStatusLayout::decode(bytes, decoded));
+  REQUIRE(decoded == record);
+
+  bytes[2] = std::byte{ 0xFF };
+  REQUIRE_FALSE(FrameStatusLayout::decode(bytes, decoded));
+}
+
+TEST_CASE("status reporter", "[status]")
+{
+  RecordingSink sink{};
+  StatusReporter<RecordingSink> reporter{};
+
+  SECTION("reports are dropped until a sink is attached")
+  {
+    reporter.report(ProtocolStatus::success, 1U, 1U);
+    REQUIRE(sink.records.empty());
+
+    reporter.attach(sink);
+    reporter.report(ProtocolStatus::success, 1U, 1U);
+    REQUIRE(sink.records.size() == 1UL);
+    REQUIRE(sink.records[0].sequence == 1U);
+  }
+
+  SECTION("times saturate")
+  {
+    reporter.attach(sink);
+    reporter.report(ProtocolStatus::success, 100'000U, 70'000U);
+    REQUIRE(sink.records[0].decode_us == UINT16_MAX);
+    REQUIRE(sink.records[0].render_us == UINT16_MAX);
+  }
+}
+
+TEST_CASE("protocol statuses drive notifications", "[status]")
+{
+  RecordingSink sink{};
+  StatusReporter<RecordingSink> reporter{};
+  reporter.attach(sink);
+  Protocol protocol{};
+
+  const auto process = [&](std::span<const std::byte> bytes) {
+    Packet packet{};
+    const bool decoded = protocol.process(bytes, packet);
+    for (const auto status : protocol.statuses())
+    {
+      reporter.report(status, 10U, status == ProtocolStatus::success ? 5U : 0U);
+    }
+    return decoded;
+  };
+
+  // The tail of a frame whose start was lost is rejected straight away
+  REQUIRE_FALSE(process(std::span(single_hold).subspan(4UL)));
+  REQUIRE(sink.records.size() == 1UL);
+  REQUIRE(sink.records[0].status == ProtocolStatus::bad_header);
+
+  // A frame split across writes is only reported once complete
+  REQUIRE_FALSE(process(std::span(single_hold).first(6UL)));
+  REQUIRE(sink.records.size() == 1UL);
+  REQUIRE(process(std::span(single_hold).subspan(6UL)));
+  REQUIRE(sink.records.size() == 2UL);
+  REQUIRE(sink.records[1] == FrameStatus{ 1U, ProtocolStatus::success, 10U, 5U });
+
+  // A corrupted frame is rejected so the client can retransmit at once
+  auto corrupted = single_hold;
+  corrupted[2] = std::byte{ 0x00 };
+  REQUIRE_FALSE(process(corrupted));
+  REQUIRE(sink.records.size() == 3UL);
+  REQUIRE(sink.records[2].sequence == 2U);
+  REQUIRE(sink.records[2].status == ProtocolStatus::bad_checksum);
+  REQUIRE(process(single_hold));
+  REQUIRE(sink.records.back().status == ProtocolStatus::success);
+}
+} // namespace luz::protocol::test
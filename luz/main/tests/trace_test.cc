@@ -0,0 +1,98 @@
+#include "decoder.hh"
+#include "protocol.hh"
+#include "trace.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace luz::trace::test
+{
+// A single hold climb
+constexpr auto climb = std::array{ std::byte{ 0x01 }, std::byte{ 0x04 }, std::byte{ 0xA1 },
+                                   std::byte{ 0x02 }, std::byte{ 0x54 }, std::byte{ 0x29 },
+                                   std::byte{ 0x01 }, std::byte{ 0xE0 }, std::byte{ 0x03 } };
+
+constexpr bool decodes_at_compile_time()
+{
+  Packet::Header header{};
+  std::vector<Placement> placements{};
+  return protocol::decode(climb, header, placements) == protocol::ProtocolStatus::success
+         && placements.size() == 1UL;
+}
+
+std::string chrome_json()
+{
+  std::FILE* file = std::tmpfile();
+  write_chrome_json(file);
+  std::string json(static_cast<size_t>(std::ftell(file)), '\0');
+  std::rewind(file);
+  json.resize(std::fread(json.data(), 1UL, json.size(), file));
+  std::fclose(file);
+  return json;
+}
+
+size_t count(std::string_view text, std::string_view pattern)
+{
+  size_t found = 0UL;
+  for (auto pos = text.find(pattern); pos != std::string_view::npos;
+       pos = text.find(pattern, pos + 1UL))
+  {
+    ++found;
+  }
+  return found;
+}
+
+TEST_CASE("processing a climb is traced", "[trace]")
+{
+  clear();
+  protocol::Protocol protocol{};
+  Packet packet{};
+  REQUIRE_FALSE(protocol.process(std::span(climb).first(6UL), packet));
+  REQUIRE(protocol.process(std::span(climb).subspan(6UL), packet));
+
+  const auto json = chrome_json();
+  REQUIRE(count(json, "\"name\":\"Protocol::process\"") == 2UL);
+  REQUIRE(count(json, "\"name\":\"BufferList::push_back\"") == 2UL);
+  // Both the write and the buffer it is appended to record its size
+  REQUIRE(count(json, "\"args\":{\"bytes\":6}") == 2UL);
+  REQUIRE(count(json, "\"args\":{\"bytes\":3}") == 2UL);
+  // The first write is incomplete and the second decodes successfully
+  REQUIRE(count(json, "\"name\":\"protocol::decode\"") == 2UL);
+  REQUIRE(count(json, "\"args\":{\"status\":1}") == 1UL);
+  REQUIRE(count(json, "\"args\":{\"status\":0}") == 1UL);
+  REQUIRE(count(json, "\"ph\":\"X\"") == size());
+  REQUIRE(json.starts_with("{\"traceEvents\":["));
+  REQUIRE(json.ends_with("\"otherData\":{\"dropped\":0}}\n"));
+  REQUIRE(std::ranges::count(json, '{') == std::ranges::count(json, '}'));
+}
+
+TEST_CASE("scopes are not recorded during constant evaluation", "[trace][constexpr]")
+{
+  clear();
+  STATIC_REQUIRE(decodes_at_compile_time());
+  REQUIRE(size() == 0UL);
+}
+
+TEST_CASE("events beyond the capacity are dropped", "[trace]")
+{
+  clear();
+  for (size_t i = 0UL; i < capacity + 10UL; ++i)
+  {
+    LUZ_TRACE_SCOPE(scope, "event");
+  }
+  REQUIRE(size() == capacity);
+  REQUIRE(dropped() == 10UL);
+  REQUIRE(count(chrome_json(), "\"otherData\":{\"dropped\":10}") == 1UL);
+
+  clear();
+  REQUIRE(size() == 0UL);
+  REQUIRE(dropped() == 0UL);
+}
+} // namespace luz::trace::test
@@ -0,0 +1,283 @@
+#include "file_partition.hh"
+#include "upload.hh"
+
+#include <array>
+#include <cstdio>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace luz::upload::test
+{
+constexpr auto path = "upload_test.bin";
+/// Two slots of two sectors each
+constexpr size_t partition_size = 4UL * sector_size;
+
+/// The characters of text as bytes, usable in constant expressions unlike std::as_bytes
+template <size_t N> constexpr std::array<std::byte, N - 1UL> as_bytes(const char (&text)[N])
+{
+  std::array<std::byte, N - 1UL> bytes{};
+  for (size_t index = 0UL; index < bytes.size(); ++index)
+  {
+    bytes[index] = static_cast<std::byte>(text[index]);
+  }
+  return bytes;
+}
+
+static_assert(crc32(as_bytes("123456789")) == 0xCBF43926U);
+static_assert(crc32(as_bytes("56789"), crc32(as_bytes("1234"))) == crc32(as_bytes("123456789")));
+
+/// A layout blob mapping each position to the pixel of table
+std::vector<std::byte> make_blob(std::span<const int16_t> table,
+                                 uint16_t layout_version,
+                                 uint16_t num_leds = database::num_leds)
+{
+  std::vector<std::byte> blob(BlobHeaderLayout::size + table_size(table.size()));
+  const auto table_bytes = std::span(blob).subspan(BlobHeaderLayout::size);
+  for (size_t position = 0UL; position < table.size(); ++position)
+  {
+    Field<int16_t>{ position * sizeof(int16_t) }.write(table_bytes, table[position]);
+  }
+  const auto header = BlobHeader{ .layout_version = layout_version,
+                                  .num_positions = static_cast<uint16_t>(table.size()),
+                                  .num_leds = num_leds,
+                                  .crc = crc32(table_bytes) };
+  BlobHeaderLayout::encode(header, blob);
+  return blob;
+}
+
+/// The chunk of blob at offset, holding at most size bytes
+std::vector<std::byte> make_chunk(std::span<const std::byte> blob, uint32_t offset, size_t size)
+{
+  std::vector<std::byte> chunk(ChunkLayout::size);
+  ChunkLayout::encode(Chunk{ offset }, chunk);
+  const auto data = blob.subspan(offset, std::min(size, blob.size() - offset));
+  chunk.insert(chunk.end(), data.begin(), data.end());
+  return chunk;
+}
+
+/// Send blob in chunks of chunk_size bytes, stopping early on anything but in_progress
+template <Partition P>
+UploadReply
+upload(LayoutStore<P>& store, std::span<const std::byte> blob, size_t chunk_size = 20UL)
+{
+  auto reply = UploadReply{};
+  for (uint32_t offset = 0U; offset < blob.size(); offset = reply.next_offset)
+  {
+    reply = store.receive(make_chunk(blob, offset, chunk_size));
+    if (reply.status != UploadStatus::in_progress)
+    {
+      break;
+    }
+  }
+  return reply;
+}
+
+template <Partition P>
+std::optional<uint16_t> pixel_of(const LayoutStore<P>& store, uint16_t position)
+{
+  uint16_t pixel{};
+  if (!store.placement_to_pixel(position, pixel))
+  {
+    return std::nullopt;
+  }
+  return pixel;
+}
+
+constexpr auto first_table = std::array<int16_t, 40>{ 7, -1, 3, 0, 12, 5, 6, -1, 9, 1 };
+constexpr auto second_table = std::array<int16_t, 3>{ 2, 1, 0 };
+
+TEST_CASE("a layout streamed in chunks replaces the compiled-in table", "[upload]")
+{
+  std::remove(path);
+  host::FilePartition partition{ path, partition_size };
+  REQUIRE(partition.bytes().size() == partition_size);
+  LayoutStore store{ partition };
+
+  // Until a layout is uploaded, positions map through the compiled-in table
+  REQUIRE_FALSE(store.active());
+  for (uint16_t position = 0U; position < database::num_positions; ++position)
+  {
+    uint16_t expected{};
+    const bool mapped = database::placement_to_pixel(position, expected);
+    REQUIRE(pixel_of(store, position) == (mapped ? std::optional{ expected } : std::nullopt));
+  }
+
+  const auto blob = make_blob(first_table, 3U);
+  REQUIRE(upload(store, blob, 7UL) == UploadReply{ UploadStatus::complete,
+                                                     static_cast<uint32_t>(blob.size()) });
+
+  const auto active = store.active();
+  REQUIRE(active);
+  REQUIRE(active->generation == 1U);
+  REQUIRE(active->blob.layout_version == 3U);
+  REQUIRE(active->blob.num_positions == first_table.size());
+  REQUIRE(pixel_of(store, 0U) == 7U);
+  REQUIRE(pixel_of(store, 4U) == 12U);
+  REQUIRE_FALSE(pixel_of(store, 1U));
+  REQUIRE_FALSE(pixel_of(store, first_table.size()));
+  std::remove(path);
+}
+
+TEST_CASE("chunks out of order are rejected without losing the upload", "[upload]")
+{
+  std::remove(path);
+  host::FilePartition partition{ path, partition_size };
+  LayoutStore store{ partition };
+  const auto blob = make_blob(first_table, 1U);
+
+  // Nothing is expected before an upload starts at offset 0
+  REQUIRE(store.receive(make_chunk(blob, 20U, 20UL))
+          == UploadReply{ UploadStatus::out_of_order, 0U });
+
+  REQUIRE(store.receive(make_chunk(blob, 0U, 20UL))
+          == UploadReply{ UploadStatus::in_progress, 20U });
+  REQUIRE(store.receive(make_chunk(blob, 20U, 20UL))
+          == UploadReply{ UploadStatus::in_progress, 40U });
+  // A lost chunk, then a retransmission of one already written
+  REQUIRE(store.receive(make_chunk(blob, 60U, 20UL))
+          == UploadReply{ UploadStatus::out_of_order, 40U });
+  REQUIRE(store.receive(make_chunk(blob, 20U, 20UL))
+          == UploadReply{ UploadStatus::out_of_order, 40U });
+  // A chunk too short to hold its offset
+  REQUIRE(store.receive(std::array{ std::byte{ 0x28 } })
+          == UploadReply{ UploadStatus::out_of_order, 40U });
+
+  // The client resumes from the offset it was told
+  auto reply = UploadReply{ UploadStatus::in_progress, 40U };
+  while (reply.status == UploadStatus::in_progress)
+  {
+    reply = store.receive(make_chunk(blob, reply.next_offset, 20UL));
+  }
+  REQUIRE(reply.status == UploadStatus::complete);
+  REQUIRE(pixel_of(store, 9U) == 1U);
+  std::remove(path);
+}
+
+TEST_CASE("invalid layouts are rejected", "[upload]")
+{
+  std::remove(path);
+  host::FilePartition partition{ path, partition_size };
+  LayoutStore store{ partition };
+
+  SECTION("not a layout")
+  {
+    auto blob = make_blob(first_table, 1U);
+    blob[0] = std::byte{ 'X' };
+    REQUIRE(upload(store, blob).status == UploadStatus::bad_header);
+  }
+  SECTION("too large for a slot")
+  {
+    const auto table = std::vector<int16_t>(2UL * sector_size, -1);
+    REQUIRE(upload(store, make_blob(table, 1U)).status == UploadStatus::bad_header);
+  }
+  SECTION("more LEDs than the strip")
+  {
+    const auto blob = make_blob(first_table, 1U, database::num_leds + 1U);
+    REQUIRE(upload(store, blob).status == UploadStatus::bad_header);
+  }
+  SECTION("a pixel beyond the LEDs of the layout")
+  {
+    const auto blob = make_blob(first_table, 1U, 10U);
+    REQUIRE(upload(store, blob).status == UploadStatus::bad_table);
+  }
+  SECTION("corrupted in transit")
+  {
+    auto blob = make_blob(first_table, 1U);
+    blob.back() ^= std::byte{ 0x01 };
+    REQUIRE(upload(store, blob).status == UploadStatus::bad_table);
+  }
+
+  // The rejected upload is abandoned and the compiled-in table kept
+  REQUIRE_FALSE(store.active());
+  REQUIRE(store.receive(make_chunk(make_blob(first_table, 1U), 20U, 20UL))
+          == UploadReply{ UploadStatus::out_of_order, 0U });
+  std::remove(path);
+}
+
+TEST_CASE("uploads alternate between the slots and survive a restart", "[upload]")
+{
+  std::remove(path);
+  {
+    host::FilePartition partition{ path, partition_size };
+    LayoutStore store{ partition };
+    REQUIRE(upload(store, make_blob(first_table, 1U)).status == UploadStatus::complete);
+    REQUIRE(upload(store, make_blob(second_table, 2U)).status == UploadStatus::complete);
+    REQUIRE(store.active()->generation == 2U);
+    // Both slots now hold a valid layout
+    SlotHeader header{};
+    LayoutTable table{};
+    REQUIRE(LayoutTable::try_make(partition.bytes().first(2UL * sector_size), header, table));
+    REQUIRE(header.blob.layout_version == 1U);
+  }
+
+  {
+    // The most recent generation is used after a restart, whichever slot holds it
+    host::FilePartition partition{ path, partition_size };
+    LayoutStore store{ partition };
+    REQUIRE(store.active()->blob.layout_version == 2U);
+    REQUIRE(pixel_of(store, 0U) == 2U);
+    REQUIRE_FALSE(pixel_of(store, 3U));
+
+    REQUIRE(upload(store, make_blob(first_table, 3U)).status == UploadStatus::complete);
+    REQUIRE(store.active()->generation == 3U);
+  }
+
+  host::FilePartition partition{ path, partition_size };
+  LayoutStore store{ partition };
+  REQUIRE(store.active()->blob.layout_version == 3U);
+  REQUIRE(pixel_of(store, 0U) == 7U);
+  std::remove(path);
+}
+
+TEST_CASE("an interrupted upload keeps the active layout", "[upload]")
+{
+  std::remove(path);
+  const auto blob = make_blob(second_table, 2U);
+  {
+    host::FilePartition partition{ path, partition_size };
+    LayoutStore store{ partition };
+    REQUIRE(upload(store, make_blob(first_table, 1U)).status == UploadStatus::complete);
+
+    // Every byte of the table reaches flash, but the connection drops before the last
+    for (uint32_t offset = 0U; offset + 1U < blob.size(); ++offset)
+    {
+      REQUIRE(store.receive(make_chunk(blob, offset, 1UL)).status == UploadStatus::in_progress);
+    }
+    REQUIRE(store.active()->blob.layout_version == 1U);
+    REQUIRE(pixel_of(store, 0U) == 7U);
+  }
+
+  // Without its header the partially written slot is ignored after a restart
+  host::FilePartition partition{ path, partition_size };
+  LayoutStore store{ partition };
+  REQUIRE(store.active()->blob.layout_version == 1U);
+  REQUIRE(pixel_of(store, 0U) == 7U);
+  std::remove(path);
+}
+
+TEST_CASE("a layout is only read from a slot with a valid header", "[upload]")
+{
+  std::remove(path);
+  host::FilePartition partition{ path, partition_size };
+  {
+    LayoutStore store{ partition };
+    REQUIRE(upload(store, make_blob(first_table, 1U)).status == UploadStatus::complete);
+  }
+
+  // Erasing the slot, as the next upload to it does, leaves no layout to read
+  REQUIRE(partition.erase(0UL, sector_size));
+  SlotHeader header{};
+  LayoutTable table{};
+  REQUIRE_FALSE(LayoutTable::try_make(partition.bytes(), header, table));
+  REQUIRE_FALSE(LayoutStore{ partition }.active());
+
+  // Erase and write keep to the partition and its sectors
+  REQUIRE_FALSE(partition.erase(1UL, sector_size));
+  REQUIRE_FALSE(partition.erase(partition_size, sector_size));
+  REQUIRE_FALSE(partition.write(partition_size - 1UL, std::array<std::byte, 2>{}));
+  std::remove(path);
+}
+} // namespace luz::upload::test
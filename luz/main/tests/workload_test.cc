@@ -0,0 +1,200 @@
+#include "encoder.hh"
+#include "protocol.hh"
+#include "validate.hh"
+#include "workload.hh"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <set>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace luz::host::test
+{
+// The ten hold climb "Wilbur Wright takes flight" as sent by the Aurora app
+constexpr auto wilbur_wright_takes_flight = std::array{
+  std::byte{ 0x01 }, std::byte{ 0x1F }, std::byte{ 0xD6 }, std::byte{ 0x02 }, std::byte{ 0x54 },
+  std::byte{ 0x29 }, std::byte{ 0x01 }, std::byte{ 0xE0 }, std::byte{ 0x6C }, std::byte{ 0x00 },
+  std::byte{ 0xE3 }, std::byte{ 0x8D }, std::byte{ 0x01 }, std::byte{ 0x03 }, std::byte{ 0x12 },
+  std::byte{ 0x01 }, std::byte{ 0x1C }, std::byte{ 0xAA }, std::byte{ 0x00 }, std::byte{ 0x1C },
+  std::byte{ 0xEC }, std::byte{ 0x00 }, std::byte{ 0x03 }, std::byte{ 0x0F }, std::byte{ 0x01 },
+  std::byte{ 0x03 }, std::byte{ 0x34 }, std::byte{ 0x01 }, std::byte{ 0xE3 }, std::byte{ 0x7C },
+  std::byte{ 0x01 }, std::byte{ 0xE3 }, std::byte{ 0x78 }, std::byte{ 0x01 }, std::byte{ 0x03 },
+  std::byte{ 0x03 },
+};
+
+TEST_CASE("packets are encoded as the Aurora app sends them", "[workload]")
+{
+  std::vector<Placement> placements{};
+  Packet::Header header{};
+  REQUIRE(protocol::decode(wilbur_wright_takes_flight, header, placements)
+          == protocol::ProtocolStatus::success);
+
+  std::vector<std::byte> bytes{};
+  encode(placements, IndexMarker::solo, bytes);
+  REQUIRE(std::ranges::equal(bytes, wilbur_wright_takes_flight));
+
+  // Encoding appends
+  encode(placements, IndexMarker::solo, bytes);
+  REQUIRE(bytes.size() == 2UL * wilbur_wright_takes_flight.size());
+}
+
+TEST_CASE("climbs larger than a packet are split across packets", "[workload]")
+{
+  ClimbGenerator generator{ 7U, 200UL, 200UL };
+  std::vector<Placement> placements{};
+  generator.next(placements);
+
+  std::vector<std::byte> bytes{};
+  encode_climb(placements, bytes);
+
+  std::vector<Placement> scratch{};
+  const auto report = validate(bytes, scratch);
+  REQUIRE(report.valid());
+  REQUIRE(report.num_packets == 3UL);
+  REQUIRE(report.num_placements == 200UL);
+
+  Packet::Header header{};
+  REQUIRE(protocol::decode(bytes, header, scratch) == protocol::ProtocolStatus::success);
+  REQUIRE(header.index_marker == IndexMarker::first);
+  REQUIRE(std::ranges::equal(scratch, std::span(placements).first(max_placements_per_packet)));
+}
+
+TEST_CASE("generated climbs", "[workload]")
+{
+  ClimbGenerator generator{ 42U };
+  ClimbGenerator same_seed{ 42U };
+  std::vector<Placement> placements{};
+  std::vector<Placement> repeated{};
+
+  for (size_t climb = 0UL; climb < 1000UL; ++climb)
+  {
+    generator.next(placements);
+    same_seed.next(repeated);
+    REQUIRE(placements == repeated);
+    REQUIRE(placements.size() >= 4UL);
+    REQUIRE(placements.size() <= 20UL);
+
+    std::set<uint16_t> positions{};
+    for (const auto& placement : placements)
+    {
+      uint16_t pixel = 0U;
+      REQUIRE(database::placement_to_pixel(placement.position, pixel));
+      positions.insert(placement.position);
+    }
+    REQUIRE(positions.size() == placements.size());
+    REQUIRE(placements.front().color == start_color);
+    REQUIRE(std::ranges::count(placements, finish_color, &Placement::color) >= 1L);
+  }
+}
+
+TEST_CASE("climbs are split into writes for the MTU", "[workload]")
+{
+  Writes writes{};
+  split(wilbur_wright_takes_flight, 23UL, writes);
+  REQUIRE(writes.size() == 2UL);
+  REQUIRE(writes[0].size() == 20UL);
+  REQUIRE(writes[1].size() == 16UL);
+  REQUIRE(writes.num_bytes() == wilbur_wright_takes_flight.size());
+
+  std::vector<std::byte> joined{};
+  for (size_t index = 0UL; index < writes.size(); ++index)
+  {
+    joined.insert(joined.end(), writes[index].begin(), writes[index].end());
+  }
+  REQUIRE(std::ranges::equal(joined, wilbur_wright_takes_flight));
+}
+
+TEST_CASE("faults injected into writes", "[workload]")
+{
+  const auto write = std::span(wilbur_wright_takes_flight).first(20UL);
+  Writes writes{};
+
+  SECTION("a perfect link")
+  {
+    FaultInjector link{ 1U, FaultRates{} };
+    link.transmit(write, writes);
+    REQUIRE(writes.size() == 1UL);
+    REQUIRE(std::ranges::equal(writes[0], write));
+  }
+
+  SECTION("drop")
+  {
+    FaultInjector link{ 1U, FaultRates{ .drop = 1.0 } };
+    link.transmit(write, writes);
+    REQUIRE(writes.empty());
+    REQUIRE(link.counts().dropped == 1UL);
+  }
+
+  SECTION("duplicate")
+  {
+    FaultInjector link{ 1U, FaultRates{ .duplicate = 1.0 } };
+    link.transmit(write, writes);
+    REQUIRE(writes.size() == 2UL);
+    REQUIRE(std::ranges::equal(writes[0], write));
+    REQUIRE(std::ranges::equal(writes[1], write));
+  }
+
+  SECTION("corrupt")
+  {
+    FaultInjector link{ 1U, FaultRates{ .corrupt = 1.0 } };
+    link.transmit(write, writes);
+    REQUIRE(writes.size() == 1UL);
+
+    size_t flipped = 0UL;
+    for (size_t index = 0UL; index < write.size(); ++index)
+    {
+      flipped += static_cast<size_t>(
+          std::popcount(std::to_integer<uint8_t>(writes[0][index] ^ write[index])));
+    }
+    REQUIRE(flipped == 1UL);
+  }
+}
+
+TEST_CASE("the protocol recovers from dropped and duplicated writes", "[workload]")
+{
+  constexpr size_t num_climbs = 2000UL;
+  ClimbGenerator generator{ 3U };
+  FaultInjector link{ 4U, FaultRates{ .drop = 0.05, .duplicate = 0.05 } };
+  std::vector<Placement> placements{};
+  std::vector<std::byte> bytes{};
+  Writes sent{};
+  Writes arrived{};
+  std::vector<std::vector<Placement>> climbs{};
+
+  for (size_t climb = 0UL; climb < num_climbs; ++climb)
+  {
+    generator.next(placements);
+    climbs.push_back(placements);
+    bytes.clear();
+    encode_climb(placements, bytes);
+    sent.clear();
+    split(bytes, 23UL, sent);
+    for (size_t index = 0UL; index < sent.size(); ++index)
+    {
+      link.transmit(sent[index], arrived);
+    }
+  }
+  REQUIRE(link.counts().dropped > 0UL);
+  REQUIRE(link.counts().duplicated > 0UL);
+
+  protocol::Protocol protocol{};
+  Packet packet{};
+  size_t num_decoded = 0UL;
+  for (size_t index = 0UL; index < arrived.size(); ++index)
+  {
+    if (protocol.process(arrived[index], packet))
+    {
+      ++num_decoded;
+      // Without corruption every decoded frame is one of the climbs sent
+      REQUIRE(std::ranges::any_of(climbs, [&packet](const std::vector<Placement>& climb) {
+        return std::ranges::equal(climb, packet.placements);
+      }));
+    }
+  }
+  REQUIRE(num_decoded > num_climbs * 8UL / 10UL);
+}
+} // namespace luz::host::test
@@ -0,0 +1,89 @@
+#include "trace.hh"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+#if defined(ESP_PLATFORM)
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include <chrono>
+#include <functional>
+#include <thread>
+#endif
+
+namespace luz::trace
+{
+namespace
+{
+std::array<Event, capacity> events{};
+/// Index of the next free event; may exceed the capacity once events are dropped
+std::atomic<size_t> next{};
+
+uint32_t current_thread() noexcept
+{
+#if defined(ESP_PLATFORM)
+  return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(xTaskGetCurrentTaskHandle()));
+#else
+  return static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+#endif
+}
+} // anonymous namespace
+
+uint64_t now_ns() noexcept
+{
+#if defined(ESP_PLATFORM)
+  return static_cast<uint64_t>(esp_timer_get_time()) * 1000U;
+#else
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count());
+#endif
+}
+
+void record(const Event& event) noexcept
+{
+  // Each slot is claimed by a single writer, so the event itself needs no synchronisation
+  if (const auto index = next.fetch_add(1UL, std::memory_order_relaxed); index < capacity)
+  {
+    events[index] = event;
+    events[index].thread = current_thread();
+  }
+}
+
+void clear() noexcept { next = 0UL; }
+
+size_t size() noexcept { return std::min(next.load(), capacity); }
+
+size_t dropped() noexcept { return next.load() - size(); }
+
+void write_chrome_json(std::FILE* file) noexcept
+{
+  std::fputs("{\"traceEvents\":[", file);
+  const auto count = size();
+  for (size_t index = 0UL; index < count; ++index)
+  {
+    const auto& event = events[index];
+    std::fprintf(file,
+                 "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,"
+                 "\"ts\":%.3f,\"dur\":%.3f",
+                 index == 0UL ? "" : ",",
+                 event.name,
+                 static_cast<unsigned long>(event.thread),
+                 static_cast<double>(event.start_ns) / 1e3,
+                 static_cast<double>(event.duration_ns) / 1e3);
+    if (event.arg_name != nullptr)
+    {
+      std::fprintf(file,
+                   ",\"args\":{\"%s\":%lld}",
+                   event.arg_name,
+                   static_cast<long long>(event.arg_value));
+    }
+    std::fputs("}", file);
+  }
+  std::fprintf(
+      file, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped\":%zu}}\n", dropped());
+}
+} // namespace luz::trace
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <type_traits>
+
+#if defined(ESP_PLATFORM)
+#include "sdkconfig.h"
+#endif
+
+/// Tracing is enabled by CONFIG_LUZ_TRACE on the device and by defining LUZ_TRACE in host builds.
+/// When disabled the macros below expand to nothing, so tracing costs nothing on the device.
+#if defined(CONFIG_LUZ_TRACE) || defined(LUZ_TRACE)
+#define LUZ_TRACE_ENABLED 1
+#else
+#define LUZ_TRACE_ENABLED 0
+#endif
+
+namespace luz::trace
+{
+/// A complete event, i.e. a named span of time on a single thread
+struct Event
+{
+  /// Names are string literals, so only the pointer is stored
+  const char* name{};
+  uint64_t start_ns{};
+  uint64_t duration_ns{};
+  uint32_t thread{};
+  /// A single optional argument shown alongside the event
+  const char* arg_name{};
+  int64_t arg_value{};
+};
+
+/// Number of events held before further events are dropped. On the device every event takes
+/// static RAM, so the capacity is configured; the host has room for longer traces.
+#if defined(CONFIG_LUZ_TRACE_CAPACITY)
+constexpr size_t capacity = CONFIG_LUZ_TRACE_CAPACITY;
+#else
+constexpr size_t capacity = 4096UL;
+#endif
+
+/// Monotonic time of the platform
+uint64_t now_ns() noexcept;
+
+/// Append an event; safe to call from any thread
+void record(const Event& event) noexcept;
+
+/// Discard every recorded event. An event recorded concurrently may be lost.
+void clear() noexcept;
+
+/// Number of events recorded, and dropped since the buffer filled
+size_t size() noexcept;
+size_t dropped() noexcept;
+
+/// Write the recorded events as Chrome trace event JSON, which loads in Perfetto and
+/// chrome://tracing. An event recorded concurrently may be missing or incomplete.
+void write_chrome_json(std::FILE* file) noexcept;
+
+/// Records the span from its construction to its destruction as an event. Usable in constexpr
+/// functions, in which nothing is recorded during constant evaluation.
+class Scope
+{
+public:
+  constexpr explicit Scope(const char* name) noexcept : event_{ .name = name }
+  {
+    if (!std::is_constant_evaluated())
+    {
+      event_.start_ns = now_ns();
+    }
+  }
+
+  constexpr ~Scope() noexcept
+  {
+    if (!std::is_constant_evaluated())
+    {
+      event_.duration_ns = now_ns() - event_.start_ns;
+      record(event_);
+    }
+  }
+
+  /// Copy/move constructor/assignment
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+  Scope(Scope&&) = delete;
+  Scope& operator=(Scope&&) = delete;
+
+  /// Attach an argument to the event, e.g. the outcome of the traced operation
+  constexpr void arg(const char* name, int64_t value) noexcept
+  {
+    event_.arg_name = name;
+    event_.arg_value = value;
+  }
+
+private:
+  Event event_;
+};
+} // namespace luz::trace
+
+#if LUZ_TRACE_ENABLED
+/// Trace the remainder of the enclosing block as the event name, through the scope variable var
+#define LUZ_TRACE_SCOPE(var, name) ::luz::trace::Scope var{ name }
+/// Attach an integral argument to the event traced through var
+#define LUZ_TRACE_ARG(var, name, value) var.arg(name, static_cast<int64_t>(value))
+#else
+#define LUZ_TRACE_SCOPE(var, name)
+#define LUZ_TRACE_ARG(var, name, value)
+#endif
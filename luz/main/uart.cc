@@ -0,0 +1,71 @@
+#include "uart.hh"
+
+#include "fanout.hh"
+
+#include "driver/uart.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+
+#include <algorithm>
+
+namespace
+{
+/// Room for a few of the largest packets, so that a burst of frames is never dropped
+constexpr int buffer_size
+    = 4 * static_cast<int>(luz::fanout::line_size(luz::fanout::max_packet_size));
+// Logging tag
+constexpr auto tag = "luz::fanout";
+} // anonymous namespace
+
+namespace luz::fanout
+{
+Uart::Uart(int port, int tx_pin, int rx_pin, uint32_t baud) noexcept : port_{ port }
+{
+  const uart_config_t config = {
+    .baud_rate = static_cast<int>(baud),
+    .data_bits = UART_DATA_8_BITS,
+    .parity = UART_PARITY_DISABLE,
+    .stop_bits = UART_STOP_BITS_1,
+    .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+    .rx_flow_ctrl_thresh = 0U,
+    .source_clk = UART_SCLK_DEFAULT,
+  };
+  ESP_ERROR_CHECK(uart_driver_install(port_, buffer_size, buffer_size, 0, nullptr, 0));
+  ESP_ERROR_CHECK(uart_param_config(port_, &config));
+  ESP_ERROR_CHECK(uart_set_pin(port_, tx_pin, rx_pin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
+  ESP_LOGI(tag,
+           "UART %d at %lu baud: TX on GPIO %d, RX on GPIO %d",
+           port_,
+           static_cast<unsigned long>(baud),
+           tx_pin,
+           rx_pin);
+}
+
+Uart::~Uart() noexcept { uart_driver_delete(port_); }
+
+bool Uart::write(std::span<const std::byte> bytes) noexcept
+{
+  // uart_write_bytes would block until the buffer had room
+  size_t free = 0UL;
+  if (uart_get_tx_buffer_free_size(port_, &free) != ESP_OK || free < bytes.size())
+  {
+    return false;
+  }
+  return uart_write_bytes(port_, bytes.data(), bytes.size()) == static_cast<int>(bytes.size());
+}
+
+size_t Uart::read(std::span<std::byte> bytes, uint32_t timeout_ms) noexcept
+{
+  // Asking for more than has arrived would wait for the rest
+  if (bytes.empty() || uart_read_bytes(port_, bytes.data(), 1U, pdMS_TO_TICKS(timeout_ms)) <= 0)
+  {
+    return 0UL;
+  }
+  size_t buffered = 0UL;
+  (void)uart_get_buffered_data_len(port_, &buffered);
+  const auto rest = std::min(buffered, bytes.size() - 1UL);
+  const int read = rest > 0UL ? uart_read_bytes(port_, bytes.data() + 1, rest, 0U) : 0;
+  return 1UL + static_cast<size_t>(std::max(read, 0));
+}
+} // namespace luz::fanout
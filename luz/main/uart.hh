@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace luz::fanout
+{
+/// A UART linking a board to the next in the chain, a fanout::Port: it receives on rx_pin from
+/// the board before and transmits on tx_pin to the board after
+class Uart
+{
+public:
+  Uart(int port, int tx_pin, int rx_pin, uint32_t baud) noexcept;
+  ~Uart() noexcept;
+
+  /// Copy/move constructor/assignment
+  Uart(const Uart&) = delete;
+  Uart& operator=(const Uart&) = delete;
+  Uart(Uart&&) = delete;
+  Uart& operator=(Uart&&) = delete;
+
+  /// Queue bytes for transmission
+  /// @return false, dropping them, if the transmit buffer has no room for them all
+  bool write(std::span<const std::byte> bytes) noexcept;
+
+  /// Wait up to timeout_ms for a byte, then read it and every byte received since
+  size_t read(std::span<std::byte> bytes, uint32_t timeout_ms) noexcept;
+
+private:
+  int port_;
+};
+} // namespace luz::fanout
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "crc.hh"
+#include "database.hh"
+#include "layout.hh"
+
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+
+/// Board layouts uploaded by a client replace the compiled-in position to pixel table without a
+/// reflash. The "layout" partition is split into two slots, A and B, each holding
+///
+///   Header  generation of the slot, then the blob header: magic "LUZP", format version, layout
+///           version, number of positions and LEDs, CRC-32 of the table
+///   Table   the pixel lighting each position as an int16, or -1 where no pixel lights it
+///
+/// The client sends the blob (blob header then table) as chunks, each prefixed by the offset of
+/// its first byte in the blob. The table is written straight to the inactive slot as it arrives,
+/// so the blob is never held in RAM. Once complete the table is verified as read back from flash
+/// and the slot header written last: a slot without a valid header is ignored, so an interrupted
+/// upload leaves the active layout in place. At boot the valid slot of the highest generation is
+/// used, or the compiled-in table if neither is valid.
+namespace luz::upload
+{
+constexpr uint32_t magic = 0x505A554CU; // "LUZP" in little endian
+constexpr uint8_t format_version = 1U;
+/// Label of the data partition holding the slots
+constexpr auto partition_label = "layout";
+/// Erase granularity of the flash; each slot starts on a sector boundary
+constexpr size_t sector_size = 4096UL;
+
+struct BlobHeader
+{
+  /// Chosen by the client, e.g. to tell which layout is installed
+  uint16_t layout_version{};
+  uint16_t num_positions{};
+  uint16_t num_leds{};
+  /// CRC-32 of the table
+  uint32_t crc{};
+
+  friend constexpr bool operator==(const BlobHeader& lhs, const BlobHeader& rhs) = default;
+};
+
+struct SlotHeader
+{
+  /// Incremented by every upload; the valid slot of the highest generation is active
+  uint32_t generation{};
+  BlobHeader blob{};
+};
+
+/// Prefix of every chunk written to the layout characteristic
+struct Chunk
+{
+  /// Offset in the blob of the first byte of the chunk
+  uint32_t offset{};
+};
+
+enum class UploadStatus : uint8_t
+{
+  /// The chunk was written; the next is expected at next_offset
+  in_progress = 0,
+  /// The layout was verified and is now in use
+  complete,
+  /// The chunk does not start at next_offset, from where the client should resume
+  out_of_order,
+  /// The blob is not a layout, or the layout does not fit in a slot or on the LED strip
+  bad_header,
+  /// The table does not match its CRC, or lights a pixel beyond the LED strip
+  bad_table,
+  /// The partition could not be erased or written
+  flash_error,
+};
+
+/// Notified to the client in reply to every chunk
+struct UploadReply
+{
+  UploadStatus status{};
+  /// Offset of the next chunk expected; the size of the blob once complete
+  uint32_t next_offset{};
+
+  friend constexpr bool operator==(const UploadReply& lhs, const UploadReply& rhs) = default;
+};
+
+namespace codec
+{
+struct UploadStatus
+{
+  static constexpr upload::UploadStatus decode(uint8_t raw) noexcept
+  {
+    return static_cast<upload::UploadStatus>(raw);
+  }
+  static constexpr uint8_t encode(upload::UploadStatus value) noexcept
+  {
+    return static_cast<uint8_t>(value);
+  }
+  static constexpr bool valid(uint8_t raw) noexcept
+  {
+    return raw <= static_cast<uint8_t>(upload::UploadStatus::flash_error);
+  }
+};
+} // namespace codec
+
+using BlobHeaderLayout = layout::Layout<BlobHeader,
+                                        layout::Constant<uint32_t, magic>,
+                                        layout::Constant<uint8_t, format_version>,
+                                        layout::Bind<&BlobHeader::layout_version>,
+                                        layout::Bind<&BlobHeader::num_positions>,
+                                        layout::Bind<&BlobHeader::num_leds>,
+                                        layout::Bind<&BlobHeader::crc>>;
+
+using SlotHeaderLayout = layout::Layout<SlotHeader,
+                                        layout::Bind<&SlotHeader::generation>,
+                                        layout::Nested<&SlotHeader::blob, BlobHeaderLayout>>;
+
+using ChunkLayout = layout::Layout<Chunk, layout::Bind<&Chunk::offset>>;
+
+using UploadReplyLayout
+    = layout::Layout<UploadReply,
+                     layout::Bind<&UploadReply::status, uint8_t, codec::UploadStatus>,
+                     layout::Bind<&UploadReply::next_offset>>;
+
+/// Size of the table of a layout of num_positions positions
+constexpr size_t table_size(size_t num_positions) noexcept
+{
+  return num_positions * sizeof(int16_t);
+}
+
+/// Whether table holds a pixel within the strip of header.num_leds LEDs, or -1, for each of
+/// header.num_positions positions, and matches the CRC of the header
+constexpr bool verify_table(std::span<const std::byte> table, const BlobHeader& header) noexcept;
+
+/// Flash partition holding the slots, read through a mapping and written like NOR flash: erase
+/// sets every byte of whole sectors to 0xFF, and writes only clear bits
+template <typename T>
+concept Partition
+    = requires(T& partition, size_t offset, size_t size, std::span<const std::byte> bytes) {
+        { std::as_const(partition).bytes() } -> std::same_as<std::span<const std::byte>>;
+        { partition.erase(offset, size) } -> std::same_as<bool>;
+        { partition.write(offset, bytes) } -> std::same_as<bool>;
+      };
+
+/// Non-owning view of a verified layout table
+class LayoutTable
+{
+public:
+  constexpr LayoutTable() noexcept = default;
+
+  /// Verify the header and table held in a slot
+  /// @param[out] header,table Unchanged unless the slot holds a valid layout
+  static constexpr bool
+  try_make(std::span<const std::byte> slot, SlotHeader& header, LayoutTable& table) noexcept;
+
+  constexpr size_t num_positions() const noexcept { return table_.size() / sizeof(int16_t); }
+
+  /// Translate the placement position into the idx of the pixel array
+  constexpr bool placement_to_pixel(uint16_t position, uint16_t& pixel) const noexcept;
+
+private:
+  constexpr explicit LayoutTable(std::span<const std::byte> table) noexcept : table_{ table } {}
+
+  std::span<const std::byte> table_{};
+};
+
+/// The uploaded layout in use, and the upload of the next. Chunks are received by one task while
+/// placements are translated by any; the active slot is switched atomically once an upload
+/// completes. The next upload erases the slot which was active before; a translation begun
+/// before the switch is long over by the time the first chunk of another upload arrives.
+template <Partition P> class LayoutStore
+{
+public:
+  /// Use the valid slot of the highest generation, if any
+  explicit LayoutStore(P& partition) noexcept;
+  ~LayoutStore() noexcept = default;
+
+  /// Copy/move constructor/assignment
+  LayoutStore(const LayoutStore&) = delete;
+  LayoutStore& operator=(const LayoutStore&) = delete;
+  LayoutStore(LayoutStore&&) = delete;
+  LayoutStore& operator=(LayoutStore&&) = delete;
+
+  /// Header of the uploaded layout in use; empty while the compiled-in table is used
+  std::optional<SlotHeader> active() const noexcept;
+
+  /// Translate the placement position through the uploaded layout, or the compiled-in table if
+  /// none has been uploaded
+  bool placement_to_pixel(uint16_t position, uint16_t& pixel) const noexcept;
+
+  /// Write a chunk of a layout blob to the inactive slot. A chunk at offset 0 starts a new upload,
+  /// abandoning any in progress; a chunk at any offset other than the next expected is rejected
+  /// without affecting the upload, so the client can resume from next_offset.
+  UploadReply receive(std::span<const std::byte> chunk) noexcept;
+
+private:
+  static constexpr int8_t no_slot = -1;
+
+  size_t slot_size() const noexcept;
+  std::span<const std::byte> slot(size_t index) const noexcept;
+
+  /// Validate the buffered blob header and erase the inactive slot for its table
+  UploadStatus begin_table() noexcept;
+  /// Verify the table and write the slot header, making the slot active
+  UploadStatus commit() noexcept;
+  /// Abandon the upload in progress
+  UploadReply abort(UploadStatus status) noexcept;
+
+  P& partition_;
+  std::array<SlotHeader, 2> headers_{};
+  std::array<LayoutTable, 2> tables_{};
+  std::atomic<int8_t> active_{ no_slot };
+
+  /// Slot written by the upload in progress
+  size_t target_{};
+  uint32_t next_offset_{};
+  /// Size of the blob, known once its header has been received
+  size_t blob_size_{};
+  BlobHeader blob_{};
+  std::array<std::byte, BlobHeaderLayout::size> blob_header_{};
+};
+} // namespace luz::upload
+
+#include "upload.inl"
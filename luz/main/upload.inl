@@ -0,0 +1,255 @@
+#pragma once
+
+#include "field.hh"
+#include "upload.hh"
+
+#include <algorithm>
+
+namespace luz::upload
+{
+namespace detail
+{
+/// Round size up to a whole number of sectors
+constexpr size_t whole_sectors(size_t size) noexcept
+{
+  return (size + sector_size - 1UL) / sector_size * sector_size;
+}
+} // namespace detail
+
+constexpr bool verify_table(std::span<const std::byte> table, const BlobHeader& header) noexcept
+{
+  if (table.size() < table_size(header.num_positions))
+  {
+    return false;
+  }
+  table = table.first(table_size(header.num_positions));
+  if (crc32(table) != header.crc)
+  {
+    return false;
+  }
+
+  for (size_t position = 0UL; position < header.num_positions; ++position)
+  {
+    if (const auto pixel = Field<int16_t>{ position * sizeof(int16_t) }.value(table);
+        pixel < -1 || pixel >= header.num_leds)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+constexpr bool LayoutTable::try_make(std::span<const std::byte> slot,
+                                     SlotHeader& header,
+                                     LayoutTable& table) noexcept
+{
+  SlotHeader candidate{};
+  if (slot.size() < SlotHeaderLayout::size || !SlotHeaderLayout::decode(slot, candidate))
+  {
+    return false;
+  }
+
+  // A layout built for a longer strip than this controller drives is never used
+  const auto& blob = candidate.blob;
+  const auto table_bytes = slot.subspan(SlotHeaderLayout::size);
+  if (blob.num_positions == 0U || blob.num_leds > database::num_leds
+      || !verify_table(table_bytes, blob))
+  {
+    return false;
+  }
+
+  header = candidate;
+  table = LayoutTable{ table_bytes.first(table_size(blob.num_positions)) };
+  return true;
+}
+
+constexpr bool LayoutTable::placement_to_pixel(uint16_t position,
+                                               uint16_t& pixel) const noexcept
+{
+  if (position >= num_positions())
+  {
+    return false;
+  }
+
+  const auto pxl = Field<int16_t>{ position * sizeof(int16_t) }.value(table_);
+  if (pxl < 0)
+  {
+    return false;
+  }
+
+  pixel = static_cast<uint16_t>(pxl);
+  return true;
+}
+
+template <Partition P> LayoutStore<P>::LayoutStore(P& partition) noexcept : partition_{ partition }
+{
+  for (size_t index = 0UL; index < headers_.size(); ++index)
+  {
+    if (!LayoutTable::try_make(slot(index), headers_[index], tables_[index]))
+    {
+      continue;
+    }
+    if (const auto active = active_.load(); active == no_slot
+        || headers_[index].generation > headers_[static_cast<size_t>(active)].generation)
+    {
+      active_ = static_cast<int8_t>(index);
+    }
+  }
+}
+
+template <Partition P> std::optional<SlotHeader> LayoutStore<P>::active() const noexcept
+{
+  const auto active = active_.load(std::memory_order_acquire);
+  if (active == no_slot)
+  {
+    return std::nullopt;
+  }
+  return headers_[static_cast<size_t>(active)];
+}
+
+template <Partition P>
+bool LayoutStore<P>::placement_to_pixel(uint16_t position, uint16_t& pixel) const noexcept
+{
+  const auto active = active_.load(std::memory_order_acquire);
+  if (active == no_slot)
+  {
+    return database::placement_to_pixel(position, pixel);
+  }
+  return tables_[static_cast<size_t>(active)].placement_to_pixel(position, pixel);
+}
+
+template <Partition P>
+UploadReply LayoutStore<P>::receive(std::span<const std::byte> chunk) noexcept
+{
+  Chunk prefix{};
+  if (chunk.size() < ChunkLayout::size || !ChunkLayout::decode(chunk, prefix))
+  {
+    return UploadReply{ UploadStatus::out_of_order, next_offset_ };
+  }
+
+  if (prefix.offset == 0U)
+  {
+    // The inactive slot is the target; the compiled-in table leaves both inactive
+    target_ = active_.load() == 0 ? 1UL : 0UL;
+    next_offset_ = 0U;
+    blob_size_ = 0UL;
+  }
+  else if (prefix.offset != next_offset_)
+  {
+    return UploadReply{ UploadStatus::out_of_order, next_offset_ };
+  }
+
+  auto data = chunk.subspan(ChunkLayout::size);
+
+  // The blob header is only written once the table has been verified, so it is held until then
+  if (next_offset_ < BlobHeaderLayout::size)
+  {
+    const auto count = std::min(data.size(), BlobHeaderLayout::size - next_offset_);
+    std::ranges::copy(data.first(count), blob_header_.begin() + next_offset_);
+    next_offset_ += count;
+    data = data.subspan(count);
+    if (next_offset_ < BlobHeaderLayout::size)
+    {
+      return UploadReply{ UploadStatus::in_progress, next_offset_ };
+    }
+    if (const auto status = begin_table(); status != UploadStatus::in_progress)
+    {
+      return abort(status);
+    }
+  }
+
+  if (data.size() > blob_size_ - next_offset_)
+  {
+    return abort(UploadStatus::bad_table);
+  }
+  if (!data.empty())
+  {
+    const auto table_offset = next_offset_ - BlobHeaderLayout::size;
+    if (!partition_.write((target_ * slot_size()) + SlotHeaderLayout::size + table_offset, data))
+    {
+      return abort(UploadStatus::flash_error);
+    }
+    next_offset_ += data.size();
+  }
+
+  if (next_offset_ < blob_size_)
+  {
+    return UploadReply{ UploadStatus::in_progress, next_offset_ };
+  }
+  if (const auto status = commit(); status != UploadStatus::complete)
+  {
+    return abort(status);
+  }
+  const auto reply = UploadReply{ UploadStatus::complete, next_offset_ };
+  next_offset_ = 0U;
+  blob_size_ = 0UL;
+  return reply;
+}
+
+template <Partition P> size_t LayoutStore<P>::slot_size() const noexcept
+{
+  return partition_.bytes().size() / headers_.size() / sector_size * sector_size;
+}
+
+template <Partition P>
+std::span<const std::byte> LayoutStore<P>::slot(size_t index) const noexcept
+{
+  return partition_.bytes().subspan(index * slot_size(), slot_size());
+}
+
+template <Partition P> UploadStatus LayoutStore<P>::begin_table() noexcept
+{
+  BlobHeader blob{};
+  if (!BlobHeaderLayout::decode(blob_header_, blob) || blob.num_positions == 0U
+      || blob.num_leds > database::num_leds
+      || SlotHeaderLayout::size + table_size(blob.num_positions) > slot_size())
+  {
+    return UploadStatus::bad_header;
+  }
+
+  // Only the sectors the layout occupies are erased
+  if (!partition_.erase(target_ * slot_size(),
+                        detail::whole_sectors(SlotHeaderLayout::size
+                                              + table_size(blob.num_positions))))
+  {
+    return UploadStatus::flash_error;
+  }
+
+  blob_ = blob;
+  blob_size_ = BlobHeaderLayout::size + table_size(blob.num_positions);
+  return UploadStatus::in_progress;
+}
+
+template <Partition P> UploadStatus LayoutStore<P>::commit() noexcept
+{
+  // The table is verified as it was written to flash rather than as it was received
+  const auto target = slot(target_);
+  if (!verify_table(target.subspan(SlotHeaderLayout::size), blob_))
+  {
+    return UploadStatus::bad_table;
+  }
+
+  const auto active = active_.load();
+  const auto header = SlotHeader{
+    .generation = active == no_slot ? 1U : headers_[static_cast<size_t>(active)].generation + 1U,
+    .blob = blob_,
+  };
+  std::array<std::byte, SlotHeaderLayout::size> header_bytes{};
+  SlotHeaderLayout::encode(header, header_bytes);
+  if (!partition_.write(target_ * slot_size(), header_bytes)
+      || !LayoutTable::try_make(target, headers_[target_], tables_[target_]))
+  {
+    return UploadStatus::flash_error;
+  }
+
+  active_.store(static_cast<int8_t>(target_), std::memory_order_release);
+  return UploadStatus::complete;
+}
+
+template <Partition P> UploadReply LayoutStore<P>::abort(UploadStatus status) noexcept
+{
+  next_offset_ = 0U;
+  blob_size_ = 0UL;
+  return UploadReply{ status, next_offset_ };
+}
+} // namespace luz::upload